@@ -14,6 +14,12 @@
 
 #ifndef ESP01
 #include "lcd.h"
+#include "renderscheduler.h"
+#include "framestream.h"
+#include "telemetry.h"
+#include "timezone.h"
+#include "deviceclock.h"
+#include "sntpclient.h"
 #include <OneWire.h>
 #include <Q2HX711.h>
 #endif
@@ -22,7 +28,7 @@
 #include <SoftwareSerial.h>
 #endif
 
-unsigned int localPort = 2390;      // local port to listen for UDP packets
+unsigned int localPort = 2390;      // local port of the SNTP client
 
 const uint64_t dayInMs = 24*60*60*1000;
 
@@ -31,6 +37,12 @@ boolean isScreenEnabled = true;
 #ifndef ESP01
 LcdScreen screen;
 MAX72xx*  screenController = NULL;
+// Frames are drawn when the picture changes, at least once per controller refresh period
+RenderScheduler renderScheduler(20, MAX72xx::fullRefreshPeriodMs);
+// Frames the server streams, they own the screen while they come
+FrameStream frameStream;
+Telemetry telemetry;
+tz::TimeZone localZone;
 #endif
 
 Adafruit_BME280* bme = NULL; // I2C
@@ -207,11 +219,9 @@ SoftwareSerial* dfplayerSerial = NULL; // RX, TX
 const int NUMPIXELS = 64;
 Adafruit_NeoPixel* stripe = NULL;
 
-#define ULONG_MAX 0xffffffff
-
 const long interval = 1000; // Request each second
-unsigned long nextRequest = millis();
-unsigned long nextRead = ULONG_MAX;
+uint32_t nextRequest = millis();
+MillisTimer nextRead;
 
 #ifndef ESP01
 typedef uint8_t DeviceAddress[8];
@@ -220,9 +230,94 @@ DeviceAddress deviceAddress = { 0 };
 
 int interruptCounter = 0;
 
-uint32_t timeRetreivedInMs = 0;
-uint32_t initialUnixTime = 0;
-uint32_t restartAt = ULONG_MAX;
+#ifndef ESP01
+DeviceClock deviceClock;
+ClockSources clockSources(deviceClock);
+SntpClient* sntp = NULL;
+uint32_t timeRequestId = 0;
+uint64_t timeRequestSentUs = 0;
+uint32_t nextTimeRequestAt = 0;
+
+void sendClockStats() {
+  sceleton::send(sceleton::message("clockStats")
+    .field("source", clockSources.bestName())
+    .field("offsetUs", (int32_t)deviceClock.offsetUs())
+    .field("skewPpb", deviceClock.skewPpb())
+    .field("jitterUs", deviceClock.jitterUs())
+    .field("pollS", deviceClock.pollIntervalS())
+    .field("steps", deviceClock.steps()));
+}
+#endif
+
+/**
+ * A key of a remote or a turn or click of an encoder
+ */
+void sendKey(const char* remote, const char* key) {
+  if (sceleton::binaryTelemetry) {
+    sceleton::send(sceleton::binMessage(binproto::IR_KEY).field(binproto::REMOTE, remote).field(binproto::KEY, key)
+      .field(binproto::TIMESEQ, (uint32_t)millis()));
+    return;
+  }
+  sceleton::send(sceleton::message("ir_key").field("remote", remote).field("key", key).field("timeseq", millis()));
+}
+
+// Sensors which send readings of the same type, the queue keeps the latest of each
+enum ReadingSource {
+  BME280_SOURCE = 1,
+  DS18B20_SOURCE,
+};
+
+/**
+ * A sensor reading, type names the sensor. One with a binary kind goes as
+ * binValue in a binary frame once the server reads them.
+ */
+template<typename T>
+void sendReading(const char* type, T value, uint8_t kind = 0, int32_t binValue = 0, uint8_t source = 0) {
+  if (kind != 0 && sceleton::binaryTelemetry) {
+    sceleton::send(sceleton::binMessage(kind).field(binproto::VALUE, binValue).field(binproto::TIMESEQ, (uint32_t)millis()), source);
+    return;
+  }
+  sceleton::send(sceleton::message(type).field("value", value).field("timeseq", millis()), source);
+}
+
+/**
+ * A reading of a sensor which goes in the batch of telemetry when that is on, else by
+ * itself as sendReading() writes a T; the state keeps it as the last value
+ */
+template<typename T>
+void sendSample(const char* type, T value, uint8_t kind, int32_t binValue, uint8_t source = 0) {
+  sceleton::state.set(type, value);
+#ifndef ESP01
+  if (telemetry.add(type, value, binValue, millis())) {
+    return;
+  }
+#endif
+  sendReading(type, value, kind, binValue, source);
+}
+
+#ifndef ESP01
+static_assert(Telemetry::maxJsonBytes <= sizeof(sceleton::sendBuffer), "a full batch of telemetry fits the send buffer");
+
+/**
+ * Sends the batch of readings once it is due
+ */
+void sendTelemetry() {
+  if (!telemetry.due(millis())) {
+    return;
+  }
+  if (sceleton::binaryTelemetry) {
+    binproto::Writer& msg = sceleton::binMessage(binproto::TELEMETRY);
+    telemetry.write(msg, millis());
+    sceleton::send(msg);
+  } else {
+    JsonWriter& msg = sceleton::message("telemetry");
+    telemetry.write(msg);
+    sceleton::send(msg.field("timeseq", millis()));
+  }
+  telemetry.clear();
+}
+#endif
+MillisTimer restartAt;
 #ifndef ESP01
 uint32_t nextPotentiometer = 0;
 uint32_t potentiometerValues[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
@@ -308,38 +403,18 @@ public:
       int pB = digitalRead(pinB);
       int pBtn = digitalRead(pinButton);
 
-      String s = "encoder_";
-      s += encName;
       if (pA != _pA || pB != _pB) {
         if (_pA == 0 && _pB == 1 && pA == 1 && pB == 1) {
-          String toSend = String("{ \"type\": \"ir_key\", ") + 
-            "\"remote\": \"" + s + "\", " + 
-            "\"key\": \"" + "rotate_cw" + "\", " +  
-            "\"timeseq\": "  + String(millis(), DEC)  + " " +  
-            "}";
-
-          sceleton::send(toSend);
+          sendKey(encName, "rotate_cw");
         } else if (_pA == 1 && _pB == 0 && pA == 1 && pB == 1) {
-          String toSend = String("{ \"type\": \"ir_key\", ") + 
-            "\"remote\": \"" + s + "\", " + 
-            "\"key\": \"" + "rotate_ccw" + "\", " +  
-            "\"timeseq\": "  + String(millis(), DEC)  + " " +  
-            "}";
-
-          sceleton::send(toSend);
+          sendKey(encName, "rotate_ccw");
         }
         _pA = pA;
         _pB = pB;
       }
       if (pBtn != _pBtn) {
         if (_pBtn == 0 && pBtn == 1) {
-          String toSend = String("{ \"type\": \"ir_key\", ") + 
-            "\"remote\": \"" + s + "\", " + 
-            "\"key\": \"" + "click" + "\", " +  
-            "\"timeseq\": "  + String(millis(), DEC)  + " " +  
-            "}";
-
-          sceleton::send(toSend);
+          sendKey(encName, "click");
         }
         _pBtn = pBtn;
       }
@@ -362,7 +437,7 @@ public:
   }
 
 private:
-  const char* encName;
+  const char* encName;   // The remote name in ir_key
   const int pinA;
   const int pinB;
   const int pinButton;
@@ -374,8 +449,8 @@ private:
 };
 
 Encoder encoders[] = {
-  Encoder("left", D1, D2, D3),
-  Encoder("right", D5, D6, D7),
+  Encoder("encoder_left", D1, D2, D3),
+  Encoder("encoder_right", D5, D6, D7),
 };
 #endif // ESP01
 
@@ -432,12 +507,14 @@ void setup() {
 #ifndef ESP01
       // 
       screen.showMessage(dd, totalMsToShow);
+      renderScheduler.invalidate();
 #endif
     }
 
     virtual void showTuningMsg(const char* dd) {
 #ifndef ESP01
       screen.showTuningMsg(dd);
+      renderScheduler.invalidate();
 #endif
     }
 
@@ -456,9 +533,22 @@ void setup() {
 #endif
     }
 
-    virtual void setTime(uint32_t unixTime) {
-        initialUnixTime = unixTime;
-        timeRetreivedInMs = millis();
+    virtual void streamFrame(uint32_t seq, uint32_t timestampMs, uint8_t encoding, const uint8_t* pixels, size_t length) {
+#ifndef ESP01
+      frameStream.received(millis(), seq, timestampMs, encoding, pixels, length);
+#endif
+    }
+
+    virtual void setTime(uint32_t unixTime, int ms, int requestId) {
+#ifndef ESP01
+      uint64_t receivedUs = deviceClock.monotonicUs();
+      // Only an answer to our own request has a round trip to compensate
+      uint64_t sentUs = requestId >= 0 && (uint32_t)requestId == timeRequestId ? timeRequestSentUs : receivedUs;
+      if (clockSources.offer(ClockSources::WEBSOCKET, unixTime * 1000000ll + (ms >= 0 ? ms * 1000ll : 0), sentUs, receivedUs, ms >= 0 ? 1000 : 1000000)) {
+        sendClockStats();
+      }
+      nextTimeRequestAt = millis() + deviceClock.pollIntervalS() * 1000;
+#endif
     }
 
     virtual void setLedStripe(std::vector<uint32_t> colors) {
@@ -480,30 +570,29 @@ void setup() {
       return ledStripe;
     }
 
-    int restartReportedAt = 0;
-
     virtual void reboot() {
-      if (restartAt - millis() >= 200) { 
-        if (restartReportedAt < millis()) {
-          restartReportedAt = millis() + 300;
-          #ifndef ESP01
-          // debugSerial->println("Rebooting");
-          if (screenController != NULL) {
-            debugPrint("Rebooting");
-            screen.clear();
-            screen.showTuningMsg("Ребут");
-
-            screenController->refreshAll();
-          }
-          sceleton::webSocketClient->disconnect();
-          #endif
+      if (!restartAt.armed()) { 
+        #ifndef ESP01
+        // debugSerial->println("Rebooting");
+        if (screenController != NULL) {
+          debugPrint("Rebooting");
+          screen.clear();
+          screen.showTuningMsg("Ребут");
+
+          screenController->refreshAll();
         }
-        restartAt = millis() + 200;
+        sceleton::flushQueue();
+        sceleton::webSocketClient->disconnect();
+        #endif
+        restartAt.arm(millis(), 200);
       }
     }
 
     virtual void enableScreen(const boolean enabled) {
       isScreenEnabled = enabled;
+#ifndef ESP01
+      renderScheduler.invalidate();
+#endif
     }
 
     virtual boolean screenEnabled() { 
@@ -524,6 +613,12 @@ void setup() {
 
   sceleton::setup(new SinkImpl());
 
+#ifndef ESP01
+  if (sceleton::ntpServer._value.length() > 0) {
+    sntp = new SntpClient(*new WiFiUdpTransport(sceleton::ntpServer._value, localPort));
+  }
+#endif
+
   if (sceleton::hasLedStripe._value == "true") {
     stripe = new Adafruit_NeoPixel(NUMPIXELS, 0, NEO_GRBW + NEO_KHZ800);
     stripe->begin();
@@ -580,11 +675,50 @@ void setup() {
   }
 #endif
 
+#ifndef ESP01
+  // Sensors whose readings may go in batches, with the least change worth sending
+  telemetry.addChannel("temp", binproto::TEMP, 0);
+  telemetry.addChannel("humidity", binproto::HUMIDITY, 0);
+  telemetry.addChannel("pressure", binproto::PRESSURE, 0);
+  telemetry.addChannel("weight", binproto::WEIGHT, 0, true);
+  telemetry.addChannel("potentiometer", binproto::POTENTIOMETER, 0, true);
+  telemetry.setThresholds(sceleton::telemetryThresholds._value.c_str());
+  telemetry.setInterval(sceleton::telemetryInterval._value.toInt());
+#endif
+
   // Initialize comms hardware
   // pinMode(BEEPER_PIN, OUTPUT);
 #ifndef ESP01
+  if (!localZone.set(sceleton::timeZone._value.c_str())) {
+    debugPrint("Wrong time zone: " + sceleton::timeZone._value);
+    localZone.set("MSK-3");
+  }
+
   if (sceleton::hasScreen._value == "true") {
-    screenController = new MAX72xx(screen, D5, D7, D6, sceleton::hasScreen180Rotated._value == "true");
+    // The framebuffer is sized once here, before anything is drawn
+    if (!screen.setGeometry(sceleton::screenModulesWide._value.toInt(), sceleton::screenModulesHigh._value.toInt())) {
+      debugPrint("Wrong screen geometry " + sceleton::screenModulesWide._value + "x" + sceleton::screenModulesHigh._value +
+          ", up to " + String(LcdScreen::maxModules, DEC) + " modules fit, keeping " +
+          String(screen.modulesWide(), DEC) + "x" + String(screen.modulesHigh(), DEC));
+    }
+    if (!frameStream.setFrameBytes(screen.bufferSize())) {
+      debugPrint("No memory for the frame stream of " + String(screen.bufferSize(), DEC) + " byte frames, streamed frames are dropped");
+    }
+    // Both transports use the same wiring: CLK on D5, DATA on D7, CS on D6
+    MAX72xxTransport* transport = NULL;
+    if (sceleton::screenHardwareSpi._value == "true") {
+      transport = new SpiTransport(D6);
+    } else {
+      transport = new BitBangTransport(D5, D7, D6);
+    }
+    // Modules are mounted upside down unless the panel itself is rotated
+    screenController = new MAX72xx(screen, *transport, 
+        sceleton::hasScreen180Rotated._value == "true" ? MAX72xx::ROTATE_0 : MAX72xx::ROTATE_180,
+        false,
+        sceleton::screenChainOrder._value == "snake" ? MAX72xx::CHAIN_SNAKE : MAX72xx::CHAIN_ROWS);
+    if (screenController->modules() == 0) {
+      debugPrint("No memory for the screen controller of " + String(screen.modulesWide() * screen.modulesHigh(), DEC) + " modules, nothing is shown");
+    }
     screenController->setup();
   }
 
@@ -632,7 +766,6 @@ void setup() {
 }
 
 unsigned long oldMicros = micros();
-uint32_t lastScreenRefresh = millis();
 
 uint16_t hours = 0;
 uint16_t mins = 0;
@@ -652,8 +785,8 @@ uint32_t wrongTempValueReceivedCnt = 0;
 
 long lastStripeFrame = millis();
 
-long lastLoop = millis();
-long lastLoopEnd = millis();
+uint32_t lastLoop = millis();
+uint32_t lastLoopEnd = millis();
 
 void loop() {
   if (millis() - lastLoop > 50) {
@@ -661,9 +794,9 @@ void loop() {
   }
   lastLoop = millis();
 
-  long st = millis();
+  uint32_t st = millis();
 
-  if (restartAt < st) {
+  if (restartAt.passed(st)) {
     // debugSerial->println("ESP.reset");
     ESP.reset();
     ESP.restart();
@@ -671,12 +804,8 @@ void loop() {
 
   if (interruptCounter > 0) {
     debugSerial->println("1");
-    String toSend = String("{ \"type\": \"button\", ") + 
-        "\"value\": " + (digitalRead(D7) == LOW ? "true" : "false") + ", " +  
-        "\"timeseq\": "  + String((uint32_t)millis(), DEC)  + " " +  
-        "}";
-
-    sceleton::send(toSend);
+    bool pressed = digitalRead(D7) == LOW;
+    sendReading("button", pressed, binproto::BUTTON, pressed);
     interruptCounter = 0;
   }
 
@@ -688,12 +817,7 @@ void loop() {
     // debugSerial->println();
     long val = hx711->read();
 
-    String toSend = String("{ \"type\": \"weight\", ") + 
-      "\"value\": "  + String(val, DEC)  + ", " +  
-      "\"timeseq\": "  + String((uint32_t)millis(), DEC)  + " " +  
-      "}";
-
-    sceleton::send(toSend);
+    sendSample("weight", val, binproto::WEIGHT, (int32_t)val);
 
     lastWeight = val;
   }
@@ -707,19 +831,16 @@ void loop() {
 
     struct {
         const char* name;
+        uint8_t kind;
         float value;
     } toSendArr[] = {
-      { "temp", temp },
-      { "humidity", hum },
-      { "pressure", pressure },
+      { "temp", binproto::TEMP, temp },
+      { "humidity", binproto::HUMIDITY, hum },
+      { "pressure", binproto::PRESSURE, pressure },
     };
     for (int i = 0; i < sizeof(toSendArr)/sizeof(toSendArr[0]); ++i) {
       if (!isnan(toSendArr[i].value)) {
-        String toSend = String("{ \"type\": \"") + String(toSendArr[i].name) + String("\", ") + 
-            "\"value\": "  + String(toSendArr[i].value)  + ", " +  
-            "\"timeseq\": "  + String((uint32_t)millis(), DEC)  + " " +  
-            "}";
-        sceleton::send(toSend);
+        sendSample(toSendArr[i].name, toSendArr[i].value, toSendArr[i].kind, binproto::hundredths(toSendArr[i].value), BME280_SOURCE);
       }
     }
   }
@@ -727,13 +848,13 @@ void loop() {
 #ifndef ESP01
   if (oneWire != NULL) {
     debugSerial->println("5");
-    if (millis() > nextRequest) {
+    if ((int32_t)(millis() - nextRequest) > 0) {
       oneWire->reset();
       oneWire->write(0xCC);   //Обращение ко всем датчикам
       oneWire->write(0x44);   //Команда на конвертацию
-      nextRead = millis() + interval;
+      nextRead.arm(millis(), interval);
       nextRequest = millis() + interval*2;
-    } else if (millis() > nextRead) {
+    } else if (nextRead.passed(millis())) {
       // debugSerial->println("Temp reading");
       oneWire->reset();
       oneWire->select(deviceAddress);
@@ -756,14 +877,10 @@ void loop() {
 
         // debugPrint("Temp: " + String(byte1, HEX) + " " + String(byte2, HEX) + " -> " + String(val));
 
-        String toSend = String("{ \"type\": \"temp\", ") + 
-          "\"value\": "  + String(val)  + ", " +  
-          "\"timeseq\": "  + String((uint32_t)millis(), DEC)  + " " +  
-          "}";
-        sceleton::send(toSend);
+        sendSample("temp", val, binproto::TEMP, binproto::hundredths(val), DS18B20_SOURCE);
       }
 
-      nextRead = ULONG_MAX;
+      nextRead.disarm();
     }
   }
 #endif
@@ -771,31 +888,78 @@ void loop() {
   oldMicros = micros();
   testCntr++;
 
+#ifndef ESP01
+  // Every pass, so the clock sees each wrap of micros()
+  deviceClock.monotonicUs();
+  // Only once connected: a request queued before that is dropped, the answer would wait a poll interval
+  if (sceleton::webSocketClient.get() != NULL && sceleton::webSocketClient->isConnected() &&
+      (int32_t)(millis() - nextTimeRequestAt) >= 0) {
+    timeRequestId++;
+    timeRequestSentUs = deviceClock.monotonicUs();
+    sceleton::send(sceleton::message("timeRequest").field("id", timeRequestId));
+    nextTimeRequestAt = millis() + deviceClock.pollIntervalS() * 1000;
+  }
+  if (sntp != NULL && sceleton::initializedWiFi) {
+    SntpClient::Sample sample;
+    if (sntp->poll(deviceClock.monotonicUs(), deviceClock.pollIntervalS(), sample) &&
+        clockSources.offer(ClockSources::NTP, sample.serverUs, sample.sentUs, sample.receivedUs, sample.precisionUs)) {
+      sendClockStats();
+    }
+  }
+#endif
+
 #ifndef ESP01
   if (screenController != NULL) {
-    if (millis() > (lastScreenRefresh + 20)) {
-      lastScreenRefresh = millis();
+    uint32_t now = millis();
+    if (frameStream.active()) {
+      // Every pass, frames are due every 20 ms or so
+      const uint8_t* frame = frameStream.present(now);
+      if (frame != NULL && isScreenEnabled) {
+        screen.load(frame);
+        screenController->refreshAll();
+      }
+      if (frameStream.ended(now)) {
+        const FrameStream::Stats& stats = frameStream.stats();
+        sceleton::send(sceleton::message("streamStats")
+          .field("received", stats.received)
+          .field("presented", stats.presented)
+          .field("dropped", stats.dropped)
+          .field("late", stats.late));
+        renderScheduler.invalidate();
+      }
+    } else if (renderScheduler.due(now)) {
+      uint32_t msToNextChange = MAX72xx::fullRefreshPeriodMs;
       screen.clear();
 
-      if (sceleton::initializedWiFi && timeRetreivedInMs != 0) {
+      if (sceleton::initializedWiFi && deviceClock.synced()) {
         if (isScreenEnabled) {
           // UTC is the time at Greenwich Meridian (GMT)
           // print the hour (86400 equals secs per day)
-          nowMs = initialUnixTime * 1000ull + ((uint64_t)millis() - (uint64_t)timeRetreivedInMs);
-          nowMs += 3*60*60*1000; // Timezone (UTC+3)
+          nowMs = localZone.localMs(deviceClock.unixMs());
 
           uint32_t epoch = nowMs/1000ull;
           hours = (epoch % 86400L) / 3600;
           mins = (epoch % 3600) / 60;
 
           screen.showTime(nowMs / dayInMs, nowMs % dayInMs);
+          msToNextChange = screen.msToNextChange(nowMs % dayInMs);
         }
         screenController->refreshAll();
       } else {
         screen.clear();
-        screen.set(0, 0, OnePixelAt(Rectangle(0, 0, 32, 8), (millis() / 30) % (32*8)), true);
+        Rectangle all(0, 0, screen.width(), screen.height());
+        screen.set(0, 0, onePixelAt(all, (now / 30) % (all.w * all.h)), true);
         screenController->refreshAll();
+        msToNextChange = 30 - now % 30;
       }
+      renderScheduler.rendered(now, msToNextChange);
+    }
+
+    if (renderScheduler.statsWindowPassed(now)) {
+      sceleton::send(sceleton::message("renderStats")
+        .field("rendered", renderScheduler.rendered())
+        .field("skipped", renderScheduler.skipped())
+        .field("screenBytesPerSec", screenController->bytesSentPerSecond()));
     }
   }
 #endif
@@ -845,16 +1009,9 @@ void loop() {
               recognizedRemote = &remote;
               kk = k;
 
-              String keyVal(remote.keys[k].value);
-              debugSerial->println(keyVal);
-
-              String toSend = String("{ \"type\": \"ir_key\", ") + 
-                "\"remote\": \"" + String(recognizedRemote->name) + "\", " + 
-                "\"key\": \"" + keyVal + "\", " +  
-                "\"timeseq\": "  + String(millis(), DEC)  + " " +  
-                "}";
+              debugSerial->println(remote.keys[k].value);
 
-              sceleton::send(toSend);
+              sendKey(recognizedRemote->name, remote.keys[k].value);
 
               break;
             }
@@ -875,7 +1032,7 @@ void loop() {
       int ch = msp430->read();
       lastMsp430Ping = millis();
       const char encoders[] = { 'A', 'G', 'O' };
-      const char* encoderNames[] = { "left", "middle", "right" };
+      const char* encoderNames[] = { "encoder_left", "encoder_middle", "encoder_right" };
       if (ch == 'Z') {
         // restart
         debugPrint("MSP430 started");
@@ -894,16 +1051,7 @@ void loop() {
             ss = "click";
           }
           if (ss != NULL) {
-            String s = "encoder_";
-            s += encoderNames[enc];
-            String toSend = String("{ \"type\": \"ir_key\", ") + 
-              "\"remote\": \"" + s + "\", " + 
-              "\"key\": \"" + ss + "\", " +  
-              "\"timeseq\": "  + String(millis(), DEC)  + " " +  
-              "}";
-            // debugSerial->printf("> %s %s\n", s.c_str(), ss);
-
-            sceleton::send(toSend);
+            sendKey(encoderNames[enc], ss);
           }
         }
       }
@@ -965,7 +1113,7 @@ void loop() {
   }
   Encoder::cont();
 
-  if (sceleton::hasPotenciometer._value == "true" && (nextPotentiometer < millis())) {
+  if (sceleton::hasPotenciometer._value == "true" && (int32_t)(millis() - nextPotentiometer) > 0) {
     nextPotentiometer = millis() + 50;
     int readingIn = analogRead(A0);
     potentiometerValues[potentiometerIndex++ % __countof(potentiometerValues)] = readingIn;
@@ -985,17 +1133,23 @@ void loop() {
 
     if (reportedPotentiometer != readingIn) {
       if (sceleton::webSocketClient.get() != NULL) {
-        String toSend = String("{ \"type\": \"potentiometer\", ") + 
-            "\"value\": \"" + readingIn + "\", " +  
-            "\"timeseq\": "  + String(millis(), DEC)  + " " +  
-            "}";
-        sceleton::send(toSend);
+        sceleton::state.set("potentiometer", readingIn);
+        if (!telemetry.add("potentiometer", readingIn, readingIn, millis())) {
+          // By itself the value goes as a string, as it always did
+          char value[12];
+          snprintf(value, sizeof(value), "%d", readingIn);
+          sendReading("potentiometer", (const char*)value);
+        }
         reportedPotentiometer = readingIn;
       }
     }
   }
 #endif
 
+#ifndef ESP01
+  sendTelemetry();
+#endif
+
 #ifndef ESP01
   if (sceleton::hasDFPlayer._value == "true") {
     /*
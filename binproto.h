@@ -0,0 +1,326 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * The binary protocol, the compact twin of the JSON messages. A frame is the
+ * version, the kind of the message, then fields as tag, length and that many bytes.
+ * Integers go little-endian in as few bytes as hold them, texts as UTF-8 without
+ * the terminating zero, so a field is at most 255 bytes; longer bytes, like the
+ * COLORS of a whole stripe, go as repeats of the tag joined in order. The device
+ * says the version in hello; the server talks binary once it answered with "binary".
+ */
+namespace binproto {
+
+const uint8_t version = 1;
+
+enum Kind {
+    // Commands to the device
+    SWITCH = 1,
+    SHOW,
+    LEDSTRIPE,
+    BRIGHTNESS,
+    PLAYMP3,
+    PWM,
+    UNIXTIME,
+    FRAME,      // A frame of a stream to the screen, see FrameStream
+    BATCH,      // Commands run together, each a whole frame in a COMMAND field
+
+    // Telemetry from the device
+    TEMP = 0x40,
+    HUMIDITY,
+    PRESSURE,
+    WEIGHT,
+    IR_KEY,
+    BUTTON,
+    POTENTIOMETER,
+    TELEMETRY,  // Readings of the sensors in one frame, see Telemetry
+};
+
+enum Tag {
+    ID = 1,
+    ON,
+    TEXT,
+    DURATION_MS,
+    VALUE,      // Temperature, humidity and pressure in hundredths
+    INDEX,
+    COLORS,     // RGBW of the LEDs, 4 bytes each in the order of the hex string, repeated past 255 bytes
+    MS,
+    REQUEST_ID,
+    TIMESEQ,
+    REMOTE,
+    KEY,
+    SEQ,
+    TIMESTAMP_MS,
+    ENCODING,   // FrameStream::Encoding
+    PIXELS,
+    SAMPLES,    // Per reading its kind, value as VALUE would be, 4 bytes, and ms before TIMESEQ, 2 bytes
+    COMMAND,    // A frame of a BATCH, repeated
+};
+
+/**
+ * The JSON type of the same message, NULL for a kind nobody knows
+ */
+inline const char* kindName(uint8_t kind) {
+    switch (kind) {
+        case SWITCH: return "switch";
+        case SHOW: return "show";
+        case LEDSTRIPE: return "ledstripe";
+        case BRIGHTNESS: return "brightness";
+        case PLAYMP3: return "playmp3";
+        case PWM: return "pwm";
+        case UNIXTIME: return "unixtime";
+        case FRAME: return "frame";
+        case BATCH: return "batch";
+        case TEMP: return "temp";
+        case HUMIDITY: return "humidity";
+        case PRESSURE: return "pressure";
+        case WEIGHT: return "weight";
+        case IR_KEY: return "ir_key";
+        case BUTTON: return "button";
+        case POTENTIOMETER: return "potentiometer";
+        case TELEMETRY: return "telemetry";
+    }
+    return NULL;
+}
+
+/**
+ * A reading with two digits after the point, as JSON carries it
+ */
+inline int32_t hundredths(float v) {
+    return (int32_t)lroundf(v * 100);
+}
+
+/**
+ * Writes one frame into a buffer the caller owns. What doesn't fit is dropped and overflowed() tells.
+ */
+class Writer {
+    uint8_t* _buf;
+    size_t _cap;
+    size_t _len = 0;
+    bool _overflow = false;
+
+    void put(uint8_t b) {
+        if (_len < _cap) {
+            _buf[_len++] = b;
+        } else {
+            _overflow = true;
+        }
+    }
+
+    void putInt(uint8_t tag, uint32_t v, int bytes) {
+        put(tag);
+        put(bytes);
+        for (int i = 0; i < bytes; ++i) {
+            put((uint8_t)(v >> (8 * i)));
+        }
+    }
+
+public:
+    Writer(uint8_t* buf, size_t cap) : _buf(buf), _cap(cap) {
+    }
+
+    /**
+     * Starts the frame of the kind over whatever was written
+     */
+    Writer& begin(uint8_t kind) {
+        _len = 0;
+        _overflow = false;
+        put(version);
+        put(kind);
+        return *this;
+    }
+
+    Writer& field(uint8_t tag, uint32_t v) {
+        int bytes = 1;
+        while (bytes < 4 && (v >> (8 * bytes)) != 0) {
+            bytes++;
+        }
+        putInt(tag, v, bytes);
+        return *this;
+    }
+
+    /**
+     * Sign-extended on reading, so -1 takes one byte as well
+     */
+    Writer& field(uint8_t tag, int32_t v) {
+        int bytes = 1;
+        while (bytes < 4 && (int32_t)((uint32_t)v << (32 - 8 * bytes)) >> (32 - 8 * bytes) != v) {
+            bytes++;
+        }
+        putInt(tag, (uint32_t)v, bytes);
+        return *this;
+    }
+
+    Writer& field(uint8_t tag, bool v) {
+        return field(tag, (uint32_t)(v ? 1 : 0));
+    }
+
+    Writer& field(uint8_t tag, const uint8_t* data, size_t length) {
+        if (length > 255) {
+            _overflow = true;
+            return *this;
+        }
+        put(tag);
+        put((uint8_t)length);
+        for (size_t i = 0; i < length; ++i) {
+            put(data[i]);
+        }
+        return *this;
+    }
+
+    /**
+     * Bytes of any length as repeats of the tag, 255 bytes each but the last,
+     * Reader::next() gives them back in order
+     */
+    Writer& fields(uint8_t tag, const uint8_t* data, size_t length) {
+        do {
+            size_t n = length > 255 ? 255 : length;
+            field(tag, data, n);
+            data += n;
+            length -= n;
+        } while (length > 0);
+        return *this;
+    }
+
+    Writer& field(uint8_t tag, const char* s) {
+        return field(tag, (const uint8_t*)s, strlen(s));
+    }
+
+    const uint8_t* data() const {
+        return _buf;
+    }
+
+    size_t length() const {
+        return _len;
+    }
+
+    bool overflowed() const {
+        return _overflow;
+    }
+};
+
+/**
+ * Reads a frame in place. valid() is false unless the version is ours and every
+ * field lies within the frame; then the getters give the defaults for what is missing.
+ */
+class Reader {
+    const uint8_t* _data;
+    size_t _len;
+    bool _valid;
+
+    /**
+     * The bytes of the field, NULL if there is none
+     */
+    const uint8_t* find(uint8_t tag, size_t& length) const {
+        if (!_valid) {
+            return NULL;
+        }
+        for (size_t i = 2; i < _len; i += 2 + _data[i + 1]) {
+            if (_data[i] == tag) {
+                length = _data[i + 1];
+                return _data + i + 2;
+            }
+        }
+        return NULL;
+    }
+
+public:
+    Reader(const uint8_t* data, size_t length) : _data(data), _len(length), _valid(false) {
+        if (length < 2 || data[0] != version) {
+            return;
+        }
+        size_t i = 2;
+        while (i + 2 <= length && i + 2 + data[i + 1] <= length) {
+            i += 2 + data[i + 1];
+        }
+        _valid = i == length;
+    }
+
+    bool valid() const {
+        return _valid;
+    }
+
+    uint8_t kind() const {
+        return _valid ? _data[1] : 0;
+    }
+
+    bool has(uint8_t tag) const {
+        size_t length;
+        return find(tag, length) != NULL;
+    }
+
+    uint32_t u32(uint8_t tag, uint32_t def = 0) const {
+        size_t length;
+        const uint8_t* p = find(tag, length);
+        if (p == NULL || length == 0 || length > 4) {
+            return def;
+        }
+        uint32_t v = 0;
+        for (size_t i = 0; i < length; ++i) {
+            v |= (uint32_t)p[i] << (8 * i);
+        }
+        return v;
+    }
+
+    int32_t i32(uint8_t tag, int32_t def = 0) const {
+        size_t length;
+        const uint8_t* p = find(tag, length);
+        if (p == NULL || length == 0 || length > 4) {
+            return def;
+        }
+        uint32_t v = u32(tag);
+        return length == 4 ? (int32_t)v : (int32_t)(v << (32 - 8 * length)) >> (32 - 8 * length);
+    }
+
+    /**
+     * The bytes of the field in the frame, length 0 and NULL if it is missing
+     */
+    const uint8_t* bytes(uint8_t tag, size_t& length) const {
+        const uint8_t* p = find(tag, length);
+        if (p == NULL) {
+            length = 0;
+        }
+        return p;
+    }
+
+    /**
+     * A field which repeats, one by one: the bytes of the next one after at, which
+     * starts at 0 and is moved past it. NULL after the last.
+     */
+    const uint8_t* next(uint8_t tag, size_t& length, size_t& at) const {
+        if (!_valid) {
+            return NULL;
+        }
+        for (size_t i = at < 2 ? 2 : at; i < _len; i += 2 + _data[i + 1]) {
+            if (_data[i] == tag) {
+                length = _data[i + 1];
+                at = i + 2 + length;
+                return _data + i + 2;
+            }
+        }
+        at = _len;
+        return NULL;
+    }
+
+    /**
+     * The text of the field copied to buf and terminated, cut to cap - 1 bytes
+     */
+    const char* text(uint8_t tag, char* buf, size_t cap) const {
+        size_t length;
+        const uint8_t* p = bytes(tag, length);
+        if (length > cap - 1) {
+            length = cap - 1;
+        }
+        if (length > 0) {
+            memcpy(buf, p, length);
+        }
+        buf[length] = 0;
+        return buf;
+    }
+};
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * SWAR kernels for 8x8 bit blocks, as used by the LED matrix modules.
+ * Row r of a block is byte r, column c of a row is bit c.
+ * Rows 0..3 live in lo (row 0 in the lowest byte), rows 4..7 in hi.
+ */
+namespace bitmatrix {
+
+    struct Block {
+        uint32_t lo;
+        uint32_t hi;
+    };
+
+    inline Block load(const uint8_t* rows) {
+        Block b;
+        b.lo = (uint32_t)rows[0] | ((uint32_t)rows[1] << 8) | ((uint32_t)rows[2] << 16) | ((uint32_t)rows[3] << 24);
+        b.hi = (uint32_t)rows[4] | ((uint32_t)rows[5] << 8) | ((uint32_t)rows[6] << 16) | ((uint32_t)rows[7] << 24);
+        return b;
+    }
+
+    inline void store(const Block& b, uint8_t* rows) {
+        rows[0] = b.lo; rows[1] = b.lo >> 8; rows[2] = b.lo >> 16; rows[3] = b.lo >> 24;
+        rows[4] = b.hi; rows[5] = b.hi >> 8; rows[6] = b.hi >> 16; rows[7] = b.hi >> 24;
+    }
+
+    /**
+     * out(r, c) = in(c, r)
+     */
+    inline Block transpose(Block b) {
+        uint32_t x = b.lo;
+        uint32_t y = b.hi;
+        uint32_t t;
+
+        t = (x ^ (x >> 7)) & 0x00AA00AA; x = x ^ t ^ (t << 7);
+        t = (y ^ (y >> 7)) & 0x00AA00AA; y = y ^ t ^ (t << 7);
+
+        t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+        t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+
+        t = (x ^ (y << 4)) & 0xF0F0F0F0; x = x ^ t; y = y ^ (t >> 4);
+
+        b.lo = x;
+        b.hi = y;
+        return b;
+    }
+
+    inline uint32_t reverseBitsInBytes(uint32_t v) {
+        v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
+        v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
+        v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
+        return v;
+    }
+
+    inline uint32_t reverseBytes(uint32_t v) {
+        return (v >> 24) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+    }
+
+    /**
+     * out(r, c) = in(r, 7 - c)
+     */
+    inline Block flipH(Block b) {
+        b.lo = reverseBitsInBytes(b.lo);
+        b.hi = reverseBitsInBytes(b.hi);
+        return b;
+    }
+
+    /**
+     * out(r, c) = in(7 - r, c)
+     */
+    inline Block flipV(Block b) {
+        uint32_t lo = reverseBytes(b.hi);
+        b.hi = reverseBytes(b.lo);
+        b.lo = lo;
+        return b;
+    }
+
+    /**
+     * out(r, c) = in(7 - c, r)
+     */
+    inline Block rotate90(Block b) {
+        return flipH(transpose(b));
+    }
+
+    /**
+     * out(r, c) = in(7 - r, 7 - c)
+     */
+    inline Block rotate180(Block b) {
+        return flipV(flipH(b));
+    }
+
+    /**
+     * out(r, c) = in(c, 7 - r)
+     */
+    inline Block rotate270(Block b) {
+        return flipV(transpose(b));
+    }
+}
@@ -3,59 +3,123 @@
 #include <stdint.h>
 
 namespace date {
-    const uint8_t leapYearMonth[] = {
-        31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
-    };
-    const uint8_t regularYearMonth[] = {
-        31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
-    };
-    const int cycle400year = 365*400 + (100 - 3);
-    const int cycle100year = 365*100 + 25 - 1;
-    const int cycle4year = 365*4 + 1;
-
     struct RTC {
-        uint16_t dow;
-        uint16_t day;
-        uint16_t month;
-        uint16_t year; // 
+        uint16_t dow;    // 0 is Monday
+        uint16_t day;    // 0-based
+        uint16_t month;  // 0-based
+        uint16_t year; //
         bool leapYear;
         uint16_t doy; // 0-based
-        uint32_t dayOfCycle;
+        uint32_t dayOfCycle; // What the cycles and years leave, the day of the year as doy
+        uint16_t isoYear;
+        uint8_t isoWeek; // 1..53
     };
 
-    static void epoc2rtc(uint32_t t, RTC &rtc) {
-        rtc.dow = (t + 3) % 7; // Day of week
-        rtc.dayOfCycle = (((t + 719162 - 365) % cycle400year) % cycle100year) % cycle4year;
-        int yearOfCycle = 0;
-        rtc.year = 1970 + 
-            t / cycle400year * 400 + 
-            t / cycle100year * 100 + 
-            t / cycle4year * 4;
-
-        for (;;) {
-            // printf("%d \n", rtc.year);
-            bool leapYear = false;
-            int days = 365;
-            if (rtc.year % 400 == 0 || (rtc.year % 100 != 0 && rtc.year % 4 == 0)) {
-                days++; // Leap year
-            }
-            if (rtc.dayOfCycle >= days) {
-                rtc.dayOfCycle -= days;
-                rtc.year++;
-                rtc.leapYear = rtc.year % 400 == 0 || (rtc.year % 100 != 0 && rtc.year % 4 == 0);
-            } else {
-                break;
-            }
-        }
+    inline bool isLeapYear(int32_t y) {
+        return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    }
+
+    /**
+     * Days since 1970-01-01 to a proleptic Gregorian date, month 1..12, day 1..31.
+     * Constant time, see H. Hinnant's "chrono-Compatible Low-Level Date Algorithms":
+     * the year is counted from March, so the leap day is the last day of a year.
+     */
+    inline void civilFromDays(int32_t z, int32_t& y, uint32_t& m, uint32_t& d) {
+        z += 719468;
+        const int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const uint32_t doe = (uint32_t)(z - era * 146097);                      // [0, 146096]
+        const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+        const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);           // [0, 365]
+        const uint32_t mp = (5 * doy + 2) / 153;                                // [0, 11], March is 0
+        d = doy - (153 * mp + 2) / 5 + 1;
+        m = mp < 10 ? mp + 3 : mp - 9;
+        y = (int32_t)yoe + era * 400 + (m <= 2 ? 1 : 0);
+    }
 
-        const uint8_t* dm = rtc.leapYear ? leapYearMonth : regularYearMonth;
-        rtc.doy = rtc.dayOfCycle;
-        rtc.month = 0;
-        int d = rtc.doy;
-        for (;d >= dm[rtc.month];) {
-            d -= dm[rtc.month];
-            rtc.month++;
+    /**
+     * Inverse of civilFromDays
+     */
+    inline int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+        y -= m <= 2 ? 1 : 0;
+        const int32_t era = (y >= 0 ? y : y - 399) / 400;
+        const uint32_t yoe = (uint32_t)(y - era * 400);                     // [0, 399]
+        const uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1; // [0, 365]
+        const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;         // [0, 146096]
+        return era * 146097 + (int32_t)doe - 719468;
+    }
+
+    /**
+     * Day of week of days since 1970-01-01, 0 is Monday
+     */
+    inline uint32_t weekday(int32_t z) {
+        return (uint32_t)(z >= -3 ? (z + 3) % 7 : (z + 4) % 7 + 6);
+    }
+
+    /**
+     * ISO 8601 weeks of a year: 53 when it starts on Thursday, or on Wednesday in a leap year
+     */
+    inline uint32_t isoWeeksInYear(int32_t y) {
+        uint32_t jan1 = weekday(daysFromCivil(y, 1, 1));
+        return jan1 == 3 || (jan1 == 2 && isLeapYear(y)) ? 53 : 52;
+    }
+
+    /**
+     * ISO 8601 week of a date given by its year, 0-based day of year and weekday (0 is Monday):
+     * weeks start on Monday, week 1 has the year's first Thursday
+     */
+    inline void isoWeekOf(int32_t y, uint32_t doy, uint32_t dow, int32_t& isoYear, uint32_t& week) {
+        int32_t w = ((int32_t)doy - (int32_t)dow + 10) / 7;
+        isoYear = y;
+        if (w < 1) {
+            isoYear = y - 1;
+            w = isoWeeksInYear(isoYear);
+        } else if (w == 53 && isoWeeksInYear(y) == 52) {
+            isoYear = y + 1;
+            w = 1;
         }
-        rtc.day = d;
+        week = w;
+    }
+
+    inline void isoWeek(int32_t z, int32_t& isoYear, uint32_t& week) {
+        int32_t y;
+        uint32_t m, d;
+        civilFromDays(z, y, m, d);
+        isoWeekOf(y, z - daysFromCivil(y, 1, 1), weekday(z), isoYear, week);
+    }
+
+    static void epoc2rtc(uint32_t t, RTC &rtc) {
+        int32_t y;
+        uint32_t m, d;
+        civilFromDays((int32_t)t, y, m, d);
+        rtc.dow = weekday((int32_t)t);
+        rtc.year = y;
+        rtc.month = m - 1;
+        rtc.day = d - 1;
+        rtc.leapYear = isLeapYear(y);
+        // Same table as civilFromDays, counted from January
+        rtc.doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1 + (m > 2 ? 59 + rtc.leapYear : -306);
+        rtc.dayOfCycle = rtc.doy;
+        int32_t wy;
+        uint32_t w;
+        isoWeekOf(y, rtc.doy, rtc.dow, wy, w);
+        rtc.isoYear = wy;
+        rtc.isoWeek = w;
     }
-}
\ No newline at end of file
+
+    /**
+     * Remembers the date of the last day asked, so callers that ask every frame
+     * only pay for the conversion once a day.
+     */
+    class DayCache {
+        uint32_t _day = 0xFFFFFFFF;
+        RTC _rtc;
+    public:
+        const RTC& get(uint32_t daysSince1970) {
+            if (daysSince1970 != _day) {
+                epoc2rtc(daysSince1970, _rtc);
+                _day = daysSince1970;
+            }
+            return _rtc;
+        }
+    };
+}
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+/**
+ * The unix time as the device knows it: micros() extended to 64 bits and disciplined
+ * by time samples. A sample is a server timestamp taken between two local ones,
+ * so half the round trip bounds its error. Errors under stepThresholdUs are slewed
+ * away and never turn the clock back; what they add up to over time is the skew of
+ * the local oscillator, which the clock learns (an FLL) and corrects between samples.
+ */
+class DeviceClock {
+public:
+    static const int64_t stepThresholdUs = 128000;
+    static const int slewShift = 11;                    // Slews at 1/2048, about 500 ppm
+    static const int64_t maxSkewPpb = 500000;
+    static const int64_t minFreqIntervalUs = 64000000;  // Shorter intervals say little about the skew
+    static const int64_t maxFreqNoisePpb = 20000;       // Noisier samples don't touch the skew
+    static const uint32_t minPollS = 64;
+    static const uint32_t maxPollS = 4096;
+    static const int history = 8;
+
+private:
+    uint32_t _lastMicros = 0;
+    uint64_t _highMicros = 0;
+
+    bool _synced = false;
+    uint64_t _baseLocal = 0;  // Local us of the last correction
+    int64_t _baseUnix = 0;    // Unix us at _baseLocal, with the whole correction
+    int64_t _skewQ32 = 0;     // Oscillator error, in units of 2^-32
+    int64_t _slewUs = 0;      // What was not yet slewed of the corrections at _baseLocal
+
+    // Corrections since the skew was last updated, they are all oscillator error plus noise
+    uint64_t _freqLocal = 0;
+    int64_t _freqSumUs = 0;
+
+    int64_t _offsets[history];
+    int _offsetCount = 0;
+    int64_t _lastOffsetUs = 0;
+    uint32_t _samples = 0;
+    uint32_t _steps = 0;
+    uint32_t _spikes = 0;
+    bool _suspect = false;    // The last sample wanted a step
+    uint32_t _pollS = minPollS;
+
+    /**
+     * floor(e * q32 / 2^32) without overflow for e up to 2^62: split at 2^20,
+     * exact, so the clock never goes back by a rounding
+     */
+    static int64_t mulQ32(int64_t e, int64_t q32) {
+        int64_t hi = (e >> 20) * q32;
+        int64_t lo = (e & 0xFFFFF) * q32;
+        return (hi >> 12) + ((((hi & 0xFFF) << 20) + lo) >> 32);
+    }
+
+    int64_t targetUs(uint64_t local) const {
+        int64_t e = (int64_t)(local - _baseLocal);
+        return _baseUnix + e + mulQ32(e, _skewQ32);
+    }
+
+    int64_t pendingUs(uint64_t local) const {
+        int64_t slewed = (int64_t)(local - _baseLocal) >> slewShift;
+        if (_slewUs > slewed) {
+            return _slewUs - slewed;
+        } else if (_slewUs < -slewed) {
+            return _slewUs + slewed;
+        }
+        return 0;
+    }
+
+    void stepTo(uint64_t local, int64_t unixUs) {
+        _baseLocal = local;
+        _baseUnix = unixUs;
+        _slewUs = 0;
+        _freqLocal = local;
+        _freqSumUs = 0;
+        _pollS = minPollS;
+    }
+
+    void remember(int64_t offsetUs) {
+        _lastOffsetUs = offsetUs;
+        _offsets[_offsetCount++ % history] = offsetUs;
+    }
+
+public:
+    /**
+     * micros() as 64 bits, has to be called at least once per 71 minutes of its wrap
+     */
+    uint64_t monotonicUs() {
+        uint32_t m = micros();
+        if (m < _lastMicros) {
+            _highMicros += 1ull << 32;
+        }
+        _lastMicros = m;
+        return _highMicros | m;
+    }
+
+    bool synced() const {
+        return _synced;
+    }
+
+    int64_t unixUs() {
+        uint64_t local = monotonicUs();
+        return targetUs(local) - pendingUs(local);
+    }
+
+    uint64_t unixMs() {
+        return unixUs() / 1000;
+    }
+
+    /**
+     * serverUs: the server's unix time when it answered, precisionUs: how it rounded it.
+     * sentUs and receivedUs are monotonicUs() when the request left and the answer came,
+     * for a push both are when it came. Returns false if the sample changed nothing.
+     */
+    bool sample(int64_t serverUs, uint64_t sentUs, uint64_t receivedUs, uint32_t precisionUs = 1000) {
+        int64_t delay = (int64_t)(receivedUs - sentUs);
+        int64_t measured = serverUs + delay / 2;
+        int64_t uncertainty = delay / 2 + precisionUs;
+        _samples++;
+        if (!_synced) {
+            _synced = true;
+            stepTo(receivedUs, measured);
+            return true;
+        }
+
+        int64_t offset = measured - targetUs(receivedUs);
+        if (uncertainty > stepThresholdUs && llabs(offset) <= uncertainty) {
+            return false; // Too coarse to say more than that the clock is right
+        }
+        remember(offset);
+        if (llabs(offset) > stepThresholdUs) {
+            // One sample can be a spike of the network, a step waits for the next one to agree
+            if (!_suspect) {
+                _suspect = true;
+                _spikes++;
+                _pollS = minPollS;
+                return false;
+            }
+            _suspect = false;
+            _steps++;
+            stepTo(receivedUs, measured);
+            return true;
+        }
+        _suspect = false;
+
+        // Phase: the new line goes through the sample, what is shown follows it by slewing.
+        // The base is taken with the old skew, the new one only applies from it on
+        int64_t slew = pendingUs(receivedUs) + offset;
+        _baseUnix = targetUs(receivedUs) + offset;
+        _baseLocal = receivedUs;
+        _slewUs = slew;
+
+        // Frequency: the corrections since the last update over the time they took
+        _freqSumUs += offset;
+        int64_t tau = (int64_t)(receivedUs - _freqLocal);
+        if (tau >= minFreqIntervalUs && uncertainty * 1000000000ll / tau <= maxFreqNoisePpb) {
+            _skewQ32 += (_freqSumUs << 30) / tau; // A quarter of the error per update
+            int64_t maxQ32 = (maxSkewPpb << 32) / 1000000000ll;
+            _skewQ32 = _skewQ32 > maxQ32 ? maxQ32 : (_skewQ32 < -maxQ32 ? -maxQ32 : _skewQ32);
+            _freqLocal = receivedUs;
+            _freqSumUs = 0;
+        }
+
+        // The clock predicted the sample as well as the sample can tell, even with twice
+        // the drift: ask less often
+        if (llabs(offset) * 2 <= uncertainty) {
+            _pollS = _pollS * 2 > maxPollS ? maxPollS : _pollS * 2;
+        } else {
+            _pollS = _pollS / 2 < minPollS ? minPollS : _pollS / 2;
+        }
+        return true;
+    }
+
+    /**
+     * Seconds until the next sample is worth asking for
+     */
+    uint32_t pollIntervalS() const {
+        return _pollS;
+    }
+
+    /**
+     * The last sample minus what the clock said then
+     */
+    int64_t offsetUs() const {
+        return _lastOffsetUs;
+    }
+
+    /**
+     * How much faster the unix time runs than the local oscillator, parts per billion
+     */
+    int32_t skewPpb() const {
+        return (int32_t)((_skewQ32 * 1000000000ll) >> 32);
+    }
+
+    /**
+     * Root mean square of the last offsets
+     */
+    uint32_t jitterUs() const {
+        int n = _offsetCount < history ? _offsetCount : history;
+        if (n == 0) {
+            return 0;
+        }
+        double sum = 0;
+        for (int i = 0; i < n; ++i) {
+            sum += (double)_offsets[i] * _offsets[i];
+        }
+        return (uint32_t)sqrt(sum / n);
+    }
+
+    uint32_t samples() const {
+        return _samples;
+    }
+
+    uint32_t steps() const {
+        return _steps;
+    }
+
+    uint32_t spikes() const {
+        return _spikes;
+    }
+};
+
+/**
+ * Samples from several sources, of which only the best one disciplines the clock,
+ * so that their different biases don't pull it back and forth. The best is the one
+ * with the smallest uncertainty, another source takes over when it is twice as good
+ * or the best one has been silent for staleAfterS.
+ */
+class ClockSources {
+public:
+    enum Source { WEBSOCKET, NTP, SOURCES };
+    static const uint32_t staleAfterS = 3 * DeviceClock::maxPollS;
+
+private:
+    DeviceClock& _clock;
+    int64_t _uncertaintyUs[SOURCES];
+    uint64_t _lastUs[SOURCES];
+    uint32_t _used[SOURCES];
+    int _best = -1;
+
+public:
+    ClockSources(DeviceClock& clock) :
+            _clock(clock) {
+        for (int i = 0; i < SOURCES; ++i) {
+            _uncertaintyUs[i] = INT64_MAX;
+            _lastUs[i] = 0;
+            _used[i] = 0;
+        }
+    }
+
+    bool offer(Source s, int64_t serverUs, uint64_t sentUs, uint64_t receivedUs, uint32_t precisionUs) {
+        _uncertaintyUs[s] = (int64_t)(receivedUs - sentUs) / 2 + precisionUs;
+        _lastUs[s] = receivedUs;
+        if (_best < 0 || receivedUs - _lastUs[_best] > staleAfterS * 1000000ull ||
+                (s != _best && _uncertaintyUs[s] * 2 < _uncertaintyUs[_best])) {
+            _best = s;
+        }
+        if (s != _best) {
+            return false;
+        }
+        _used[s]++;
+        return _clock.sample(serverUs, sentUs, receivedUs, precisionUs);
+    }
+
+    int best() const {
+        return _best;
+    }
+
+    const char* bestName() const {
+        return _best == NTP ? "ntp" : (_best == WEBSOCKET ? "ws" : "none");
+    }
+
+    uint32_t used(Source s) const {
+        return _used[s];
+    }
+};
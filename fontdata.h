@@ -0,0 +1,361 @@
+#pragma once
+
+// Generated by snippets/fontCompiler.cpp, don't edit by hand.
+
+#include "packedfont.h"
+
+// fontClock, from ../fonts/clock.bdf
+//   260 code points, 226 glyphs, 8 pixels high
+//   1071 bytes of columns, 257 of offsets, 800 of index (fixed 8-column slots would take 2034)
+//   Coverage:
+//     U+0020..U+009F  128
+//     U+00A6..U+00A6    1
+//     U+00AA..U+00AC    3
+//     U+00B0..U+00B0    1
+//     U+00BA..U+00BD    4
+//     U+00BF..U+00BF    1
+//     U+00D1..U+00D1    1
+//     U+00E1..U+00E1    1
+//     U+00ED..U+00ED    1
+//     U+00F1..U+00F1    1
+//     U+00F3..U+00F3    1
+//     U+00FA..U+00FA    1
+//     U+0401..U+0401    1
+//     U+0404..U+0404    1
+//     U+0406..U+0407    2
+//     U+0410..U+044F   64
+//     U+0451..U+0451    1
+//     U+0454..U+0454    1
+//     U+0456..U+0457    2
+//     U+0490..U+0491    2
+//     U+20AC..U+20AC    1
+//     U+20B4..U+20B4    1
+//     U+2190..U+2193    4
+//     U+2196..U+2199    4
+//     U+2665..U+2665    1
+//     U+E000..U+E000    1
+//     U+E010..U+E019   10
+//     U+E020..U+E029   10
+//     U+E030..U+E039   10
+
+const uint8_t fontClockPages[256] PROGMEM = {
+    0x00, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x02, 0x03, 0xFF, 0xFF, 0xFF, 0xFF, 0x04, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x05, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+const uint8_t fontClockBlocks[6 * 16] PROGMEM = {
+    0xFF, 0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0x0A, 0x0B, 0x0C, // U+0000
+    0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0xFF, 0xFF, 0xFF, 0x13, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // U+0400
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x14, 0x15, 0xFF, 0xFF, 0xFF, 0xFF, // U+2000
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x16, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // U+2100
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x17, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // U+2600
+    0x18, 0x19, 0x1A, 0x1B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // U+E000
+};
+
+const uint8_t fontClockIndex[28 * 16] PROGMEM = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, // 0
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, // 1
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, // 2
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, // 3
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, // 4
+    0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F, // 5
+    0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x29, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, // 6
+    0x6F, 0x70, 0x71, 0x72, 0x73, 0x74, 0x49, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, // 7
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0xFF, 0xFF, 0xFF, 0x7F, 0x80, 0x81, 0xFF, 0xFF, 0xFF, // 8
+    0x62, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x82, 0x83, 0x84, 0x85, 0xFF, 0x86, // 9
+    0xFF, 0x87, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 10
+    0xFF, 0x88, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x89, 0xFF, 0xFF, // 11
+    0xFF, 0x8A, 0xFF, 0x8B, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x8C, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 12
+    0xFF, 0x8D, 0xFF, 0xFF, 0x64, 0xFF, 0x29, 0x66, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 13
+    0x8E, 0x8F, 0x22, 0x90, 0x91, 0x25, 0x92, 0x93, 0x94, 0x95, 0x2B, 0x96, 0x97, 0x28, 0x2F, 0x98, // 14
+    0x30, 0x23, 0x34, 0x99, 0x9A, 0x38, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, // 15
+    0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0x45, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF, 0xB0, 0xB1, 0x4F, 0xB2, // 16
+    0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0x58, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF, 0xC0, 0xC1, // 17
+    0xFF, 0xC2, 0xFF, 0xFF, 0x73, 0xFF, 0x49, 0x75, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 18
+    0x65, 0x74, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 19
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x70, 0xFF, 0xFF, 0xFF, // 20
+    0xFF, 0xFF, 0xFF, 0xFF, 0x71, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 21
+    0x76, 0x67, 0x77, 0x68, 0xFF, 0xFF, 0x7B, 0x78, 0x79, 0x7A, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 22
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x60, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 23
+    0xC3, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 24
+    0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 25
+    0xCE, 0xCF, 0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 26
+    0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF, 0xE0, 0xE1, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // 27
+};
+
+const uint16_t fontClockBases[15] PROGMEM = {
+    0, 57, 129, 207, 283, 353, 423, 513, 600, 677, 764, 847, 930, 1009, 1065,
+};
+
+const uint8_t fontClockOffsets[227] PROGMEM = {
+    0, 2, 3, 6, 11, 16, 21, 26, 28, 31, 34, 39, 44, 46, 51, 52,
+    0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 52, 54, 58, 63, 67,
+    0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 48, 53, 58, 63, 68, 73,
+    0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 55, 58, 63, 66, 71,
+    0, 2, 7, 12, 17, 22, 27, 31, 36, 41, 44, 48, 52, 55, 60, 65,
+    0, 5, 10, 14, 19, 23, 28, 33, 38, 43, 48, 53, 56, 57, 60, 65,
+    0, 7, 14, 18, 23, 28, 33, 38, 43, 48, 53, 58, 64, 69, 76, 83,
+    0, 5, 10, 17, 22, 26, 29, 36, 43, 50, 57, 64, 71, 76, 81, 82,
+    0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 48, 52, 57, 62, 67, 72,
+    0, 5, 11, 16, 21, 26, 31, 36, 41, 46, 51, 58, 64, 69, 74, 80,
+    0, 7, 12, 17, 23, 28, 33, 38, 43, 47, 53, 58, 63, 68, 73, 78,
+    0, 5, 10, 15, 20, 24, 29, 34, 41, 46, 51, 56, 62, 68, 73, 78,
+    0, 6, 11, 16, 21, 26, 31, 36, 41, 46, 51, 56, 61, 66, 71, 75,
+    0, 4, 8, 12, 16, 20, 24, 28, 32, 35, 38, 41, 44, 47, 50, 53,
+    0, 3, 6,
+};
+
+const uint8_t fontClockColumns[1071] PROGMEM = {
+    0x00, 0x00, // 0: U+0020
+    0x5f, // 1: U+0021
+    0x07, 0x00, 0x07, // 2: U+0022
+    0x14, 0x7f, 0x14, 0x7f, 0x14, // 3: U+0023
+    0x24, 0x2a, 0x7f, 0x2a, 0x12, // 4: U+0024
+    0x23, 0x13, 0x08, 0x64, 0x62, // 5: U+0025
+    0x36, 0x49, 0x56, 0x20, 0x50, // 6: U+0026
+    0x08, 0x06, // 7: U+0027
+    0x1c, 0x22, 0x41, // 8: U+0028
+    0x41, 0x22, 0x1c, // 9: U+0029
+    0x2a, 0x1c, 0x7f, 0x1c, 0x2a, // 10: U+002A
+    0x08, 0x08, 0x3e, 0x08, 0x08, // 11: U+002B
+    0x80, 0x60, // 12: U+002C
+    0x08, 0x08, 0x08, 0x08, 0x08, // 13: U+002D
+    0x40, // 14: U+002E
+    0x20, 0x10, 0x08, 0x04, 0x02, // 15: U+002F
+    0x3e, 0x51, 0x49, 0x45, 0x3e, // 16: U+0030
+    0x00, 0x42, 0x7f, 0x40, 0x00, // 17: U+0031
+    0x72, 0x49, 0x49, 0x49, 0x46, // 18: U+0032
+    0x21, 0x41, 0x49, 0x4d, 0x33, // 19: U+0033
+    0x18, 0x14, 0x12, 0x7f, 0x10, // 20: U+0034
+    0x27, 0x45, 0x45, 0x45, 0x39, // 21: U+0035
+    0x3c, 0x4a, 0x49, 0x49, 0x31, // 22: U+0036
+    0x41, 0x21, 0x11, 0x09, 0x07, // 23: U+0037
+    0x36, 0x49, 0x49, 0x49, 0x36, // 24: U+0038
+    0x46, 0x49, 0x49, 0x29, 0x1e, // 25: U+0039
+    0x66, 0x66, // 26: U+003A
+    0x80, 0x68, // 27: U+003B
+    0x08, 0x14, 0x22, 0x41, // 28: U+003C
+    0x14, 0x14, 0x14, 0x14, 0x14, // 29: U+003D
+    0x41, 0x22, 0x14, 0x08, // 30: U+003E
+    0x02, 0x01, 0x59, 0x09, 0x06, // 31: U+003F
+    0x3e, 0x41, 0x5d, 0x59, 0x4e, // 32: U+0040
+    0x7c, 0x12, 0x11, 0x12, 0x7c, // 33: U+0041
+    0x7f, 0x49, 0x49, 0x49, 0x36, // 34: U+0042
+    0x3e, 0x41, 0x41, 0x41, 0x22, // 35: U+0043
+    0x7f, 0x41, 0x41, 0x41, 0x3e, // 36: U+0044
+    0x7f, 0x49, 0x49, 0x49, 0x41, // 37: U+0045
+    0x7f, 0x09, 0x09, 0x09, 0x01, // 38: U+0046
+    0x3e, 0x41, 0x41, 0x51, 0x73, // 39: U+0047
+    0x7f, 0x08, 0x08, 0x08, 0x7f, // 40: U+0048
+    0x41, 0x7f, 0x41, // 41: U+0049
+    0x20, 0x40, 0x41, 0x3f, 0x01, // 42: U+004A
+    0x7f, 0x08, 0x14, 0x22, 0x41, // 43: U+004B
+    0x7f, 0x40, 0x40, 0x40, 0x40, // 44: U+004C
+    0x7f, 0x02, 0x1c, 0x02, 0x7f, // 45: U+004D
+    0x7f, 0x04, 0x08, 0x10, 0x7f, // 46: U+004E
+    0x3e, 0x41, 0x41, 0x41, 0x3e, // 47: U+004F
+    0x7f, 0x09, 0x09, 0x09, 0x06, // 48: U+0050
+    0x3e, 0x41, 0x51, 0x21, 0x5e, // 49: U+0051
+    0x7f, 0x09, 0x19, 0x29, 0x46, // 50: U+0052
+    0x26, 0x49, 0x49, 0x49, 0x32, // 51: U+0053
+    0x03, 0x01, 0x7f, 0x01, 0x03, // 52: U+0054
+    0x3f, 0x40, 0x40, 0x40, 0x3f, // 53: U+0055
+    0x1f, 0x20, 0x40, 0x20, 0x1f, // 54: U+0056
+    0x3f, 0x40, 0x38, 0x40, 0x3f, // 55: U+0057
+    0x63, 0x14, 0x08, 0x14, 0x63, // 56: U+0058
+    0x03, 0x04, 0x78, 0x04, 0x03, // 57: U+0059
+    0x61, 0x59, 0x49, 0x4d, 0x43, // 58: U+005A
+    0x7f, 0x41, 0x41, // 59: U+005B
+    0x02, 0x04, 0x08, 0x10, 0x20, // 60: U+005C
+    0x41, 0x41, 0x7f, // 61: U+005D
+    0x04, 0x02, 0x01, 0x02, 0x04, // 62: U+005E
+    0x40, 0x40, 0x40, 0x40, 0x40, // 63: U+005F
+    0xc0, 0xc0, // 64: U+0060
+    0x20, 0x54, 0x54, 0x78, 0x40, // 65: U+0061
+    0x7f, 0x28, 0x44, 0x44, 0x38, // 66: U+0062
+    0x38, 0x44, 0x44, 0x44, 0x28, // 67: U+0063
+    0x38, 0x44, 0x44, 0x28, 0x7f, // 68: U+0064
+    0x38, 0x54, 0x54, 0x54, 0x18, // 69: U+0065
+    0x08, 0x7e, 0x09, 0x02, // 70: U+0066
+    0x18, 0xa4, 0xa4, 0x9c, 0x78, // 71: U+0067
+    0x7f, 0x08, 0x04, 0x04, 0x78, // 72: U+0068
+    0x44, 0x7d, 0x40, // 73: U+0069
+    0x40, 0x80, 0x80, 0x7a, // 74: U+006A
+    0x7f, 0x10, 0x28, 0x44, // 75: U+006B
+    0x41, 0x7f, 0x40, // 76: U+006C
+    0x7c, 0x04, 0x78, 0x04, 0x78, // 77: U+006D
+    0x7c, 0x08, 0x04, 0x04, 0x78, // 78: U+006E
+    0x38, 0x44, 0x44, 0x44, 0x38, // 79: U+006F
+    0xfc, 0x18, 0x24, 0x24, 0x18, // 80: U+0070
+    0x18, 0x24, 0x24, 0x18, 0xfc, // 81: U+0071
+    0x7c, 0x08, 0x04, 0x04, // 82: U+0072
+    0x48, 0x54, 0x54, 0x54, 0x24, // 83: U+0073
+    0x04, 0x3f, 0x44, 0x24, // 84: U+0074
+    0x3c, 0x40, 0x40, 0x20, 0x7c, // 85: U+0075
+    0x1c, 0x20, 0x40, 0x20, 0x1c, // 86: U+0076
+    0x3c, 0x40, 0x30, 0x40, 0x3c, // 87: U+0077
+    0x44, 0x28, 0x10, 0x28, 0x44, // 88: U+0078
+    0x4c, 0x90, 0x90, 0x90, 0x7c, // 89: U+0079
+    0x44, 0x64, 0x54, 0x4c, 0x44, // 90: U+007A
+    0x08, 0x36, 0x41, // 91: U+007B
+    0x77, // 92: U+007C
+    0x41, 0x36, 0x08, // 93: U+007D
+    0x02, 0x01, 0x02, 0x04, 0x02, // 94: U+007E
+    0x3c, 0x26, 0x23, 0x26, 0x3c, // 95: U+007F
+    0x0e, 0x1f, 0x3f, 0x7e, 0x3f, 0x1f, 0x0e, // 96: U+0080
+    0x0e, 0x11, 0x04, 0x7a, 0x04, 0x11, 0x0e, // 97: U+0081
+    0x06, 0x09, 0x09, 0x06, // 98: U+0082
+    0x7e, 0x81, 0x81, 0xc3, 0x42, // 99: U+0083
+    0x3e, 0x49, 0x49, 0x49, 0x22, // 100: U+0084
+    0x7e, 0x02, 0x02, 0x02, 0x01, // 101: U+0085
+    0x01, 0x40, 0x7e, 0x40, 0x01, // 102: U+0087
+    0x04, 0x02, 0x7f, 0x02, 0x04, // 103: U+0088
+    0x10, 0x20, 0x7f, 0x20, 0x10, // 104: U+0089
+    0x60, 0xfe, 0xf9, 0xfe, 0x60, // 105: U+008A
+    0x38, 0x44, 0x43, 0x44, 0x38, // 106: U+008B
+    0x24, 0x12, 0x12, 0x24, 0x24, 0x12, // 107: U+008C
+    0x44, 0x48, 0x5f, 0x48, 0x44, // 108: U+008D
+    0x1c, 0x22, 0x22, 0x24, 0x28, 0x24, 0x18, // 109: U+008E
+    0x3c, 0x42, 0x95, 0xa1, 0x95, 0x42, 0x3c, // 110: U+008F
+    0x3c, 0x42, 0xa5, 0x91, 0xa5, 0x42, 0x3c, // 111: U+0090
+    0x14, 0x3e, 0x55, 0x41, 0x22, // 112: U+0091
+    0x14, 0x35, 0x5d, 0x56, 0x14, // 113: U+0092
+    0x64, 0x54, 0x4c, 0x00, 0x08, 0x7f, 0x04, // 114: U+0093
+    0x38, 0x54, 0x54, 0x44, 0x28, // 115: U+0094
+    0x7c, 0x04, 0x04, 0x02, // 116: U+0095
+    0x4a, 0x78, 0x42, // 117: U+0097
+    0x08, 0x1c, 0x2a, 0x08, 0x08, 0x08, 0x08, // 118: U+0098
+    0x08, 0x08, 0x08, 0x08, 0x2a, 0x1c, 0x08, // 119: U+0099
+    0x40, 0x20, 0x10, 0x09, 0x05, 0x03, 0x0f, // 120: U+009A
+    0x01, 0x02, 0x04, 0x48, 0x50, 0x60, 0x78, // 121: U+009B
+    0x78, 0x60, 0x50, 0x48, 0x04, 0x02, 0x01, // 122: U+009C
+    0x0f, 0x03, 0x05, 0x09, 0x10, 0x20, 0x40, // 123: U+009D
+    0xff, 0x09, 0x29, 0xf6, 0x20, // 124: U+009E
+    0xc0, 0x88, 0x7e, 0x09, 0x03, // 125: U+009F
+    0x7b, // 126: U+00A6
+    0x26, 0x29, 0x29, 0x2f, 0x28, // 127: U+00AA
+    0x08, 0x14, 0x2a, 0x14, 0x22, // 128: U+00AB
+    0x08, 0x08, 0x08, 0x08, 0x38, // 129: U+00AC
+    0x26, 0x29, 0x29, 0x29, 0x26, // 130: U+00BA
+    0x22, 0x14, 0x2a, 0x14, 0x08, // 131: U+00BB
+    0x2f, 0x10, 0x28, 0x34, 0xfa, // 132: U+00BC
+    0x2f, 0x10, 0xc8, 0xac, 0xba, // 133: U+00BD
+    0x30, 0x48, 0x4d, 0x40, 0x20, // 134: U+00BF
+    0x7d, 0x0d, 0x19, 0x31, 0x7d, // 135: U+00D1
+    0x20, 0x54, 0x54, 0x79, 0x41, // 136: U+00E1
+    0x44, 0x7d, 0x41, // 137: U+00ED
+    0x7a, 0x0a, 0x0a, 0x72, // 138: U+00F1
+    0x30, 0x48, 0x48, 0x4a, 0x32, // 139: U+00F3
+    0x38, 0x40, 0x40, 0x22, 0x7a, // 140: U+00FA
+    0x7e, 0x4b, 0x4a, 0x4b, 0x42, // 141: U+0401
+    0x7e, 0x11, 0x11, 0x11, 0x7e, // 142: U+0410
+    0x7f, 0x49, 0x49, 0x49, 0x31, // 143: U+0411
+    0x7f, 0x01, 0x01, 0x01, 0x03, // 144: U+0413
+    0xc0, 0x7e, 0x41, 0x41, 0x7e, 0xc0, // 145: U+0414
+    0x77, 0x08, 0x7f, 0x08, 0x77, // 146: U+0416
+    0x41, 0x49, 0x49, 0x49, 0x36, // 147: U+0417
+    0x7f, 0x10, 0x08, 0x04, 0x7f, // 148: U+0418
+    0x7f, 0x10, 0x09, 0x04, 0x7f, // 149: U+0419
+    0x40, 0x3e, 0x01, 0x01, 0x7f, // 150: U+041B
+    0x7f, 0x02, 0x0c, 0x02, 0x7f, // 151: U+041C
+    0x7f, 0x01, 0x01, 0x01, 0x7f, // 152: U+041F
+    0x27, 0x48, 0x48, 0x48, 0x3f, // 153: U+0423
+    0x1c, 0x22, 0x22, 0x7f, 0x22, 0x22, 0x1c, // 154: U+0424
+    0x7f, 0x40, 0x40, 0x40, 0x7f, 0xc0, // 155: U+0426
+    0x07, 0x08, 0x08, 0x08, 0x7f, // 156: U+0427
+    0x7f, 0x40, 0x7e, 0x40, 0x7f, // 157: U+0428
+    0x7f, 0x40, 0x7e, 0x40, 0x7f, 0xc0, // 158: U+0429
+    0x03, 0x01, 0x7f, 0x48, 0x48, 0x30, 0x00, // 159: U+042A
+    0x7f, 0x48, 0x48, 0x30, 0x00, 0x7f, 0x00, // 160: U+042B
+    0x7f, 0x48, 0x48, 0x48, 0x30, // 161: U+042C
+    0x22, 0x41, 0x49, 0x49, 0x3e, // 162: U+042D
+    0x7f, 0x08, 0x3e, 0x41, 0x41, 0x3e, // 163: U+042E
+    0x46, 0x29, 0x19, 0x09, 0x7f, // 164: U+042F
+    0x20, 0x54, 0x54, 0x54, 0x78, // 165: U+0430
+    0x3c, 0x4a, 0x4a, 0x49, 0x31, // 166: U+0431
+    0x7c, 0x54, 0x54, 0x54, 0x28, // 167: U+0432
+    0x7c, 0x04, 0x04, 0x0c, // 168: U+0433
+    0xc0, 0x78, 0x44, 0x44, 0x78, 0xc0, // 169: U+0434
+    0x6c, 0x10, 0x7c, 0x10, 0x6c, // 170: U+0436
+    0x44, 0x54, 0x54, 0x54, 0x28, // 171: U+0437
+    0x7c, 0x20, 0x10, 0x08, 0x7c, // 172: U+0438
+    0x7c, 0x20, 0x12, 0x08, 0x7c, // 173: U+0439
+    0x7c, 0x10, 0x10, 0x28, 0x44, // 174: U+043A
+    0x40, 0x38, 0x04, 0x04, 0x7c, // 175: U+043B
+    0x7c, 0x08, 0x10, 0x08, 0x7c, // 176: U+043C
+    0x7c, 0x10, 0x10, 0x10, 0x7c, // 177: U+043D
+    0x7c, 0x04, 0x04, 0x04, 0x7c, // 178: U+043F
+    0xfc, 0x24, 0x24, 0x24, 0x18, // 179: U+0440
+    0x38, 0x44, 0x44, 0x44, // 180: U+0441
+    0x0c, 0x04, 0x7c, 0x04, 0x0c, // 181: U+0442
+    0x4c, 0x90, 0x90, 0x50, 0x3c, // 182: U+0443
+    0x10, 0x28, 0x28, 0xfc, 0x28, 0x28, 0x10, // 183: U+0444
+    0x7c, 0x40, 0x40, 0x7c, 0xc0, // 184: U+0446
+    0x0c, 0x10, 0x10, 0x10, 0x7c, // 185: U+0447
+    0x7c, 0x40, 0x78, 0x40, 0x7c, // 186: U+0448
+    0x7c, 0x40, 0x78, 0x40, 0x7c, 0xc0, // 187: U+0449
+    0x04, 0x7c, 0x50, 0x50, 0x50, 0x20, // 188: U+044A
+    0x7c, 0x50, 0x50, 0x20, 0x7c, // 189: U+044B
+    0x7c, 0x50, 0x50, 0x50, 0x20, // 190: U+044C
+    0x28, 0x44, 0x54, 0x54, 0x38, // 191: U+044D
+    0x7c, 0x10, 0x38, 0x44, 0x44, 0x38, // 192: U+044E
+    0x48, 0x34, 0x14, 0x14, 0x7c, // 193: U+044F
+    0x38, 0x55, 0x54, 0x55, 0x18, // 194: U+0451
+    0x18, 0x18, 0x3c, 0x42, 0xff, // 195: U+E000
+    0x7e, 0x81, 0x81, 0x81, 0x7e, // 196: U+E010
+    0x84, 0x82, 0xff, 0x80, 0x80, // 197: U+E011
+    0xc2, 0xa1, 0x91, 0x89, 0x86, // 198: U+E012
+    0x42, 0x81, 0x89, 0x89, 0x76, // 199: U+E013
+    0x10, 0x18, 0x14, 0x12, 0xff, // 200: U+E014
+    0x4f, 0x89, 0x89, 0x89, 0x71, // 201: U+E015
+    0x7e, 0x89, 0x89, 0x89, 0x72, // 202: U+E016
+    0x03, 0x01, 0xe1, 0x11, 0x0f, // 203: U+E017
+    0x76, 0x89, 0x89, 0x89, 0x76, // 204: U+E018
+    0x4e, 0x91, 0x91, 0x91, 0x7e, // 205: U+E019
+    0x7e, 0x81, 0x81, 0x7e, // 206: U+E020
+    0x84, 0x82, 0xff, 0x80, // 207: U+E021
+    0xe2, 0x91, 0x89, 0x86, // 208: U+E022
+    0x62, 0x81, 0x89, 0x76, // 209: U+E023
+    0x18, 0x14, 0x12, 0xff, // 210: U+E024
+    0x4f, 0x89, 0x89, 0x71, // 211: U+E025
+    0x7e, 0x89, 0x89, 0x72, // 212: U+E026
+    0x03, 0xe1, 0x11, 0x0f, // 213: U+E027
+    0x76, 0x89, 0x89, 0x76, // 214: U+E028
+    0x4e, 0x91, 0x91, 0x7e, // 215: U+E029
+    0xf8, 0x88, 0xf8, // 216: U+E030
+    0x90, 0xf8, 0x80, // 217: U+E031
+    0xe8, 0xa8, 0xb8, // 218: U+E032
+    0xa8, 0xa8, 0xf8, // 219: U+E033
+    0x38, 0x20, 0xf8, // 220: U+E034
+    0xb8, 0xa8, 0xe8, // 221: U+E035
+    0xf8, 0xa8, 0xe8, // 222: U+E036
+    0x08, 0x08, 0xf8, // 223: U+E037
+    0xf8, 0xa8, 0xf8, // 224: U+E038
+    0xb8, 0xa8, 0xf8, // 225: U+E039
+};
+
+const PackedFont fontClock = {
+    fontClockPages,
+    fontClockBlocks,
+    fontClockIndex,
+    fontClockBases,
+    fontClockOffsets,
+    fontClockColumns,
+    226,
+    8
+};
+
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Frames the server streams to the screen, each a whole framebuffer in the layout
+ * of LcdScreen. A frame is raw, an XOR delta to the frame before it, and either of
+ * them may be RLE packed. Frames are decoded as they come, in sequence order, and
+ * wait in a few slots until their time: a stream is anchored at its first frame,
+ * which is shown jitterMs after it came, the rest follow by their timestamps.
+ *
+ * A frame is dropped when it is never shown: lost on the way, out of order, a delta
+ * without the frame before it, pushed out of a full buffer or overtaken by a newer
+ * one that was due as well. It is late when shown more than lateMs after its time.
+ * The stream ends once nothing came for idleMs and all is shown; a frame with
+ * sequence number 0 that is no delta starts it over.
+ */
+class FrameStream {
+public:
+    enum Encoding {
+        RAW = 0,
+        XOR = 1,
+        RLE = 2,
+    };
+
+    struct Stats {
+        uint32_t received;
+        uint32_t presented;
+        uint32_t dropped;
+        uint32_t late;
+    };
+
+    static const int slots = 6;
+    static const size_t maxFrameBytes = 512;   // The framebuffer of LcdScreen::maxModules
+    const uint32_t jitterMs;
+    const uint32_t lateMs = 10;
+    const uint32_t idleMs = 1000;
+
+private:
+    size_t _frameBytes = 0;
+    uint8_t* _frames = NULL;   // The slots, then the last frame decoded that deltas apply to
+    uint32_t _dueAt[slots];
+    int _first = 0;
+    int _count = 0;
+
+    bool _active = false;
+    bool _needKey = true;
+    uint32_t _nextSeq = 0;
+    uint32_t _offsetMs = 0;    // Due at timestamp + _offsetMs in millis()
+    uint32_t _lastArrival = 0;
+    Stats _stats;
+
+    uint8_t* slot(int n) {
+        return _frames + n * _frameBytes;
+    }
+
+    uint8_t* reference() {
+        return _frames + slots * _frameBytes;
+    }
+
+public:
+    FrameStream(uint32_t _jitterMs = 60) : jitterMs(_jitterMs) {
+        memset(&_stats, 0, sizeof(_stats));
+    }
+
+    FrameStream(const FrameStream&) = delete;
+
+    ~FrameStream() {
+        free(_frames);
+    }
+
+    /**
+     * Sizes the buffers for frames of that many bytes, LcdScreen::bufferSize().
+     * Meant to be called once at boot. False if frames are bigger than
+     * maxFrameBytes or there's no memory for them, every frame is dropped then.
+     */
+    bool setFrameBytes(size_t frameBytes) {
+        free(_frames);
+        _frames = NULL;
+        _frameBytes = 0;
+        _active = false;
+        _count = 0;
+        if (frameBytes == 0 || frameBytes > maxFrameBytes) {
+            return false;
+        }
+        _frames = (uint8_t*)calloc(slots + 1, frameBytes);
+        if (_frames == NULL) {
+            return false;
+        }
+        _frameBytes = frameBytes;
+        return true;
+    }
+
+    /**
+     * A frame from the server at now, false if it is dropped
+     */
+    bool received(uint32_t now, uint32_t seq, uint32_t timestampMs, uint8_t encoding, const uint8_t* data, size_t length) {
+        if (_frames == NULL) {
+            return false;
+        }
+        if (!_active || (seq == 0 && (encoding & XOR) == 0)) {
+            _active = true;
+            _needKey = true;
+            _nextSeq = seq;
+            _offsetMs = now + jitterMs - timestampMs;
+            _first = 0;
+            _count = 0;
+            memset(&_stats, 0, sizeof(_stats));
+        }
+        _stats.received++;
+        _lastArrival = now;
+
+        if ((int32_t)(seq - _nextSeq) < 0) {
+            _stats.dropped++;
+            return false;
+        }
+        if (seq != _nextSeq) {
+            _stats.dropped += seq - _nextSeq;
+            _needKey = true;
+        }
+        _nextSeq = seq + 1;
+        if ((encoding & XOR) != 0 && _needKey) {
+            _stats.dropped++;
+            return false;
+        }
+
+        if (_count == slots) {
+            _first = (_first + 1) % slots;
+            _count--;
+            _stats.dropped++;
+        }
+        int n = (_first + _count) % slots;
+        uint8_t* frame = slot(n);
+        bool decoded;
+        if ((encoding & RLE) != 0) {
+            decoded = rleUnpack(data, length, frame, _frameBytes) == _frameBytes;
+        } else {
+            decoded = length == _frameBytes;
+            if (decoded) {
+                memcpy(frame, data, length);
+            }
+        }
+        if (!decoded) {
+            // Deltas to what follows have nothing to apply to
+            _needKey = true;
+            _stats.dropped++;
+            return false;
+        }
+        uint8_t* ref = reference();
+        if ((encoding & XOR) != 0) {
+            for (size_t i = 0; i < _frameBytes; ++i) {
+                frame[i] ^= ref[i];
+            }
+        }
+        memcpy(ref, frame, _frameBytes);
+        _needKey = false;
+        _dueAt[n] = timestampMs + _offsetMs;
+        _count++;
+        return true;
+    }
+
+    /**
+     * The newest frame due at now, NULL if none is. It stays valid until the next received().
+     */
+    const uint8_t* present(uint32_t now) {
+        int shown = -1;
+        while (_count > 0 && (int32_t)(now - _dueAt[_first]) >= 0) {
+            if (shown >= 0) {
+                _stats.dropped++;
+            }
+            shown = _first;
+            _first = (_first + 1) % slots;
+            _count--;
+        }
+        if (shown < 0) {
+            return NULL;
+        }
+        if (now - _dueAt[shown] > lateMs) {
+            _stats.late++;
+        }
+        _stats.presented++;
+        return slot(shown);
+    }
+
+    /**
+     * A stream owns the screen
+     */
+    bool active() const {
+        return _active;
+    }
+
+    /**
+     * True once, when the stream ended at now; stats() then tell about all of it
+     */
+    bool ended(uint32_t now) {
+        if (_active && _count == 0 && now - _lastArrival >= idleMs) {
+            _active = false;
+            return true;
+        }
+        return false;
+    }
+
+    const Stats& stats() const {
+        return _stats;
+    }
+
+    /**
+     * The other end: frame with the encoding into out, previous is the frame before
+     * it for XOR. Returns the length, 0 if cap is short or the frame is over maxFrameBytes.
+     */
+    static size_t encode(const uint8_t* frame, const uint8_t* previous, size_t frameBytes, uint8_t encoding, uint8_t* out, size_t cap) {
+        static uint8_t delta[maxFrameBytes];   // Off the small stack of the ESP8266
+        if (frameBytes > maxFrameBytes) {
+            return 0;
+        }
+        if ((encoding & XOR) != 0) {
+            for (size_t i = 0; i < frameBytes; ++i) {
+                delta[i] = frame[i] ^ previous[i];
+            }
+            frame = delta;
+        }
+        if ((encoding & RLE) != 0) {
+            return rlePack(frame, frameBytes, out, cap);
+        }
+        if (frameBytes > cap) {
+            return 0;
+        }
+        memcpy(out, frame, frameBytes);
+        return frameBytes;
+    }
+
+    /**
+     * A control byte c below 128 is followed by c + 1 bytes as they are, from 128
+     * on by one byte repeated c - 126 times. Returns the length packed, 0 if cap is short.
+     */
+    static size_t rlePack(const uint8_t* in, size_t length, uint8_t* out, size_t cap) {
+        size_t o = 0;
+        size_t i = 0;
+        while (i < length) {
+            size_t run = 1;
+            while (i + run < length && run < 129 && in[i + run] == in[i]) {
+                run++;
+            }
+            if (run >= 2) {
+                if (o + 2 > cap) {
+                    return 0;
+                }
+                out[o++] = (uint8_t)(run + 126);
+                out[o++] = in[i];
+                i += run;
+                continue;
+            }
+            // Literals until a run of 2 starts
+            size_t literals = 1;
+            while (i + literals < length && literals < 128 &&
+                    !(i + literals + 1 < length && in[i + literals] == in[i + literals + 1])) {
+                literals++;
+            }
+            if (o + 1 + literals > cap) {
+                return 0;
+            }
+            out[o++] = (uint8_t)(literals - 1);
+            memcpy(out + o, in + i, literals);
+            o += literals;
+            i += literals;
+        }
+        return o;
+    }
+
+    /**
+     * Unpacks what rlePack packed, returns the length unpacked, 0 if it is broken or more than cap
+     */
+    static size_t rleUnpack(const uint8_t* in, size_t length, uint8_t* out, size_t cap) {
+        size_t o = 0;
+        size_t i = 0;
+        while (i < length) {
+            uint8_t c = in[i++];
+            if (c < 128) {
+                size_t n = c + 1;
+                if (i + n > length || o + n > cap) {
+                    return 0;
+                }
+                memcpy(out + o, in + i, n);
+                o += n;
+                i += n;
+            } else {
+                size_t n = c - 126;
+                if (i + 1 > length || o + n > cap) {
+                    return 0;
+                }
+                memset(out + o, in[i++], n);
+                o += n;
+            }
+        }
+        return o;
+    }
+};
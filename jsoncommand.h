@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * FNV-1a of a command type. It is constexpr, so commandHash("ping") can label a
+ * case of a switch, and two types with the same hash would not compile.
+ */
+constexpr uint32_t commandHash(const char* s, uint32_t h = 2166136261u) {
+    return *s == 0 ? h : commandHash(s + 1, (h ^ (uint8_t)*s) * 16777619u);
+}
+
+/**
+ * A quick look at a message before it is parsed. It must be one object with its
+ * strings closed and its brackets matched, nested no deeper than maxDepth (at most 32).
+ * Text that fails here would fail the parse as well, but only after filling the document.
+ */
+bool looksLikeJsonObject(const char* text, size_t length, int maxDepth) {
+    size_t i = 0;
+    while (i < length && (text[i] == ' ' || text[i] == '\t' || text[i] == '\r' || text[i] == '\n')) {
+        i++;
+    }
+    if (i == length || text[i] != '{') {
+        return false;
+    }
+    uint32_t arrays = 0;   // Bit n is set if level n is an array
+    int depth = 0;
+    bool inString = false;
+    for (; i < length; ++i) {
+        uint8_t c = (uint8_t)text[i];
+        if (inString) {
+            if (c == '\\') {
+                i++;
+            } else if (c == '"') {
+                inString = false;
+            } else if (c < 0x20) {
+                return false;
+            }
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            if (depth == maxDepth || depth == 32) {
+                return false;
+            }
+            arrays = c == '[' ? arrays | (1u << depth) : arrays & ~(1u << depth);
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0 || ((arrays >> (depth - 1)) & 1) != (c == ']')) {
+                return false;
+            }
+            if (--depth == 0) {
+                break;
+            }
+        } else if (c == 0) {
+            return false;
+        }
+    }
+    if (depth != 0 || i == length) {
+        return false;
+    }
+    for (++i; i < length; ++i) {
+        if (text[i] != ' ' && text[i] != '\t' && text[i] != '\r' && text[i] != '\n') {
+            return false;
+        }
+    }
+    return true;
+}
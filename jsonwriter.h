@@ -0,0 +1,250 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+/**
+ * Writes JSON straight into a buffer the caller owns, nothing is allocated.
+ * Strings are escaped as JSON wants them, UTF-8 passes through as is. Commas go
+ * in by themselves: keys, values and nested objects are just written in order.
+ * What doesn't fit is cut off and overflowed() tells.
+ */
+class JsonWriter {
+    char* _buf;
+    size_t _cap;
+    size_t _len = 0;
+    bool _overflow = false;
+    bool _comma = false;   // The next key or value goes after a comma
+
+    void put(char c) {
+        if (_len + 1 < _cap) {
+            _buf[_len++] = c;
+        } else {
+            _overflow = true;
+        }
+    }
+
+    void put(const char* s) {
+        while (*s != 0) {
+            put(*s++);
+        }
+    }
+
+    void separate() {
+        if (_comma) {
+            put(',');
+            _comma = false;
+        }
+    }
+
+    void putString(const char* s) {
+        static const char hex[] = "0123456789abcdef";
+        put('"');
+        for (; *s != 0; ++s) {
+            uint8_t c = (uint8_t)*s;
+            if (c == '"' || c == '\\') {
+                put('\\');
+                put((char)c);
+            } else if (c == '\n') {
+                put("\\n");
+            } else if (c == '\r') {
+                put("\\r");
+            } else if (c == '\t') {
+                put("\\t");
+            } else if (c < 0x20) {
+                put("\\u00");
+                put(hex[c >> 4]);
+                put(hex[c & 0xf]);
+            } else {
+                put((char)c);
+            }
+        }
+        put('"');
+    }
+
+    void putUnsigned(uint64_t v) {
+        char digits[20];
+        int n = 0;
+        do {
+            digits[n++] = '0' + v % 10;
+            v /= 10;
+        } while (v > 0);
+        while (n > 0) {
+            put(digits[--n]);
+        }
+    }
+
+    void putSigned(int64_t v) {
+        if (v < 0) {
+            put('-');
+            putUnsigned(0 - (uint64_t)v);
+        } else {
+            putUnsigned(v);
+        }
+    }
+
+public:
+    JsonWriter(char* buf, size_t cap) : _buf(buf), _cap(cap) {
+        reset();
+    }
+
+    /**
+     * Empties the buffer for the next text
+     */
+    void reset() {
+        _len = 0;
+        _overflow = false;
+        _comma = false;
+        if (_cap > 0) {
+            _buf[0] = 0;
+        }
+    }
+
+    JsonWriter& beginObject() {
+        separate();
+        put('{');
+        return *this;
+    }
+
+    JsonWriter& beginObject(const char* k) {
+        key(k);
+        put('{');
+        return *this;
+    }
+
+    JsonWriter& endObject() {
+        put('}');
+        _comma = true;
+        return *this;
+    }
+
+    JsonWriter& beginArray(const char* k) {
+        key(k);
+        put('[');
+        return *this;
+    }
+
+    JsonWriter& endArray() {
+        put(']');
+        _comma = true;
+        return *this;
+    }
+
+    JsonWriter& key(const char* k) {
+        separate();
+        putString(k);
+        put(':');
+        return *this;
+    }
+
+    JsonWriter& value(const char* s) {
+        separate();
+        putString(s);
+        _comma = true;
+        return *this;
+    }
+
+    JsonWriter& value(bool b) {
+        separate();
+        put(b ? "true" : "false");
+        _comma = true;
+        return *this;
+    }
+
+    JsonWriter& value(long long v) {
+        separate();
+        putSigned(v);
+        _comma = true;
+        return *this;
+    }
+
+    JsonWriter& value(unsigned long long v) {
+        separate();
+        putUnsigned(v);
+        _comma = true;
+        return *this;
+    }
+
+    JsonWriter& value(int v) { return value((long long)v); }
+    JsonWriter& value(long v) { return value((long long)v); }
+    JsonWriter& value(unsigned int v) { return value((unsigned long long)v); }
+    JsonWriter& value(unsigned long v) { return value((unsigned long long)v); }
+
+    /**
+     * With digits after the point, as String(float) prints it. NaN, infinities and
+     * what doesn't fit 64 bits with the digits are null.
+     */
+    JsonWriter& value(double v, int digits = 2) {
+        separate();
+        _comma = true;
+        uint64_t scale = 1;
+        for (int i = 0; i < digits; ++i) {
+            scale *= 10;
+        }
+        if (isnan(v) || !(fabs(v) * scale < 1.8e19)) {
+            put("null");
+            return *this;
+        }
+        if (v < 0) {
+            put('-');
+            v = -v;
+        }
+        uint64_t scaled = (uint64_t)(v * scale + 0.5);
+        putUnsigned(scaled / scale);
+        if (digits > 0) {
+            put('.');
+            for (uint64_t s = scale / 10; s > 0; s /= 10) {
+                put('0' + scaled / s % 10);
+            }
+        }
+        return *this;
+    }
+
+    template<typename T>
+    JsonWriter& field(const char* k, T v) {
+        key(k);
+        return value(v);
+    }
+
+    /**
+     * Where the text is, rewind() goes back to it when what came after didn't fit
+     */
+    struct Mark {
+        size_t length;
+        bool comma;
+        bool overflow;
+    };
+
+    Mark mark() const {
+        Mark m = { _len, _comma, _overflow };
+        return m;
+    }
+
+    /**
+     * Drops what was written since the mark
+     */
+    void rewind(const Mark& m) {
+        _len = m.length;
+        _comma = m.comma;
+        _overflow = m.overflow;
+    }
+
+    /**
+     * The text so far, terminated here rather than on every character
+     */
+    const char* c_str() const {
+        if (_cap > 0) {
+            _buf[_len] = 0;
+        }
+        return _buf;
+    }
+
+    size_t length() const {
+        return _len;
+    }
+
+    bool overflowed() const {
+        return _overflow;
+    }
+};
@@ -1,14 +1,16 @@
 #pragma once
 
-#include <functional>
 #include <algorithm>
 
 #include "common.h"
 
-#include "fonts.h"
+#include "fontdata.h"
 #include "dateutil.h"
+#include "bitmatrix.h"
+#include "max72xxtransport.h"
+#include "utf8.h"
 
-#define NUM_MAX 4
+#define NUM_MAX 4 // Default panel width in modules, see LcdScreen::setGeometry
 
 typedef const wchar_t* WSTR;
 typedef wchar_t* WSTR_MUTABLE;
@@ -42,48 +44,39 @@ const wchar_t BIG_NUM_SYM = 0xE010;
 const wchar_t MIDDLE_NUM_SYM = 0xE020;
 const wchar_t TINY_NUM_SYM = 0xE030;
 
-const uint8_t* symbolPtrOrNull(wchar_t symbol) {
-    int fontItem = fontUA[0];
-    int unicodeSym = symbol & 0xffff;
-    if (unicodeSym >= 0x410 && unicodeSym < 0x450) {
-        unicodeSym = unicodeSym - 0x410 + 0xa0;
-    } else if ((unicodeSym >= BIG_NUM_SYM) && (unicodeSym < (10 + BIG_NUM_SYM))) {
-        unicodeSym = (unicodeSym - BIG_NUM_SYM) + 270 - 0x20; // Big numbers
-        // printf("%d\n", unicodeSym);
-    } else if ((unicodeSym >= MIDDLE_NUM_SYM) && (unicodeSym < (10 + MIDDLE_NUM_SYM))) {
-        unicodeSym = (unicodeSym - MIDDLE_NUM_SYM) + 280 - 0x20; // Middle numbers
-    } else if ((unicodeSym >= TINY_NUM_SYM) && (unicodeSym < (10 + TINY_NUM_SYM))) {
-        unicodeSym = (unicodeSym - TINY_NUM_SYM) + 290 - 0x20; // tiny numbers
-    } else if (unicodeSym == 0x401) {
-        unicodeSym = 0x100 - 0x20; // Ё
-    } else if (unicodeSym == 0x451) {
-        unicodeSym = 0x101 - 0x20; // ё
-    } else if (unicodeSym == 0xE000) {
-        unicodeSym = 0x102 - 0x20; // Speaker
-    } else {
-        unicodeSym = unicodeSym - 0x20;
-    }
-
-    if (unicodeSym >= 0 && unicodeSym < (sizeof(fontUA) - 1)/fontItem) {
-        return fontUA + 1 + unicodeSym*fontItem;
-    }
-    return NULL;
+/**
+ * Glyph of a code point in the screen font. Returns false if the font has none,
+ * see fontdata.h for the supported ranges.
+ */
+bool glyphOf(wchar_t symbol, Glyph& glyph) {
+    return findGlyph(fontClock, (uint32_t)symbol, glyph);
 }
 
 
+/**
+ * Figures are drawn with static dispatch, so the drawing loops inline into the caller.
+ * Every figure provides:
+ *   pixels(acc) - calls acc(x, y) for every lit pixel
+ *   rows(acc)   - calls acc(y, x, mask) for every row, bit n of mask is the pixel at x + n
+ */
+template<class Derived>
 class Figure {
 public:
-    virtual void pixels(std::function<void(int, int)> acceptor) const = 0;
+    const Derived& self() const {
+        return static_cast<const Derived&>(*this);
+    }
 };
 
-class OnePixelAt : public Figure {
-    const Figure& _f;
+template<class F>
+class OnePixelAt : public Figure<OnePixelAt<F> > {
+    const F& _f;
     int _num;
 public:
 
-    OnePixelAt(const Figure& f, int num) : _f(f), _num(num) {}
+    OnePixelAt(const F& f, int num) : _f(f), _num(num) {}
 
-    virtual void pixels(std::function<void(int, int)> acceptor) const {
+    template<class Acceptor>
+    void pixels(Acceptor acceptor) const {
         int num = _num;
         _f.pixels([&](int x, int y) {
             if (num-- == 0) {
@@ -91,9 +84,21 @@ public:
             }
         });
     }
+
+    template<class Acceptor>
+    void rows(Acceptor acceptor) const {
+        pixels([&](int x, int y) {
+            acceptor(y, x, 1u);
+        });
+    }
 };
 
-class Rectangle : public Figure {
+template<class F>
+OnePixelAt<F> onePixelAt(const Figure<F>& f, int num) {
+    return OnePixelAt<F>(f.self(), num);
+}
+
+class Rectangle : public Figure<Rectangle> {
 public:
     const int x;
     const int y;
@@ -103,44 +108,84 @@ public:
     Rectangle() : x(0), y(0), w(0), h(0) {}
     Rectangle(int _x, int _y, int _w, int _h) : x(_x), y(_y), w(_w), h(_h) {}
 
-    virtual void pixels(std::function<void(int, int)> acceptor) const {
+    template<class Acceptor>
+    void pixels(Acceptor acceptor) const {
         for (int xx = x; xx < x + w; ++xx) {
             for (int yy = y; yy < y + h; ++yy) {
                 acceptor(xx, yy);
             }
         }
     }
+
+    template<class Acceptor>
+    void rows(Acceptor acceptor) const {
+        for (int yy = y; yy < y + h; ++yy) {
+            for (int xx = x; xx < x + w; xx += 32) {
+                int segW = std::min(x + w - xx, 32);
+                acceptor(yy, xx, segW == 32 ? 0xffffffffu : ((1u << segW) - 1));
+            }
+        }
+    }
 };
 
-class CharacterBitmask : public Figure {
+class CharacterBitmask : public Figure<CharacterBitmask> {
 private:
-    const uint8_t* symbol;
+    Glyph glyph;
+    bool found;
 public:
     CharacterBitmask(const wchar_t ch) {
-        symbol = symbolPtrOrNull(ch);
+        found = glyphOf(ch, glyph);
     }
 
-    virtual void pixels(std::function<void(int, int)> acceptor) const {
-        int symbolW = *symbol & 0xff;
+    template<class Acceptor>
+    void pixels(Acceptor acceptor) const {
+        if (!found) {
+            return;
+        }
+        int symbolW = glyph.width;
                 
         for (int x = 0; x < symbolW; ++x) {
-            uint8_t data = symbol[1 + x];
+            uint8_t data = glyph.column(x);
             for (int y = 0; y < 8; ++y) {
                 if ((data >> y) & 1)
                     acceptor(symbolW - x, y);
             }
         }
     }
+
+    template<class Acceptor>
+    void rows(Acceptor acceptor) const {
+        if (!found) {
+            return;
+        }
+        int symbolW = glyph.width;
+        uint8_t data[32];
+        for (int x = 0; x < symbolW; ++x) {
+            data[x] = glyph.column(x);
+        }
+
+        // Column x of the glyph is drawn at symbolW - x, so row masks start at 1
+        for (int y = 0; y < 8; ++y) {
+            uint32_t mask = 0;
+            for (int x = 0; x < symbolW; ++x) {
+                mask |= (uint32_t)((data[x] >> y) & 1) << (symbolW - 1 - x);
+            }
+            if (mask != 0) {
+                acceptor(y, 1, mask);
+            }
+        }
+    }
 };
 
-class Bitmask : public Figure {
+class Bitmask : public Figure<Bitmask> {
     typedef const uint8_t BitsContent[8];
 public:
     const BitsContent& bits;
     Bitmask(const BitsContent& _bits) : bits(_bits) {
     }
 
-    virtual void pixels(std::function<void(int, int)> acceptor) const {
+    template<class Acceptor>
+    void pixels(Acceptor acceptor) const {
         for (int yy = 0; yy < sizeof(bits); ++yy) {
             for (int i = 0; i < 8; ++i) {
                 if ((bits[yy] >> i) & 1) {
@@ -149,120 +194,292 @@ public:
             }
         }
     }
+
+    template<class Acceptor>
+    void rows(Acceptor acceptor) const {
+        for (int yy = 0; yy < sizeof(bits); ++yy) {
+            if (bits[yy] != 0) {
+                acceptor(yy, 0, (uint32_t)bits[yy]);
+            }
+        }
+    }
 };
 
 /**
- * Message to be shown on the screen
+ * Message to be shown on the screen. Text and its pre-rendered strip live in
+ * fixed buffers given by FixedMsg, so setting a message never touches the heap.
+ * Text that doesn't fit is cut at the last whole character. A message with no
+ * maxWidth only keeps its text, it has no strip and isn't cut by width.
  */
 class MsgToShow {
-    WSTR_MUTABLE _msg = NULL;
+    WSTR_MUTABLE _msg;
+    const int _maxChars;
+    uint8_t* _strip;
+    const int _maxWidth;
+
+    // The strip is 8 rows of _stripStride bytes, stored right to left: bit j of
+    // a row is column (_width - 1 - j) of the text, so that a screen window is
+    // a plain shift of each row.
+    int _stripStride = 0;
+    int _width = 0;
+    int _len = 0;
+    bool _set = false;
+    bool _truncated = false;
+
+    void rasterize() {
+        _width = 0;
+        if (_maxWidth == 0) {
+            return;
+        }
+        for (int i = 0; i < _len; ++i) {
+            Glyph glyph;
+            if (glyphOf(_msg[i], glyph)) {
+                int w = _width + (_width > 0 ? 1 : 0) + glyph.width;
+                if (w > _maxWidth) {
+                    _len = i;
+                    _msg[_len] = 0;
+                    _truncated = true;
+                    break;
+                }
+                _width = w;
+            }
+        }
+
+        _stripStride = (_width + 7) / 8;
+        memset(_strip, 0, 8 * _stripStride);
+
+        int k = 0; // Column from the start of the text
+        for (int i = 0; i < _len; ++i) {
+            Glyph glyph;
+            if (glyphOf(_msg[i], glyph)) {
+                for (int x = 0; x < glyph.width; ++x, ++k) {
+                    int j = _width - 1 - k;
+                    uint8_t data = glyph.column(x);
+                    for (int y = 0; data != 0; ++y, data >>= 1) {
+                        _strip[y * _stripStride + j / 8] |= (data & 1) << (j % 8);
+                    }
+                }
+                k++; // Space between symbols
+            }
+        }
+    }
+
+protected:
+    MsgToShow(WSTR_MUTABLE msg, int maxChars, uint8_t* strip, int maxWidth) :
+            _msg(msg),
+            _maxChars(maxChars),
+            _strip(strip),
+            _maxWidth(maxWidth) {
+    }
+
 public:
-    int strStartAt = 0;
+    uint32_t strStartAt = 0;
     int _totalMsToShow = 0;
 
-    WSTR c_str() {
+    MsgToShow(const MsgToShow&) = delete;
+
+    WSTR c_str() const {
         return _msg;
     }
 
-    bool isSet() {
-        return _msg != NULL;
+    /**
+     * Rendered width in pixels, same as LcdScreen::getStrWidth(c_str())
+     */
+    int width() const {
+        return _width;
+    }
+
+    /**
+     * True if the last set() had to cut the text
+     */
+    bool truncated() const {
+        return _truncated;
+    }
+
+    /**
+     * 8 columns of the rendered message as a row byte: bit n is the column 
+     * x - n counted from the start of the text. Columns outside of the text are 0.
+     */
+    uint8_t stripByte(int y, int x) const {
+        int pos = _width - 1 - x; // Bit of the strip row where the byte starts
+        if (_width == 0 || pos <= -8 || pos >= _width) {
+            return 0;
+        }
+        const uint8_t* row = _strip + y * _stripStride;
+        if (pos < 0) {
+            return row[0] << -pos;
+        }
+        int b = pos / 8;
+        int shift = pos % 8;
+        uint32_t v = row[b] >> shift;
+        if (shift != 0 && b + 1 < _stripStride) {
+            v |= (uint32_t)row[b + 1] << (8 - shift);
+        }
+        return v;
     }
 
-    bool empty() {
+    bool isSet() const {
+        return _set;
+    }
+
+    bool empty() const {
         return !isSet() || (_msg[0] == 0);
     }
 
     void clear() {
-        if (_msg != NULL) {
-            free(_msg);
-            _msg = NULL;
-        }
+        _set = false;
+        _truncated = false;
+        _len = 0;
+        _msg[0] = 0;
+        _width = 0;
+        _stripStride = 0;
     }
 
     void set(const WSTR* ss, uint32_t count) {
         clear();
-        uint32_t totalCnt = 0;
-        for (int i = 0; i < count; ++i) {
-            totalCnt += wcslen(ss[i]);
-        }
-        _msg = (WSTR_MUTABLE)malloc(2*totalCnt + 2);
-        WSTR_MUTABLE s = _msg;
-        for (int i = 0; i < count; ++i) {
+        for (uint32_t i = 0; i < count; ++i) {
             for (int t = 0; ss[i][t] != 0; ++t) {
-                *s = ss[i][t];
-                s++;
-                *s = 0;
+                if (_len == _maxChars) {
+                    _truncated = true;
+                    break;
+                }
+                _msg[_len++] = ss[i][t];
             }
         }
+        _msg[_len] = 0;
+        _set = true;
+        rasterize();
         strStartAt = millis();
     }
 
     void set(const char* utf8str, const int totalMsToShow) {
         clear();
         _totalMsToShow = totalMsToShow;
-        int maxSize = strlen(utf8str)*2;
-        _msg = (WSTR_MUTABLE)malloc(maxSize + 2);
-        memset(_msg, 0, maxSize + 2);
         int srcLen = strlen(utf8str);
-        for (int i = 0, outIndex = 0; utf8str[i] != 0;) {
-            uint16_t sym = utf8str[i];
-
-            if (
-                (sym & 0b11110000) == 0b11100000 && 
-                ((i + 1) < srcLen) && (utf8str[i+1] & 0b11000000) == 0b10000000 &&
-                ((i + 2) < srcLen) && (utf8str[i+2] & 0b11000000) == 0b10000000
-            ) {
-                    // If an UCS fits 16 bits, it is coded as 1110xxxx 10xxxxxx 10xxxxxx
-                _msg[outIndex++] = 
-                    (((sym & 0b1111) << 12) & 0b1111000000000000) |
-                    ((((uint16_t)utf8str[i+1] & 0b111111) << 6) & 0b111111000000) |
-                    ((uint16_t)utf8str[i+2] & 0b111111);
-
-                i+=3;
-            } else if (
-                (sym & 0b11100000) == 0b11000000 && 
-                ((i + 1) < srcLen) && (utf8str[i+1] & 0b11000000) == 0b10000000) {
-                // If an UCS fits 11 bits, it is coded as 110xxxxx 10xxxxxx
-                _msg[outIndex++] = (((sym & 0b11111) << 6) & 0b11111000000) |
-                    ((uint16_t)utf8str[i+1] & 0b111111);
-                i+=2;
-            } else if ((sym & 0b10000000) == 0) {
-                // If an UCS fits 7 bits, its coded as 0xxxxxxx. This makes ASCII character represented by themselves
-                _msg[outIndex++] = sym;
-                i++;
-            } else {
-                i++;
-            }
-        }
-
+        int used = 0;
+        _len = utf8::decode(utf8str, srcLen, _msg, _maxChars, used);
+        _msg[_len] = 0;
+        _truncated = used < srcLen;
+        _set = true;
+        rasterize();
         strStartAt = millis();
     }
 };
 
+template<int MaxChars, int MaxWidth>
+class FixedMsg : public MsgToShow {
+    wchar_t _msgBuf[MaxChars + 1];
+    uint8_t _stripBuf[8 * ((MaxWidth + 7) / 8) + 1];
+public:
+    FixedMsg() : MsgToShow(_msgBuf, MaxChars, _stripBuf, MaxWidth) {
+        clear();
+    }
+};
+
 class LcdScreen {
 
 private:
-    uint8_t screen[NUM_MAX * 8];
+    // One 8 byte block per module, blocks go row of modules by row of modules.
+    // Byte y % 8 of a block is a row, bit x % 8 is a pixel in it.
+    uint8_t* screen = NULL;
+    int _modulesWide = 0;
+    int _modulesHigh = 0;
+
+    // Rows figures may touch, see clipRows
+    int _clipTop = 0;
+    int _clipBottom = 0;
 
     uint32_t nextShowDateInMs = millis() + 5000;
 
-    MsgToShow _rollingMsg;
-    MsgToShow _tuningMsgNow;
-    MsgToShow _additionalInfo;
+    // Server messages and the date banner. A binary show carries 255 bytes, 127 letters
+    // of Cyrillic, and a letter takes at most 8 columns with the space after it
+    FixedMsg<128, 128 * 8> _rollingMsg;
+    FixedMsg<32, 32 * 8> _tuningMsgNow;    // Short statuses shown still, like "Ребут"
+    FixedMsg<48, 0> _additionalInfo;       // Only goes into the date banner as text, like the weather
+    date::DayCache _dayCache;
 
     const uint32_t _scrollSpeed = 35;
+    const int32_t _rollingWaitBefore = 300;
+    const int32_t _tuningMsgMs = 2000;
+
+    // Clock face animation: the colon dot runs for _colonBlinkMs at the start of
+    // every second, seconds slide in during the last _secondsSlideMs
+    const int _colonBlinkMs = 200;
+    const int _colonStepMs = 50;
+    const int _secondsSlideMs = 250;
+    const int _smallFontHeight = 6;
     uint32_t _blinkStart = 0;
     const uint32_t _blinkTime = 30;
 
-    uint32_t _showDayMin = 0;
+    // Day * 24 * 60 + minute the date banner was last shown in, none yet at first
+    uint32_t _shownDayMin = UINT32_MAX;
+
+    /**
+     * For how long msg is shown; the difference of millis() stays right across its wrap
+     */
+    static int32_t showedMs(const MsgToShow& msg) {
+        return std::max((int32_t)(millis() - msg.strStartAt), (int32_t)0);
+    }
 
 public:
     bool _showDay = true;
 
     static const int secInUs = 1000000;
+    static const int maxModules = 64;   // 512 bytes of framebuffer
 
-    LcdScreen() {
-        memset(screen, 0, sizeof(screen));
+    LcdScreen(int modulesWide = NUM_MAX, int modulesHigh = 1) {
+        setGeometry(modulesWide, modulesHigh);
+    }
+
+    LcdScreen(const LcdScreen&) = delete;
+
+    ~LcdScreen() {
+        free(screen);
+    }
+
+    /**
+     * Sizes the framebuffer for a panel of modulesWide x modulesHigh 8x8 modules.
+     * Meant to be called once at boot, before anything is drawn. False if the
+     * panel has more than maxModules or there's no memory for it, the geometry
+     * is kept as it was then.
+     */
+    bool setGeometry(int modulesWide, int modulesHigh) {
+        modulesWide = std::max(modulesWide, 1);
+        modulesHigh = std::max(modulesHigh, 1);
+        if (modulesWide > maxModules || modulesWide * modulesHigh > maxModules) {
+            return false;
+        }
+        uint8_t* buffer = (uint8_t*)malloc(modulesWide * modulesHigh * 8);
+        if (buffer == NULL) {
+            return false;
+        }
+        free(screen);
+        screen = buffer;
+        _modulesWide = modulesWide;
+        _modulesHigh = modulesHigh;
+        clear();
+        clipRows(0, height());
+        return true;
+    }
+
+    /**
+     * Figures drawn with set() and invert() only touch rows from..to-1 until the next call
+     */
+    void clipRows(int from, int to) {
+        _clipTop = std::max(from, 0);
+        _clipBottom = std::min(to, height());
+    }
+
+    int modulesWide() const {
+        return _modulesWide;
+    }
+
+    int modulesHigh() const {
+        return _modulesHigh;
+    }
+
+    int bufferSize() const {
+        return _modulesWide * _modulesHigh * 8;
     }
 
     bool fits(int x, int y) {
@@ -270,7 +487,7 @@ public:
     }
 
     int idx(int x, int y) {
-        int res = x / 8 * 8 + y;
+        int res = (y / 8 * _modulesWide + x / 8) * 8 + y % 8;
         return res;
     }
 
@@ -292,32 +509,81 @@ public:
         set(x, y, !get(x, y));
     }
 
-    void invert(int _x, int _y, const Figure& fg) {
-        fg.pixels([=](int x, int y) {
-            this->invert(_x + x, _y + y);
+    template<class F>
+    void invert(int _x, int _y, const Figure<F>& fg) {
+        fg.self().rows([=](int y, int x, uint32_t mask) {
+            this->applyRow(_x + x, _y + y, mask, [](uint8_t& line, uint8_t bits) { line ^= bits; });
         });
     }
 
-    void set(int _x, int _y, const Figure& fg, bool clr) {
-        fg.pixels([=](int x, int y) {
-            this->set(_x + x, _y + y, clr);
-        });
+    template<class F>
+    void set(int _x, int _y, const Figure<F>& fg, bool clr) {
+        if (clr) {
+            fg.self().rows([=](int y, int x, uint32_t mask) {
+                this->applyRow(_x + x, _y + y, mask, [](uint8_t& line, uint8_t bits) { line |= bits; });
+            });
+        } else {
+            fg.self().rows([=](int y, int x, uint32_t mask) {
+                this->applyRow(_x + x, _y + y, mask, [](uint8_t& line, uint8_t bits) { line &= ~bits; });
+            });
+        }
+    }
+
+    /**
+     * Applies op(line, bits) to the framebuffer bytes covered by a row mask,
+     * bit n of mask is the pixel at (x + n, y). Clipping is done once per row.
+     */
+    template<class Op>
+    void applyRow(int x, int y, uint32_t mask, Op op) {
+        if (y < _clipTop || y >= _clipBottom) {
+            return;
+        }
+        if (x < 0) {
+            if (x <= -32) {
+                return;
+            }
+            mask >>= -x;
+            x = 0;
+        }
+        while (mask != 0 && x < width()) {
+            int bit = x % 8;
+            uint8_t bits = (mask << bit) & 0xff;
+            if (bits != 0) {
+                op(screen[idx(x, y)], bits);
+            }
+            mask >>= 8 - bit;
+            x += 8 - bit;
+        }
     }
 
     void clear() {
-        memset(screen, 0, sizeof(screen));
+        memset(screen, 0, bufferSize());
+    }
+
+    /**
+     * Replaces the whole framebuffer with bufferSize() bytes in its layout
+     */
+    void load(const uint8_t* frame) {
+        memcpy(screen, frame, bufferSize());
     }
 
     uint8_t line8(int l) const {
         return screen[l];
     }
 
+    /**
+     * 8 rows of module n, modules are counted row by row from x = 0, y = 0
+     */
+    const uint8_t* block(int n) const {
+        return screen + n * 8;
+    }
+
     int height() const {
-        return 8;
+        return _modulesHigh * 8;
     }
 
     int width() const {
-        return NUM_MAX*8;
+        return _modulesWide * 8;
     }
 
     /**
@@ -352,12 +618,12 @@ public:
     int getStrWidth(WSTR str) {
         int res = 0;
         for (int i=0; str[i] != 0; ++i) {
-            const uint8_t* symbol = symbolPtrOrNull(str[i]);
-            if (symbol != NULL) {
+            Glyph glyph;
+            if (glyphOf(str[i], glyph)) {
                 if (res > 0) {
                     res += 1;
                 }
-                res += symbol[0];
+                res += glyph.width;
             }
         }
         return res;
@@ -382,22 +648,66 @@ public:
     int printStr(int _x, int _y, WSTR str) {
         int w = 0;
         for (int i=0; str[i] != 0; ++i) {
-            const uint8_t* symbol = symbolPtrOrNull(str[i]);
-            if (symbol > fontUA && symbol < (fontUA + sizeof(fontUA))) {
-                int symbolW = *symbol & 0xff;
-                
-                for (int x = 0; x < symbolW; ++x) {
-                    uint8_t data = symbol[1 + x];
-                    for (int y = 0; y < 8; ++y) {
-                        set(_x - w - x, y + _y, (data >> y) & 1);
-                    }
-                }
-                w += symbolW + 1;
+            Glyph glyph;
+            if (glyphOf(str[i], glyph)) {
+                blitColumns(_x - w, _y, glyph);
+                w += glyph.width + 1;
             }
         }
         return w;
     }
 
+    /**
+     * Draws glyph columns right to left: column i lands on x - i, bit n of a column
+     * byte is row y + n. All 8 rows of a column are replaced, as printStr always did.
+     * Clipping is done once for the whole glyph, not per pixel.
+     */
+    void blitColumns(int x, int y, const Glyph& glyph) {
+        int rowFrom = std::max(y, 0);
+        int rowTo = std::min(y + 8, height());
+        int first = std::max(x - (width() - 1), 0);
+        int last = std::min(x, glyph.width - 1);
+        if (rowFrom >= rowTo || first > last) {
+            return; // Completely outside
+        }
+
+        for (int i = first; i <= last; ++i) {
+            int xx = x - i;
+            uint8_t bit = 1 << (xx % 8);
+            // Bit n of the column is row y + n of the screen
+            uint32_t col = glyph.column(i);
+            for (int yy = rowFrom; yy < rowTo; ++yy) {
+                uint8_t& line = screen[idx(xx, yy)];
+                line = (line & ~bit) | (((col >> (yy - y)) & 1) ? bit : 0);
+            }
+        }
+    }
+
+    /**
+     * Same picture as printStr(x, y, msg.c_str()) on a cleared screen, but copies the
+     * pre-rendered strip of the message: the cost doesn't depend on its length.
+     */
+    void printStrip(int x, int y, const MsgToShow& msg) {
+        int rowFrom = std::max(y, 0);
+        int rowTo = std::min(y + 8, height());
+        for (int m = 0; m < _modulesWide; ++m) {
+            for (int yy = rowFrom; yy < rowTo; ++yy) {
+                screen[idx(m * 8, yy)] |= msg.stripByte(yy - y, x - m * 8);
+            }
+        }
+    }
+
+    /**
+     * Where the 32x8 clock face and the text line are drawn: the middle of the panel
+     */
+    int textX() const {
+        return width() - 1 - (width() - 32) / 2;
+    }
+
+    int textY() const {
+        return (height() - 8) / 2;
+    }
+
     void showTuningMsg(const char* utf8str) {
         _tuningMsgNow.set(utf8str, 3000);
     }
@@ -410,53 +720,115 @@ public:
         _additionalInfo.set(utf8str, 0);
     }
 
+    const MsgToShow& rollingMsg() const {
+        return _rollingMsg;
+    }
+
     /**
-     * micros is current time in microseconds
+     * Where the rolling message is drawn after showedTime ms, false once it is over
      */
-    void showTime(uint32_t daysSince1970, uint32_t millisSince1200) {
-        int millisNow = millis();
-        if (_tuningMsgNow.isSet()) {
-            uint32_t showedTime = millisNow - _tuningMsgNow.strStartAt;
-            printStr(width() - 1, 0, _tuningMsgNow.c_str());
-            if (showedTime > 2000) {
-                _tuningMsgNow.clear();
+    bool rollingMsgX(int32_t showedTime, int32_t& x) const {
+        int32_t waitBefore = _rollingWaitBefore;
+        int32_t extraTime = _rollingMsg._totalMsToShow == 0 ? 300 : std::max(_rollingMsg._totalMsToShow - showedTime - waitBefore, (int32_t)0);
+        int32_t strW = _rollingMsg.width();
+        int32_t w = width();
+        int32_t timeToShow = ((strW - w) * (int32_t)_scrollSpeed);
+        if (showedTime < waitBefore) {
+            x = w - 1;
+        } else if (showedTime < (waitBefore + timeToShow)) {
+            x = (showedTime - waitBefore) / (int32_t)_scrollSpeed + w;
+        } else if (showedTime < (waitBefore + timeToShow + extraTime)) {
+            if (strW < w) {
+                x = w - 1;
+            } else {
+                x = strW;
             }
-            return; // Nothing more
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * How far the seconds have slid down at ms into a second
+     */
+    int secondsSlideY(int ms) const {
+        if (ms >= (1000 - _secondsSlideMs)) {
+            return _smallFontHeight - (1000 - ms) * _smallFontHeight / _secondsSlideMs;
+        }
+        return 0;
+    }
+
+    /**
+     * In how many ms showTime will draw a different picture than it did just now.
+     * Rendering earlier only repeats the same frame.
+     */
+    uint32_t msToNextChange(uint32_t millisSince1200) const {
+        if (_tuningMsgNow.isSet()) {
+            int32_t showedTime = showedMs(_tuningMsgNow);
+            return std::max(_tuningMsgMs + 1 - showedTime, (int32_t)1);
         }
 
         if (_rollingMsg.isSet()) {
-            int32_t waitBefore = 300;
-            int32_t showedTime = std::max(millisNow - _rollingMsg.strStartAt, (int32_t)0);
-            int32_t extraTime = _rollingMsg._totalMsToShow == 0 ? 300 : std::max(_rollingMsg._totalMsToShow - showedTime - waitBefore, (int32_t)0);
-            int32_t strW = getStrWidth(_rollingMsg.c_str());
-            int32_t timeToShow = ((strW - 32) * _scrollSpeed);
+            // x only grows and the message ends once, so the first moment it looks
+            // different is found by galloping and then bisecting
+            int32_t showedTime = showedMs(_rollingMsg);
             int32_t x = 0;
-            bool stop = false;
-            if (showedTime < waitBefore) {
-                x = 31;
-            } else if (showedTime < (waitBefore + timeToShow)) {
-                x = (showedTime - waitBefore) / _scrollSpeed + 32;
-            } else if (showedTime < (waitBefore + timeToShow + extraTime)) {
-                if (strW < 32) {
-                    x = 31;
+            int32_t xx = 0;
+            rollingMsgX(showedTime, x);
+            int32_t same = 0;
+            int32_t changed = 1;
+            while (rollingMsgX(showedTime + changed, xx) && xx == x) {
+                same = changed;
+                changed *= 2;
+            }
+            while (changed - same > 1) {
+                int32_t mid = same + (changed - same) / 2;
+                if (rollingMsgX(showedTime + mid, xx) && xx == x) {
+                    same = mid;
                 } else {
-                    x = strW;
+                    changed = mid;
                 }
-            } else {
-                stop = true;
-                _rollingMsg.clear();
             }
+            return changed;
+        }
 
-            if (!stop) {
-                printStr(x, 0, _rollingMsg.c_str());
-                return;
-            }
-        } 
+        int ms = millisSince1200 % 1000;
+        if (ms < _colonBlinkMs) {
+            return _colonStepMs - ms % _colonStepMs;
+        }
+        if (ms < 1000 - _secondsSlideMs) {
+            return 1000 - _secondsSlideMs - ms;
+        }
+        int y = secondsSlideY(ms);
+        int next = ms + 1;
+        while (next < 1000 && secondsSlideY(next) == y) {
+            next++;
+        }
+        return next - ms;
+    }
+
+    /**
+     * micros is current time in microseconds
+     */
+    void showTime(uint32_t daysSince1970, uint32_t millisSince1200) {
+        if (_tuningMsgNow.isSet() && showedMs(_tuningMsgNow) > _tuningMsgMs) {
+            _tuningMsgNow.clear();
+        }
+        if (_tuningMsgNow.isSet()) {
+            printStrip(width() - 1, textY(), _tuningMsgNow);
+            return; // Nothing more
+        }
+
+        int32_t x = 0;
+        if (_rollingMsg.isSet() && !rollingMsgX(showedMs(_rollingMsg), x)) {
+            _rollingMsg.clear();
+        }
 
-        if (millisSince1200 / 1000 % 60 > 55 && _showDay && (_showDayMin != millisSince1200 / 1000 / 60)) {
-            _showDayMin = millisSince1200 / 1000 / 60;
-            date::RTC rtc = {0};
-            date::epoc2rtc(daysSince1970, rtc);
+        uint32_t dayMin = daysSince1970 * 24 * 60 + millisSince1200 / 1000 / 60;
+        if (!_rollingMsg.isSet() && millisSince1200 / 1000 % 60 > 55 && _showDay && _shownDayMin != dayMin) {
+            _shownDayMin = dayMin;
+            const date::RTC& rtc = _dayCache.get(daysSince1970);
             wchar_t yearStr[10] = { 0 };
             swprintf(yearStr, __countof(yearStr), L"%d", rtc.year);
             wchar_t dayStr[10] = { 0 };
@@ -475,6 +847,11 @@ public:
             //         " doy " + String(rtc.doy, 10) +
             //         " year " + String(rtc.year, 10) +
             //         " : " + String(daysSince1970, 10) );
+        }
+
+        if (_rollingMsg.isSet()) {
+            rollingMsgX(showedMs(_rollingMsg), x);
+            printStrip(x, textY(), _rollingMsg);
             return;
         }
         
@@ -488,37 +865,36 @@ public:
 
         clear();
 
+        // The face is laid out for 32x8, wider and taller panels get it in the middle
+        int ox = textX() - 31;
+        int oy = textY();
+
         // Mins
         // mins.charAt(n) - '0'
-        set(7, 0, CharacterBitmask(BIG_NUM_SYM + (mins.charAt(1) - '0')), true);
-        set(13, 0, CharacterBitmask(BIG_NUM_SYM + (mins.charAt(0) - '0')), true);
+        set(ox + 7, oy, CharacterBitmask(BIG_NUM_SYM + (mins.charAt(1) - '0')), true);
+        set(ox + 13, oy, CharacterBitmask(BIG_NUM_SYM + (mins.charAt(0) - '0')), true);
 
         // Hours
         /* hours.charAt(n) - '0'*/
-        set(20, 0, CharacterBitmask(BIG_NUM_SYM + (hours.charAt(1) - '0')), true);
-        set(26, 0, CharacterBitmask(BIG_NUM_SYM + (hours.charAt(0) - '0')), true);
+        set(ox + 20, oy, CharacterBitmask(BIG_NUM_SYM + (hours.charAt(1) - '0')), true);
+        set(ox + 26, oy, CharacterBitmask(BIG_NUM_SYM + (hours.charAt(0) - '0')), true);
 
-        int dotframe = 100;
-        if (millisSince1200 % 1000 < 200) {
-            set(19, 1, OnePixelAt(Rectangle(0, 0, 2, 2), millisSince1200 % 1000 / 50), true);
-            set(19, 5, OnePixelAt(Rectangle(0, 0, 2, 2), millisSince1200 % 1000 / 50), true);
+        if (millisSince1200 % 1000 < (uint32_t)_colonBlinkMs) {
+            set(ox + 19, oy + 1, onePixelAt(Rectangle(0, 0, 2, 2), millisSince1200 % 1000 / _colonStepMs), true);
+            set(ox + 19, oy + 5, onePixelAt(Rectangle(0, 0, 2, 2), millisSince1200 % 1000 / _colonStepMs), true);
         }
 
-        int movingTimeUs = 1000 / 4; // Period of time to do seconds moving transition
-        int smallFontHeight = 6;
+        // Seconds roll in from above the face, keep them off the modules over it
+        clipRows(oy, oy + 8);
+        int smallFontHeight = _smallFontHeight;
         for(int n = 1; n >= 0; n--) {
-            int y;
-            int ms  = (millisSince1200 % 1000);
-            if (ms >= (1000 - movingTimeUs)) {
-                y = (smallFontHeight - (1000 - ms) * smallFontHeight / movingTimeUs);
-            } else {
-                y = 0;
-            }
+            int y = secondsSlideY(millisSince1200 % 1000);
 
-            set(n*4 - 1, y, CharacterBitmask(TINY_NUM_SYM + (secs.charAt(1-n) - '0')), true);
-            set(n*4 - 1, y-smallFontHeight, CharacterBitmask(TINY_NUM_SYM + (nextSecs.charAt(1-n) - '0')), true);
-            set(n*4 - 1, y-smallFontHeight*2, CharacterBitmask(TINY_NUM_SYM + (nextNextSecs.charAt(1-n) - '0')), true);
+            set(ox + n*4 - 1, oy + y, CharacterBitmask(TINY_NUM_SYM + (secs.charAt(1-n) - '0')), true);
+            set(ox + n*4 - 1, oy + y-smallFontHeight, CharacterBitmask(TINY_NUM_SYM + (nextSecs.charAt(1-n) - '0')), true);
+            set(ox + n*4 - 1, oy + y-smallFontHeight*2, CharacterBitmask(TINY_NUM_SYM + (nextNextSecs.charAt(1-n) - '0')), true);
         }
+        clipRows(0, height());
     }
 };
 
@@ -543,34 +919,75 @@ class MAX72xx {
     #define OP_DISPLAYTEST 15 ///< MAX72xx opcode for DISPLAY TEST
 
 public:
+    /**
+     * How each module shows its 8x8 block of the framebuffer. 
+     * ROTATE_180 turns the whole panel, so the chain order is reversed as well.
+     * Mirroring flips the whole panel left to right before the rotation.
+     */
+    enum Orientation {
+        ROTATE_0,
+        ROTATE_90,
+        ROTATE_180,
+        ROTATE_270
+    };
+
+    /**
+     * How the chain goes through panels with several rows of modules.
+     * CHAIN_ROWS: every row of modules is wired the same way, the chain jumps back
+     * at the end of a row. CHAIN_SNAKE: the chain turns around at the end of a row,
+     * so every second row of modules is mounted turned on 180.
+     */
+    enum ChainOrder {
+        CHAIN_ROWS,
+        CHAIN_SNAKE
+    };
+
     MAX72xx(LcdScreen& _screen, 
-            const int _CLK_PIN,
-            const int _DATA_PIN,
-            const int _CS_PIN,
-            bool _rotated180) : 
-            screen(_screen), 
-            CLK_PIN(_CLK_PIN),
-            DATA_PIN(_DATA_PIN),
-            CS_PIN(_CS_PIN),
-            rotated180(_rotated180) {
+            MAX72xxTransport& _transport,
+            Orientation _orientation,
+            bool _mirrored = false,
+            ChainOrder _chainOrder = CHAIN_ROWS) : 
+            transport(_transport),
+            orientation(_orientation),
+            mirrored(_mirrored),
+            chainOrder(_chainOrder),
+            chainLength(_screen.modulesWide() * _screen.modulesHigh()),
+            screen(_screen) {
+        _sentLines = (uint8_t*)malloc(chainLength * 8);
+        _frame = (uint8_t*)malloc(chainLength * 8);
+        _latch = (uint8_t*)malloc(chainLength * 2);
+        if (_sentLines == NULL || _frame == NULL || _latch == NULL) {
+            // No memory for the chain: no modules, nothing is sent
+            free(_sentLines);
+            free(_frame);
+            free(_latch);
+            _sentLines = _frame = _latch = NULL;
+            chainLength = 0;
+            return;
+        }
+        memset(_sentLines, 0, chainLength * 8);
+    }
+
+    MAX72xx(const MAX72xx&) = delete;
+
+    ~MAX72xx() {
+        free(_sentLines);
+        free(_frame);
+        free(_latch);
     }
 
     void sendCmd(int addr, uint8_t cmd, uint8_t data) {
-        digitalWrite(CS_PIN, LOW);
-        for (int i = NUM_MAX - 1; i >= 0; i--) {
-            shiftOut(DATA_PIN, CLK_PIN, MSBFIRST, i == addr ? cmd : 0);
-            shiftOut(DATA_PIN, CLK_PIN, MSBFIRST, i == addr ? data : 0);
+        for (int i = chainLength - 1; i >= 0; i--) {
+            addPair(i, i == addr ? cmd : OP_NOOP, i == addr ? data : 0);
         }
-        digitalWrite(CS_PIN, HIGH);
+        sendLatch();
     }
 
     void sendCmdAll(uint8_t cmd, uint8_t data) {
-        digitalWrite(CS_PIN, LOW);
-        for (int i = NUM_MAX - 1; i >= 0; i--) {
-            shiftOut(DATA_PIN, CLK_PIN, MSBFIRST, cmd);
-            shiftOut(DATA_PIN, CLK_PIN, MSBFIRST, data);
+        for (int i = chainLength - 1; i >= 0; i--) {
+            addPair(i, cmd, data);
         }
-        digitalWrite(CS_PIN, HIGH);
+        sendLatch();
     }
 
     void setBrightness(int percents) {
@@ -579,52 +996,142 @@ public:
     }
 
     void setup() {
-        pinMode(CS_PIN, OUTPUT);
-        pinMode(DATA_PIN, OUTPUT);
-        pinMode(CLK_PIN, OUTPUT);
+        transport.setup();
 
         // sendCmdAll(OP_INTENSITY, 0); // minimum brightness
     }
 
+    /**
+     * Sends only digit rows that differ from what the chips last received.
+     * Every fullRefreshPeriodMs the init sequence and all rows are re-sent, 
+     * in case a chip lost its state because of noise on the lines.
+     */
     void refreshAll() {
-        if (millis() % 500 == 0) {
-            digitalWrite(CS_PIN, HIGH);
+        uint32_t now = millis();
+        bool full = _forceFullRefresh || (now - _lastFullRefresh) >= fullRefreshPeriodMs;
+        if (full) {
+            _forceFullRefresh = false;
+            _lastFullRefresh = now;
             sendCmdAll(OP_DISPLAYTEST, 0);
             sendCmdAll(OP_SCANLIMIT, 7);
             sendCmdAll(OP_DECODEMODE, 0);
             sendCmdAll(OP_SHUTDOWN, 1);
         }
 
-        LcdScreen screen2;
-        int w = screen.width();
-        int h = screen.height();
-        for (int x = 0; x < w; ++x) {
-            for (int y = 0; y < h; ++y) {
-                if (rotated180) {
-                    screen2.set(x, y, screen.get(x, y));
-                } else {
-                    screen2.set(w - (x + 1), h - (y + 1), screen.get(x, y));
-                }
+        composeLines(_frame);
+        for (int line = 0; line < 8; line++) {
+            bool changed = full;
+            for (int chip = 0; chip < chainLength && !changed; chip++) {
+                changed = _sentLines[chip * 8 + line] != _frame[chip * 8 + line];
+            }
+            if (!changed) {
+                continue;
+            }
+
+            for (int chip = chainLength - 1; chip >= 0; chip--) {
+                uint8_t data = _frame[chip * 8 + line];
+                addPair(chip, OP_DIGIT0 + line, data);
+                _sentLines[chip * 8 + line] = data;
             }
+            sendLatch();
         }
-        for (int line = 0; line < 8; line++) {
-            digitalWrite(CS_PIN, LOW);
-            for (int chip = NUM_MAX - 1; chip >= 0; chip--) {
-                shiftOut(DATA_PIN, CLK_PIN, MSBFIRST, OP_DIGIT0 + line);
-                shiftOut(DATA_PIN, CLK_PIN, MSBFIRST, screen2.line8(chip * 8 + line));
+
+        if (now - _statsWindowStart >= 1000) {
+            _bytesPerSecond = (_bytesSent - _bytesSentAtWindowStart) * 1000 / (now - _statsWindowStart);
+            _bytesSentAtWindowStart = _bytesSent;
+            _statsWindowStart = now;
+        }
+    }
+
+    /**
+     * Maps the framebuffer to what each chip shows: out[chip * 8 + line] is
+     * the OP_DIGIT0 + line byte of that chip, chip 0 is the first one in the chain.
+     */
+    void composeLines(uint8_t* out) const {
+        int cols = screen.modulesWide();
+        int rows = screen.modulesHigh();
+        for (int chip = 0; chip < chainLength; chip++) {
+            int mx = chip % cols;
+            int my = chip / cols;
+            bool turned = chainOrder == CHAIN_SNAKE && (my % 2) == 1;
+            if (turned) {
+                mx = cols - 1 - mx;
+            }
+            if (orientation == ROTATE_180) {
+                mx = cols - 1 - mx;
+                my = rows - 1 - my;
             }
-            digitalWrite(CS_PIN, HIGH);
+            if (mirrored) {
+                mx = cols - 1 - mx;
+            }
+
+            bitmatrix::Block b = bitmatrix::load(screen.block(my * cols + mx));
+            if (mirrored) {
+                b = bitmatrix::flipH(b);
+            }
+            switch ((orientation + (turned ? 2 : 0)) % 4) {
+                case ROTATE_0: break;
+                case ROTATE_90: b = bitmatrix::rotate90(b); break;
+                case ROTATE_180: b = bitmatrix::rotate180(b); break;
+                case ROTATE_270: b = bitmatrix::rotate270(b); break;
+            }
+            bitmatrix::store(b, out + chip * 8);
         }
-        digitalWrite(CS_PIN, LOW);
     }
 
+    int modules() const {
+        return chainLength;
+    }
+
+    /**
+     * Bytes shifted out to the chips since boot
+     */
+    uint32_t bytesSent() const {
+        return _bytesSent;
+    }
+
+    /**
+     * Bytes shifted out during the last full second of refreshes
+     */
+    uint32_t bytesSentPerSecond() const {
+        return _bytesPerSecond;
+    }
+
+    static const uint32_t fullRefreshPeriodMs = 1000;
+
   private:
-    const int CLK_PIN;
-    const int DATA_PIN;
-    const int CS_PIN;
-    const bool rotated180;
+    MAX72xxTransport& transport;
+    const Orientation orientation;
+    const bool mirrored;
+    const ChainOrder chainOrder;
+    int chainLength;     // 0 when there was no memory for the chain
 
     LcdScreen& screen;
+
+    uint8_t* _sentLines; // What each chip got last time, chip * 8 + line
+    uint8_t* _frame;     // Scratch for composeLines
+    uint8_t* _latch;     // Pairs of one latch, the last chip's pair goes first
+    bool _forceFullRefresh = true;
+    uint32_t _lastFullRefresh = 0;
+
+    uint32_t _bytesSent = 0;
+    uint32_t _bytesSentAtWindowStart = 0;
+    uint32_t _statsWindowStart = 0;
+    uint32_t _bytesPerSecond = 0;
+
+    void addPair(int chip, uint8_t cmd, uint8_t data) {
+        int pos = (chainLength - 1 - chip) * 2;
+        _latch[pos] = cmd;
+        _latch[pos + 1] = data;
+    }
+
+    void sendLatch() {
+        if (chainLength == 0) {
+            return;
+        }
+        transport.latch(_latch, chainLength * 2);
+        _bytesSent += chainLength * 2;
+    }
 };
 
 //======================================================================================================
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <SPI.h>
+#endif
+
+/**
+ * How bytes get to a chain of MAX72xx chips. A latch is one CS low..high burst:
+ * an opcode/data pair per chip, the first pair ends up in the last chip of the chain.
+ */
+class MAX72xxTransport {
+public:
+    virtual ~MAX72xxTransport() {}
+
+    virtual void setup() = 0;
+
+    virtual void latch(const uint8_t* data, int len) = 0;
+};
+
+/**
+ * shiftOut on any three pins. Slowest, but needs no particular wiring.
+ */
+class BitBangTransport : public MAX72xxTransport {
+    const int CLK_PIN;
+    const int DATA_PIN;
+    const int CS_PIN;
+
+public:
+    BitBangTransport(const int _CLK_PIN, const int _DATA_PIN, const int _CS_PIN) :
+            CLK_PIN(_CLK_PIN),
+            DATA_PIN(_DATA_PIN),
+            CS_PIN(_CS_PIN) {
+    }
+
+    virtual void setup() {
+        pinMode(CS_PIN, OUTPUT);
+        pinMode(DATA_PIN, OUTPUT);
+        pinMode(CLK_PIN, OUTPUT);
+        digitalWrite(CS_PIN, HIGH);
+    }
+
+    virtual void latch(const uint8_t* data, int len) {
+        digitalWrite(CS_PIN, LOW);
+        for (int i = 0; i < len; ++i) {
+            shiftOut(DATA_PIN, CLK_PIN, MSBFIRST, data[i]);
+        }
+        digitalWrite(CS_PIN, HIGH);
+    }
+};
+
+#ifdef ARDUINO
+/**
+ * Hardware SPI: CLK on D5 (SCLK), DATA on D7 (MOSI), CS on any pin.
+ * Every latch goes out as one burst from the SPI FIFO.
+ */
+class SpiTransport : public MAX72xxTransport {
+    const int CS_PIN;
+    const uint32_t clockHz;
+
+public:
+    SpiTransport(const int _CS_PIN, const uint32_t _clockHz = 8000000) :
+            CS_PIN(_CS_PIN),
+            clockHz(_clockHz) {
+    }
+
+    virtual void setup() {
+        SPI.begin();
+        // MISO is not used, so CS may sit on D6 where the bit-bang wiring had it
+        pinMode(CS_PIN, OUTPUT);
+        digitalWrite(CS_PIN, HIGH);
+    }
+
+    virtual void latch(const uint8_t* data, int len) {
+        SPI.beginTransaction(SPISettings(clockHz, MSBFIRST, SPI_MODE0));
+        digitalWrite(CS_PIN, LOW);
+        SPI.writeBytes(const_cast<uint8_t*>(data), len);
+        digitalWrite(CS_PIN, HIGH);
+        SPI.endTransaction();
+    }
+};
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Something to do at a moment of millis(), or never. The moment is compared by
+ * its difference from now, which keeps working when millis() wraps after 49.7
+ * days; never is a flag, not a far moment that millis() reaches in 24.8 days.
+ */
+class MillisTimer {
+    uint32_t _at = 0;
+    bool _armed = false;
+
+public:
+    /**
+     * Fires ms after now
+     */
+    void arm(uint32_t now, uint32_t ms) {
+        _at = now + ms;
+        _armed = true;
+    }
+
+    void disarm() {
+        _armed = false;
+    }
+
+    bool armed() const {
+        return _armed;
+    }
+
+    /**
+     * True once now reached the moment, until disarmed
+     */
+    bool passed(uint32_t now) const {
+        return _armed && (int32_t)(now - _at) >= 0;
+    }
+};
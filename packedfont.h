@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Variable width font, as generated by snippets/fontCompiler.cpp into fontdata.h.
+ * All arrays live in PROGMEM.
+ *
+ * A code point is found in three byte reads: its page (high byte) gives a row of
+ * 16 blocks, its block a row of 16 glyphs. Empty pages and blocks aren't stored,
+ * identical blocks are stored once. The columns of glyph g start at
+ * bases[g / 16] + offsets[g], the next glyph starts where it ends.
+ */
+struct PackedFont {
+    const uint8_t* pages;      // code point >> 8 -> row of blocks, or PACKED_NONE
+    const uint8_t* blocks;     // row * 16 + (code point >> 4 & 0xf) -> block, or PACKED_NONE
+    const uint8_t* index;      // block * 16 + (code point & 0xf) -> glyph, or PACKED_NONE
+    const uint16_t* bases;     // per 16 glyphs, where their columns start
+    const uint8_t* offsets;    // per glyph and one past the last, from the base of its 16
+    const uint8_t* data;       // one byte per column, bit n is row n from the top
+    uint8_t glyphCount;
+    uint8_t height;
+};
+
+const uint8_t PACKED_NONE = 0xFF;
+
+/**
+ * A glyph found in a PackedFont
+ */
+struct Glyph {
+    const uint8_t* data;
+    uint8_t width;
+
+    uint8_t column(int x) const {
+        return pgm_read_byte(data + x);
+    }
+};
+
+inline uint16_t packedOffset(const PackedFont& font, int g) {
+    return pgm_read_word(font.bases + g / 16) + pgm_read_byte(font.offsets + g);
+}
+
+/**
+ * Finds a glyph of a code point. Returns false if the font has none.
+ */
+inline bool findGlyph(const PackedFont& font, uint32_t codePoint, Glyph& glyph) {
+    if (codePoint > 0xffff) {
+        return false;
+    }
+    uint8_t row = pgm_read_byte(font.pages + (codePoint >> 8));
+    if (row == PACKED_NONE) {
+        return false;
+    }
+    uint8_t block = pgm_read_byte(font.blocks + row * 16 + (codePoint >> 4 & 0xf));
+    if (block == PACKED_NONE) {
+        return false;
+    }
+    uint8_t g = pgm_read_byte(font.index + block * 16 + (codePoint & 0xf));
+    if (g == PACKED_NONE) {
+        return false;
+    }
+    uint16_t from = packedOffset(font, g);
+    glyph.data = font.data + from;
+    glyph.width = packedOffset(font, g + 1) - from;
+    return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Decides when the screen has to be rendered. After every frame the content
+ * tells in how many ms it changes next, nothing is drawn until then.
+ * Counts rendered frames and the ones a fixed pollPeriodMs redraw would have
+ * drawn on top of them, per statsPeriodMs.
+ */
+class RenderScheduler {
+    uint32_t _deadline = 0;
+    bool _pending = true;
+
+    uint32_t _windowStart = 0;
+    uint32_t _renderedInWindow = 0;
+    uint32_t _rendered = 0;
+    uint32_t _skipped = 0;
+
+public:
+    const uint32_t pollPeriodMs;
+    const uint32_t maxSleepMs;
+    const uint32_t statsPeriodMs = 60000;
+
+    /**
+     * maxSleepMs bounds the wait even for a static picture, e.g. to let the
+     * display controller re-send its state now and then.
+     */
+    RenderScheduler(uint32_t _pollPeriodMs, uint32_t _maxSleepMs) :
+            pollPeriodMs(_pollPeriodMs),
+            maxSleepMs(_maxSleepMs) {
+    }
+
+    /**
+     * True if a frame has to be rendered now
+     */
+    bool due(uint32_t now) const {
+        return _pending || (int32_t)(now - _deadline) >= 0;
+    }
+
+    /**
+     * A frame was rendered at now, the next change comes in msToNextChange
+     */
+    void rendered(uint32_t now, uint32_t msToNextChange) {
+        _pending = false;
+        _deadline = now + (msToNextChange < maxSleepMs ? msToNextChange : maxSleepMs);
+        _renderedInWindow++;
+    }
+
+    /**
+     * Content changed from outside (new message, screen on/off), render asap
+     */
+    void invalidate() {
+        _pending = true;
+    }
+
+    /**
+     * Closes the stats window once statsPeriodMs passed, returns true if it did.
+     * rendered() and skipped() then describe the window just closed.
+     */
+    bool statsWindowPassed(uint32_t now) {
+        uint32_t elapsed = now - _windowStart;
+        if (elapsed < statsPeriodMs) {
+            return false;
+        }
+        uint32_t polled = elapsed / pollPeriodMs;
+        _rendered = _renderedInWindow;
+        _skipped = polled > _renderedInWindow ? polled - _renderedInWindow : 0;
+        _renderedInWindow = 0;
+        _windowStart = now;
+        return true;
+    }
+
+    uint32_t rendered() const {
+        return _rendered;
+    }
+
+    uint32_t skipped() const {
+        return _skipped;
+    }
+
+    uint32_t deadline() const {
+        return _deadline;
+    }
+};
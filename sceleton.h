@@ -7,6 +7,12 @@
 #include <WebSockets.h>
 #include <WebSocketsClient.h>
 #include <ESPAsyncWebServer.h>
+#include "millistimer.h"
+#include "jsonwriter.h"
+#include "jsoncommand.h"
+#include "binproto.h"
+#include "sendqueue.h"
+#include "statemodel.h"
 // #include <ArduinoOTA.h>
 
 // #define ESP01
@@ -39,9 +45,17 @@ public:
     virtual void switchRelay(uint32_t id, bool val) {}
     virtual boolean relayState(uint32_t id) { return false; } 
     virtual void setBrightness(int percents) {}
-    virtual void setTime(uint32_t unixTime) {}
+    /**
+     * ms is -1 when the server sent whole seconds only,
+     * requestId is the id of the timeRequest answered, -1 for a push
+     */
+    virtual void setTime(uint32_t unixTime, int ms, int requestId) {}
+    /**
+     * A frame of a stream to the screen, see FrameStream::received
+     */
+    virtual void streamFrame(uint32_t seq, uint32_t timestampMs, uint8_t encoding, const uint8_t* pixels, size_t length) {}
     virtual void setLedStripe(std::vector<uint32_t> colors) {}
-    virtual const std::vector<uint32_t>& getLedStripe() {}
+    virtual const std::vector<uint32_t>& getLedStripe() { static const std::vector<uint32_t> none; return none; }
     virtual void setD0PWM(uint32_t val) {}
     virtual void playMp3(uint32_t index) {}
     virtual void reboot() {}
@@ -63,7 +77,6 @@ String fileToString(const String& fileName) {
     return String();
 }
 
-const String typeKey("type");
 
 const char* firmwareVersion = "00.22";
 
@@ -71,14 +84,123 @@ std::auto_ptr<AsyncWebServer> setupServer;
 std::auto_ptr<WebSocketsClient> webSocketClient;
 
 long vccVal = 0;
-long rebootAt = 0x7FFFFFFF;
+MillisTimer rebootAt;
+
+// Messages to the server wait here for the network step, see drainQueue()
+typedef SendQueue<2048, 32> OutQueue;
+OutQueue sendQueue;
+MillisTimer queueStatsAt;
+
+// Key of the message being written: the hash of its type, for the queue to coalesce by
+uint32_t messageKey = 0;
+
+/**
+ * What the queue may do with the messages of the type: of readings only the latest
+ * matters, logs may go, the rest (keys, buttons, replies) is sent as it came
+ */
+uint8_t sendPolicy(uint32_t key) {
+    switch (key) {
+        case commandHash("potentiometer"):
+        case commandHash("weight"):
+        case commandHash("temp"):
+        case commandHash("humidity"):
+        case commandHash("pressure"):
+            return OutQueue::LATEST;
+        case commandHash("log"):
+            return OutQueue::DROP_OLDEST;
+    }
+    return OutQueue::KEEP;
+}
+
+/**
+ * Sends the first message waiting, this can wait for the TCP window
+ */
+void sendFront() {
+    if (sendQueue.frontBinary()) {
+        webSocketClient->sendBIN(sendQueue.frontData(), sendQueue.frontLength());
+    } else {
+        webSocketClient->sendTXT((const char*)sendQueue.frontData(), sendQueue.frontLength());
+    }
+    sendQueue.pop(micros());
+}
+
+/**
+ * Queues a message to send, it is dropped while there is no connection. When the
+ * queue is full of what it may not drop, the caller sends the oldest itself.
+ * Messages of one type from different sources, e.g. the temperatures of two
+ * sensors, are told apart by source so the queue doesn't take one for the other.
+ */
+void enqueue(const uint8_t* data, size_t length, bool binary, uint32_t key, uint8_t source = 0) {
+    if (webSocketClient.get() == NULL || !webSocketClient->isConnected()) {
+        return;
+    }
+    uint8_t policy = sendPolicy(key);
+    uint32_t queueKey = key + source * 0x9e3779b9u;
+    while (!sendQueue.push(data, length, binary, queueKey, policy, micros()) && !sendQueue.empty()) {
+        sendFront();
+    }
+}
+
+/**
+ * The network step: sends a few of the messages waiting, and none more once
+ * drainBudgetUs passed, so a slow connection holds a loop pass up by a message or so
+ */
+void drainQueue() {
+    const int drainMessages = 4;
+    const uint32_t drainBudgetUs = 2000;
+    if (!webSocketClient->isConnected()) {
+        sendQueue.clear();
+        return;
+    }
+    uint32_t start = micros();
+    for (int i = 0; i < drainMessages && !sendQueue.empty() && micros() - start < drainBudgetUs; ++i) {
+        sendFront();
+    }
+}
+
+/**
+ * Sends all that waits, before a reboot
+ */
+void flushQueue() {
+    while (webSocketClient.get() != NULL && webSocketClient->isConnected() && !sendQueue.empty()) {
+        sendFront();
+    }
+}
 
 void send(const String& toSend) {
-    webSocketClient->sendTXT(toSend.c_str(), toSend.length());
+    enqueue((const uint8_t*)toSend.c_str(), toSend.length(), false, 0);
+}
+
+// Every message to the server is written here, one at a time, hello is the longest
+char sendBuffer[1536];
+JsonWriter sendWriter(sendBuffer, sizeof(sendBuffer));
+
+/**
+ * Starts the message of the type in sendBuffer, fields go after it
+ */
+JsonWriter& message(const char* type) {
+    messageKey = commandHash(type);
+    sendWriter.reset();
+    return sendWriter.beginObject().field("type", type);
+}
+
+/**
+ * Closes the message started by message() and queues it; one cut off by the buffer is dropped
+ */
+void send(JsonWriter& msg, uint8_t source = 0) {
+    msg.endObject();
+    if (msg.overflowed()) {
+        debugSerial->println(String("Message too long: ") + msg.c_str());
+        return;
+    }
+    enqueue((const uint8_t*)msg.c_str(), msg.length(), false, messageKey, source);
 }
 
 class DevParam {
 public:
+    // Longer values are refused, so that each fits a message to the server by itself
+    static const size_t maxLength = 128;
+
     const char* _name;
     const char* _jsonName;
     const char* _description;
@@ -92,6 +214,17 @@ public:
         _value(value),
         _password(pwd) {
     }
+
+    /**
+     * false, and the value is kept, if val is longer than maxLength bytes
+     */
+    bool set(const String& val) {
+        if (val.length() > maxLength) {
+            return false;
+        }
+        _value = val;
+        return true;
+    }
 };
 
 DevParam deviceName("device.name", "name", "Device Name", String("ESP_") + ESP.getChipId());
@@ -101,10 +234,16 @@ DevParam wifiPwd("wifi.pwd", "wfpwd", "WiFi Password", "XXXX", true);
 DevParam logToHardwareSerial("debug.to.serial", "debugserial", "Print debug to serial", "true");
 DevParam websocketServer("websocket.server", "ws", "WebSocket server", "192.168.121.38");
 DevParam websocketPort("websocket.port", "wsport", "WebSocket port", "8080");
+DevParam ntpServer("ntp.server", "ntp", "NTP server, empty for none", "");
 #ifndef ESP01
 DevParam invertRelayControl("invertRelay", "invrelay", "Invert relays", "false");
 DevParam hasScreen("hasScreen", "screen", "Has screen", "false");
 DevParam hasScreen180Rotated("hasScreen180Rotated", "screen180", "Screen is rotated on 180", "false");
+DevParam screenModulesWide("screen.modules.wide", "scrwide", "Screen width in 8x8 modules", "4");
+DevParam screenModulesHigh("screen.modules.high", "scrhigh", "Screen height in 8x8 modules", "1");
+DevParam screenChainOrder("screen.chain", "scrchain", "Screen rows chain order (rows or snake)", "rows");
+DevParam screenHardwareSpi("screen.spi", "scrspi", "Screen on hardware SPI", "false");
+DevParam timeZone("time.zone", "tz", "Time zone as POSIX TZ, e.g. EET-2EEST,M3.5.0/3,M10.5.0/4", "MSK-3");
 DevParam hasHX711("hasHX711", "hx711", "Has HX711 (weight detector)", "false");
 DevParam hasIrReceiver("hasIrReceiver", "ir", "Has infrared receiver", "false");
 DevParam hasDS18B20("hasDS18B20", "ds18b20", "Has DS18B20 (temp sensor)", "false");
@@ -124,6 +263,9 @@ DevParam relayNames("relay.names", "relays", "Relay names, separated by ;", "");
 DevParam hasGPIO1Relay("hasGPIO1Relay", "gpio1relay", "Has GPIO1 Relay", "false");
 DevParam hasPWMOnD0("hasPWMOnD0", "pwmOnD0", "Has PWM on D0", "false");
 DevParam secondsBeforeRestart("secondsBeforeRestart", "watchdog", "Seconds before restart", "60000");
+DevParam telemetryInterval("telemetry.interval", "telemetryms", "Send sensor readings together every ms, 0 for each by itself", "0");
+DevParam telemetryThresholds("telemetry.thresholds", "telemetrythr", "Least change of a reading to send, by type",
+    "temp:0.1;humidity:0.5;pressure:20;weight:100;potentiometer:1");
 
 uint32_t msBeforeRestart = atoi(secondsBeforeRestart._value.c_str());
 
@@ -135,10 +277,16 @@ DevParam* devParams[] = {
     &logToHardwareSerial,
     &websocketServer, 
     &websocketPort, 
+    &ntpServer,
 #ifndef ESP01
     &invertRelayControl, 
     &hasScreen, 
     &hasScreen180Rotated,
+    &screenModulesWide,
+    &screenModulesHigh,
+    &screenChainOrder,
+    &screenHardwareSpi,
+    &timeZone,
     &hasHX711,
     &hasIrReceiver,
     &hasDS18B20,
@@ -159,16 +307,45 @@ DevParam* devParams[] = {
     &hasSolidStateRelay,
 #endif
     &hasPWMOnD0,
-    &secondsBeforeRestart
+    &secondsBeforeRestart,
+    &telemetryInterval,
+    &telemetryThresholds
 }; 
 Sink* sink = new Sink();
 boolean initializedWiFi = false;
 uint32_t lastReceived = millis();
-uint32_t reconnectWebsocketAt = 0x7FFFFFFF; // Never by def
+MillisTimer reconnectWebsocketAt;
 uint32_t reportedGoingToReconnect = millis();
 
+// While a batch runs, the relays it switched, reported in its batchAck instead
+bool batching = false;
+uint32_t batchRelays = 0;
+
 void reportRelayState(uint32_t id) {
-    send("{ \"type\": \"relayState\", \"id\": " + String(id, DEC) + ", \"value\":" + (sink->relayState(id) ? "true" : "false") + " }");
+    if (batching) {
+        if (id < 32) {
+            batchRelays |= 1u << id;
+        }
+        return;
+    }
+    send(message("relayState").field("id", id).field("value", sink->relayState(id)));
+}
+
+/**
+ * Relays named in relayNames, separated by ';'; none without a ';'
+ */
+int relayCount() {
+    int cnt = 0;
+    for (const char* p = relayNames._value.c_str(); *p != 0; ++p) {
+        if (*p == ';') {
+            if (cnt == 0) {
+                cnt = 1;
+            }
+
+            cnt++;
+        }
+    }
+    return cnt;
 }
 
 void onDisconnect(const WiFiEventStationModeDisconnected& event) {
@@ -240,14 +417,548 @@ std::vector<uint32_t> decodeRGBWString(const char* val) {
 }
 
 bool wasConnected = false;
-uint32_t saveBrightnessAt = 0x7FFFFFFF;
+MillisTimer saveBrightnessAt;
+
+// Every command from the server is parsed into it, one at a time. ArduinoJson 6
+// parses the writable payload in place, so only the values take room: a batch of
+// maxBatch commands of up to three fields is 51 slots, 816 bytes on the ESP8266.
+// The rest is for one-off commands and for the strings the emulator's mock copies.
+const int maxBatch = 12;
+StaticJsonDocument<2000> commandDoc;
+static_assert(JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(maxBatch) + maxBatch * JSON_OBJECT_SIZE(3) <= 2000,
+    "a batch of maxBatch fits commandDoc");
+
+// The server answered hello with "binary", readings that have a kind go as binary frames
+bool binaryTelemetry = false;
+
+// Every binary frame to the server is written here, one at a time
+uint8_t binSendBuffer[300];
+binproto::Writer binSendWriter(binSendBuffer, sizeof(binSendBuffer));
+
+// Texts of a binary command, terminated
+char binText[256];
+
+/**
+ * Starts the binary frame of the kind in binSendBuffer, fields go after it
+ */
+binproto::Writer& binMessage(uint8_t kind) {
+    const char* name = binproto::kindName(kind);
+    messageKey = commandHash(name != NULL ? name : "");
+    return binSendWriter.begin(kind);
+}
+
+void send(binproto::Writer& msg, uint8_t source = 0) {
+    if (msg.overflowed()) {
+        debugSerial->println("Binary message too long");
+        return;
+    }
+    enqueue(msg.data(), msg.length(), true, messageKey, source);
+}
+
+// The state the server syncs, see StateModel
+StateModel state;
+const char* relayFields[] = { "relay0", "relay1", "relay2", "relay3", "relay4", "relay5", "relay6", "relay7" };
+// The server asked for the state with stateSince, changes go to it as they come
+bool stateSync = false;
+uint32_t stateSentVersion = 0;
+
+/**
+ * Writes the devParams from the from'th on as the "devParams" object of msg, as many
+ * as leave room to close the message. Returns the index of the first one left out.
+ */
+size_t writeDevParams(JsonWriter& msg, size_t from) {
+    const size_t count = sizeof(devParams) / sizeof(devParams[0]);
+    msg.beginObject("devParams");
+    size_t i = from;
+    for (; i < count; ++i) {
+        DevParam* d = devParams[i];
+        if (d->_password || d->_value == "false") {
+            continue;
+        }
+        JsonWriter::Mark m = msg.mark();
+        msg.field(d->_name, d->_value.c_str());
+        if (msg.overflowed() || msg.length() + 2 >= sizeof(sendBuffer)) {
+            msg.rewind(m);
+            break;
+        }
+    }
+    msg.endObject();
+    return i;
+}
+
+/**
+ * hello with all we can show. The devParams that don't fit it follow in devParams
+ * messages, each value fits one of them as DevParam::maxLength bounds it.
+ */
+void sendHello() {
+    const size_t count = sizeof(devParams) / sizeof(devParams[0]);
+    JsonWriter& hello = message("hello");
+    hello.field("firmware", firmwareVersion);
+    // A number, as it always was
+    hello.field("screenEnabled", sink->screenEnabled() ? 1 : 0);
+    hello.field("deviceName", sceleton::deviceName._value.c_str());
+    hello.field("binary", binproto::version);
+    hello.field("stateEpoch", state.epoch());
+    hello.field("stateVersion", state.version());
+    size_t next = writeDevParams(hello, 0);
+    send(hello);
+    while (next < count) {
+        JsonWriter& more = message("devParams");
+        size_t after = writeDevParams(more, next);
+        send(more);
+        next = after > next ? after : next + 1;
+    }
+}
+
+/**
+ * The fields of the state and what they are at boot
+ */
+void initState() {
+    state.setEpoch(RANDOM_REG32);
+    state.add("firmware", StateModel::TEXT);
+    state.setText("firmware", firmwareVersion);
+    for (int id = 0; id < relayCount() && id < (int)(sizeof(relayFields) / sizeof(relayFields[0])); ++id) {
+        state.add(relayFields[id], StateModel::FLAG);
+        state.set(relayFields[id], sink->relayState(id));
+    }
+    state.add("screenEnabled", StateModel::FLAG);
+    state.set("screenEnabled", sink->screenEnabled());
+#ifndef ESP01
+    state.add("brightness", StateModel::INTEGER);
+    state.set("brightness", brightness._value.toInt());
+#endif
+    if (hasLedStripe._value == "true") {
+        state.add("ledstripe", StateModel::TEXT);
+        state.setText("ledstripe", encodeRGBWString(sink->getLedStripe()).c_str());
+    }
+    // Readings change all the time, the server hears of them in telemetry
+    state.add("temp", StateModel::NUMBER, false);
+    state.add("humidity", StateModel::NUMBER, false);
+    state.add("pressure", StateModel::NUMBER, false);
+    state.add("weight", StateModel::INTEGER, false);
+    state.add("potentiometer", StateModel::INTEGER, false);
+}
+
+String stateText(const char* name) {
+    if (strcmp(name, "ledstripe") == 0) {
+        return encodeRGBWString(sink->getLedStripe());
+    }
+    return firmwareVersion;
+}
+
+/**
+ * Sends what changed in the state since the version, all of it for 0
+ */
+void sendState(uint32_t since) {
+    JsonWriter& msg = message("state")
+        .field("epoch", state.epoch())
+        .field("version", state.version())
+        .field("since", since);
+    state.write(msg, since, stateText);
+    send(msg);
+    stateSentVersion = state.version();
+}
+
+/**
+ * The relays and the LED stripe one message each, as every server got them on
+ * connect before there was a state to sync
+ */
+void sendLegacyState() {
+    int cnt = relayCount();
+    if (cnt > 0) {
+        for (int id = 0; id < cnt; ++id) {
+            reportRelayState(id);
+        }
+        debugSerial->println("Relays state sent");
+    }
+
+    if (sceleton::hasLedStripe._value == "true") {
+        send(message("ledstripeState").field("value", encodeRGBWString(sink->getLedStripe()).c_str()));
+        debugSerial->println("LED stripe state sent");
+    }
+}
+
+// What the commands do, whether they came as JSON or binary
+
+void applySwitch(uint32_t id, bool on) {
+    sink->switchRelay(id, on);
+    if (id < sizeof(relayFields) / sizeof(relayFields[0])) {
+        state.set(relayFields[id], sink->relayState(id));
+    }
+    reportRelayState(id);
+}
+
+#ifndef ESP01
+void applyUnixtime(uint32_t value, int ms, int id) {
+    sink->setTime(value, ms, id);
+}
+
+void applyBrightness(int val) {
+    val = std::max(std::min(val, 100), 0);
+    sink->setBrightness(val);
+    brightness._value = String(val, DEC);
+    state.set("brightness", val);
+    saveBrightnessAt.arm(millis(), 1000); // In 1 second, save brightness
+}
+#endif
+
+void applyLedStripe(const std::vector<uint32_t>& colors) {
+    sink->setLedStripe(colors);
+    state.setText("ledstripe", encodeRGBWString(sink->getLedStripe()).c_str());
+}
+
+void applyPlayMp3(uint32_t index) {
+    debugSerial->print("playmp3 ");
+    debugSerial->println(index);
+    sink->playMp3(index);
+}
+
+void onPing(const JsonObject& root) {
+    const char* pingId = root["pingid"];
+    debugSerial->print(String(millis(), DEC) + ":");debugSerial->print("Ping "); debugSerial->println(pingId);
+    send(message("pingresult").field("pid", pingId != NULL ? pingId : ""));
+}
+
+void onSwitch(const JsonObject& root) {
+    applySwitch(atoi(root["id"]), root["on"] == "true");
+}
+
+void onSetProp(const JsonObject& root) {
+    saveSettings();
+}
+
+#ifndef ESP01
+void onShow(const JsonObject& root) {
+    sink->showMessage(root["text"], root["totalMsToShow"].as<int>());
+}
+
+void onTune(const JsonObject& root) {
+    sink->showTuningMsg(root["text"]);
+}
+
+void onUnixtime(const JsonObject& root) {
+    applyUnixtime(root["value"].as<int>(),
+        root.containsKey("ms") ? root["ms"].as<int>() : -1,
+        root.containsKey("id") ? root["id"].as<int>() : -1);
+}
+
+void onScreenEnable(const JsonObject& root) {
+    int val = root["value"].as<boolean>();
+    sink->enableScreen(val);
+    state.set("screenEnabled", sink->screenEnabled());
+    saveBrightnessAt.arm(millis(), 1000); // In 1 second, save brightness
+}
+
+void onBrightness(const JsonObject& root) {
+    applyBrightness(root["value"].as<int>());
+}
+#endif
+
+void onLedStripe(const JsonObject& root) {
+    const char* val = (const char*)(root["value"]);
+    applyLedStripe(decodeRGBWString(val));
+}
+
+void onPlayMp3(const JsonObject& root) {
+    applyPlayMp3((uint32_t)(root["index"].as<int>()));
+}
+
+void onPwm(const JsonObject& root) {
+    int val = root["value"].as<int>();
+    sink->setD0PWM(val);
+}
+
+void onAdditionalInfo(const JsonObject& root) {
+    sink->setAdditionalInfo(root["text"]);
+}
+
+void onReboot(const JsonObject& root) {
+    debugPrint("Let's reboot self");
+    sink->reboot();
+}
+
+void onBinary(const JsonObject& root) {
+    binaryTelemetry = root["version"].as<int>() == binproto::version;
+}
+
+/**
+ * The server knows the state up to a version of an epoch, 0 if it knows nothing
+ */
+void onStateSince(const JsonObject& root) {
+    uint32_t since = root["version"].as<unsigned long>();
+    if (!state.knows(root["epoch"].as<unsigned long>(), since)) {
+        since = 0;
+    }
+    stateSync = true;
+    sendState(since);
+}
+
+void onBatch(const JsonObject& root);
+
+#define COMMAND(name, handler) case commandHash(name): if (strcmp(type, name) == 0) { handler(root); return true; } break;
+
+/**
+ * Runs the command of the type, false if there is no such
+ */
+bool dispatchCommand(const char* type, const JsonObject& root) {
+    switch (commandHash(type)) {
+        COMMAND("ping", onPing)
+        COMMAND("switch", onSwitch)
+        COMMAND("setProp", onSetProp)
+    #ifndef ESP01
+        COMMAND("show", onShow)
+        COMMAND("tune", onTune)
+        COMMAND("unixtime", onUnixtime)
+        COMMAND("screenEnable", onScreenEnable)
+        COMMAND("brightness", onBrightness)
+    #endif
+        COMMAND("ledstripe", onLedStripe)
+        COMMAND("playmp3", onPlayMp3)
+        COMMAND("pwm", onPwm)
+        COMMAND("additional-info", onAdditionalInfo)
+        COMMAND("reboot", onReboot)
+        COMMAND("binary", onBinary)
+        COMMAND("stateSince", onStateSince)
+        COMMAND("batch", onBatch)
+    }
+    return false;
+}
+
+#undef COMMAND
+
+void onBinaryBatch(const binproto::Reader& r);
+
+/**
+ * Runs a binary command, false if its kind is no command here
+ */
+bool dispatchBinary(const binproto::Reader& r) {
+    using namespace binproto;
+    switch (r.kind()) {
+        case SWITCH:
+            applySwitch(r.u32(ID), r.u32(ON) != 0);
+            return true;
+    #ifndef ESP01
+        case SHOW:
+            sink->showMessage(r.text(TEXT, binText, sizeof(binText)), r.i32(DURATION_MS));
+            return true;
+        case BRIGHTNESS:
+            applyBrightness(r.i32(VALUE));
+            return true;
+        case UNIXTIME:
+            applyUnixtime(r.u32(VALUE), r.i32(MS, -1), r.i32(REQUEST_ID, -1));
+            return true;
+        case FRAME: {
+            size_t length;
+            const uint8_t* p = r.bytes(PIXELS, length);
+            sink->streamFrame(r.u32(SEQ), r.u32(TIMESTAMP_MS), r.u32(ENCODING), p, length);
+            return true;
+        }
+    #endif
+        case LEDSTRIPE: {
+            // A whole stripe is more than a field holds, the COLORS fields join up
+            std::vector<uint32_t> colors;
+            uint32_t color = 0;
+            size_t got = 0;
+            size_t length;
+            size_t at = 0;
+            for (const uint8_t* p; (p = r.next(COLORS, length, at)) != NULL;) {
+                for (size_t i = 0; i < length; ++i) {
+                    color = color << 8 | p[i];
+                    if (++got % 4 == 0) {
+                        colors.push_back(color);
+                    }
+                }
+            }
+            applyLedStripe(colors);
+            return true;
+        }
+        case PLAYMP3:
+            applyPlayMp3(r.u32(INDEX));
+            return true;
+        case PWM:
+            sink->setD0PWM(r.u32(VALUE));
+            return true;
+        case BATCH:
+            onBinaryBatch(r);
+            return true;
+    }
+    return false;
+}
+
+/**
+ * A relay a batch may switch: one of relayNames, and within batchRelays
+ */
+bool batchRelay(long id) {
+    return id >= 0 && id < relayCount() && id < 32;
+}
+
+/**
+ * Commands a batch may carry, with the fields each can't go without: those
+ * which set what the device shows or switches. The rest (reboot, setProp,
+ * another batch) stay one per frame.
+ */
+struct BatchCommand {
+    const char* type;
+    const char* needs[2];
+} batchCommands[] = {
+    { "switch", { "id", "on" } },
+#ifndef ESP01
+    { "show", { "text", NULL } },
+    { "tune", { "text", NULL } },
+    { "screenEnable", { "value", NULL } },
+    { "brightness", { "value", NULL } },
+#endif
+    { "ledstripe", { "value", NULL } },
+    { "playmp3", { "index", NULL } },
+    { "pwm", { "value", NULL } },
+    { "additional-info", { "text", NULL } },
+};
+
+/**
+ * What keeps the command out of a batch, NULL if nothing does
+ */
+const char* batchProblem(const JsonObject& cmd) {
+    if (cmd.isNull()) {
+        return "not an object";
+    }
+    const char* type = cmd["type"];
+    if (type == NULL) {
+        return "no type";
+    }
+    for (const BatchCommand& c : batchCommands) {
+        if (strcmp(c.type, type) == 0) {
+            for (const char* field : c.needs) {
+                if (field != NULL && !cmd.containsKey(field)) {
+                    return "missing field";
+                }
+            }
+            return strcmp(type, "switch") == 0 && !batchRelay(atoi(cmd["id"])) ? "no such relay" : NULL;
+        }
+    }
+    return "not allowed in a batch";
+}
+
+/**
+ * What keeps the binary command out of a batch, NULL if nothing does
+ */
+const char* batchProblem(const binproto::Reader& cmd) {
+    using namespace binproto;
+    if (!cmd.valid()) {
+        return "not a frame";
+    }
+    switch (cmd.kind()) {
+        case SWITCH:
+            if (!cmd.has(ID) || !cmd.has(ON)) {
+                return "missing field";
+            }
+            return batchRelay(cmd.u32(ID)) ? NULL : "no such relay";
+    #ifndef ESP01
+        case SHOW:
+            return cmd.has(TEXT) ? NULL : "missing field";
+        case BRIGHTNESS:
+    #endif
+        case PWM:
+            return cmd.has(VALUE) ? NULL : "missing field";
+        case LEDSTRIPE:
+            return cmd.has(COLORS) ? NULL : "missing field";
+        case PLAYMP3:
+            return cmd.has(INDEX) ? NULL : "missing field";
+    }
+    return "not allowed in a batch";
+}
+
+/**
+ * The batch was refused as a whole at the command of index, nothing of it ran
+ */
+void refuseBatch(long id, const char* error, int index) {
+    send(message("batchAck").field("id", id).field("applied", 0).field("error", error).field("index", index));
+}
+
+void beginBatch() {
+    batching = true;
+    batchRelays = 0;
+}
+
+/**
+ * The batch ran: one batchAck with the relays it switched, and the state
+ * version after it, instead of a message per command
+ */
+void endBatch(long id, int applied) {
+    batching = false;
+    JsonWriter& msg = message("batchAck").field("id", id).field("applied", applied).field("version", state.version());
+    msg.beginObject("relays");
+    for (uint32_t i = 0; i < 32; ++i) {
+        if (batchRelays & (1u << i)) {
+            char name[4];
+            snprintf(name, sizeof(name), "%u", (unsigned)i);
+            msg.field(name, sink->relayState(i));
+        }
+    }
+    msg.endObject();
+    send(msg);
+}
+
+/**
+ * Commands in "commands" which run together: all are checked first, and if
+ * one can't run none does. They run within this loop iteration, one after
+ * another, and are answered by one batchAck.
+ */
+void onBatch(const JsonObject& root) {
+    long id = root["id"].as<long>();
+    JsonArray commands = root["commands"].as<JsonArray>();
+    if (commands.isNull() || commands.size() == 0 || commands.size() > (size_t)maxBatch) {
+        refuseBatch(id, commands.size() > (size_t)maxBatch ? "too many commands" : "no commands", -1);
+        return;
+    }
+    for (size_t i = 0; i < commands.size(); ++i) {
+        const char* problem = batchProblem(commands[i].as<JsonObject>());
+        if (problem != NULL) {
+            refuseBatch(id, problem, i);
+            return;
+        }
+    }
+    beginBatch();
+    for (size_t i = 0; i < commands.size(); ++i) {
+        JsonObject cmd = commands[i].as<JsonObject>();
+        dispatchCommand(cmd["type"], cmd);
+    }
+    endBatch(id, commands.size());
+}
+
+/**
+ * A binary batch: its COMMAND fields, each a whole frame, checked and run as onBatch does
+ */
+void onBinaryBatch(const binproto::Reader& r) {
+    using namespace binproto;
+    long id = r.i32(REQUEST_ID);
+    size_t length;
+    size_t at = 0;
+    int count = 0;
+    for (const uint8_t* p; (p = r.next(COMMAND, length, at)) != NULL; ++count) {
+        const char* problem = count < maxBatch ? batchProblem(Reader(p, length)) : "too many commands";
+        if (problem != NULL) {
+            refuseBatch(id, problem, count);
+            return;
+        }
+    }
+    if (count == 0) {
+        refuseBatch(id, "no commands", -1);
+        return;
+    }
+    beginBatch();
+    at = 0;
+    for (const uint8_t* p; (p = r.next(COMMAND, length, at)) != NULL; ) {
+        dispatchBinary(Reader(p, length));
+    }
+    endBatch(id, count);
+}
 
 void WiFiEvent(WiFiEvent_t event) {
     debugSerial->print("WiFi event "); debugSerial->println(event);
 }
 
 class DummySerial: public Stream {
-    virtual size_t write(uint8_t) {}
+    virtual size_t write(uint8_t) { return 1; }
     virtual int available() { return 0; }
     virtual int read() { return -1; }
     virtual int peek() { return -1; }
@@ -276,7 +987,9 @@ void setup(Sink* _sink) {
         if (error == DeserializationError::Ok) {
             const JsonObject &root = jsonBuffer.as<JsonObject>();
             for (DevParam* d : devParams) {
-                d->_value = (const char*) (root[d->_jsonName]);
+                if (!d->set((const char*) (root[d->_jsonName]))) {
+                    debugSerial->println(String("Too long, the default is kept: ") + d->_name);
+                }
             }
         } else {
             debugSerial->println("No settings read, use defaults");    
@@ -288,6 +1001,7 @@ void setup(Sink* _sink) {
     }
 
     msBeforeRestart = atoi(secondsBeforeRestart._value.c_str());
+    initState();
 
     debugSerial->println("Initialized in " + String(millis() - was, DEC));
     debugSerial->println(wifiName._value.c_str());
@@ -342,151 +1056,62 @@ void setup(Sink* _sink) {
                     if (wasConnected) { 
                         break;
                     }
-                    reconnectWebsocketAt = 0x7FFFFFFF;  // No need to reconnect anymore
+                    reconnectWebsocketAt.disarm();  // No need to reconnect anymore
                     debugSerial->println("Connected to server");
                     lastReceived = millis();
                     wasConnected = true;
-
-                    String devParamsStr = "{ ";
-                    bool first = true;
-                    for (DevParam* d : devParams) {
-                        if (!d->_password && d->_value != "false") {
-                            if (!first) { 
-                                devParamsStr += ",";
-                            }
-                            first = false;
-                            devParamsStr += "\"",
-                            devParamsStr += d->_name;
-                            devParamsStr += "\": \"",
-                            devParamsStr += d->_value;
-                            devParamsStr += "\" ";
-                        }
-                    }
-                    devParamsStr += "}";
+                    binaryTelemetry = false;  // Until this server says it reads it
+                    queueStatsAt.arm(millis(), 60000);
 
                     // Let's say hello and show all we can
-                    send(String("{ ") +
-                        "\"type\":\"hello\", " +
-                        "\"firmware\":\"" + firmwareVersion + "\", " +
-                        "\"devParams\": " + devParamsStr + ", " + 
-                        "\"screenEnabled\": " + sink->screenEnabled() + ", " + 
-                        "\"deviceName\":\"" + sceleton::deviceName._value + "\"" + 
-                        " }");
+                    sendHello();
 
                     // send message to client
                     // debugPrint("Hello server " + " (" + sceleton::deviceName._value +  "), firmware ver = " + firmwareVersion);
                     debugSerial->println("Hello sent");
 
-                    int cnt = 0;
-                    for (const char* p = sceleton::relayNames._value.c_str(); *p != 0; ++p) {
-                        if (*p == ';') {
-                            if (cnt == 0) {
-                                cnt = 1;
-                            }
-
-                            cnt++;
-                        }
-                    }
-
-                    if (cnt > 0) {
-                        for (int id = 0; id < cnt; ++id) {
-                            send("{ \"type\": \"relayState\", \"id\": " + String(id, DEC) + ", \"value\":" + (sink->relayState(id) ? "true" : "false") + " }");
-                        }
-                        debugSerial->println("Relays state sent");
-                    }
-
-                    if (sceleton::hasLedStripe._value == "true") {
-                        send("{ \"type\": \"ledstripeState\", \"value\":\"" + encodeRGBWString(sink->getLedStripe()) + "\" }");
-                        debugSerial->println("LED stripe state sent");
-                    }
+                    // A server which syncs the state asks for it with stateSince,
+                    // the others know the relays and the LED stripe from these
+                    stateSync = false;
+                    sendLegacyState();
 
                     break;
                 }
                 case WStype_TEXT: {
                     // debugSerial->printf("[%u] get Text: %s\n", payload);
-                    DynamicJsonDocument jsonBuffer(1000);
-
-                    DeserializationError error = deserializeJson(jsonBuffer, payload);
-
-                    if (error) {
+                    if (!looksLikeJsonObject((const char*)payload, length, 10) ||
+                            deserializeJson(commandDoc, payload, length)) {
                         // debugSerial->println("parseObject() failed");
                         send("{ \"errorMsg\":\"Failed to parse JSON\" }");
                         return;
                     }
                     lastReceived = millis();
 
-                    const JsonObject &root = jsonBuffer.as<JsonObject>();
-
-                    String type = root[typeKey];
-                    if (type == "ping") {
-                        debugSerial->print(String(millis(), DEC) + ":");debugSerial->print("Ping "); debugSerial->println((const char*)(root["pingid"]));
-                        String res = "{ \"type\": \"pingresult\", \"pid\":\"";
-                        res += (const char*)(root["pingid"]);
-                        res += "\" }";
-                        send(res);
-                    } else if (type == "switch") {
-                        // debugSerial->println("switch!");
-                        bool sw = root["on"] == "true";
-                        uint32_t id = atoi(root["id"]);
-                        sink->switchRelay(id, sw);
-                        reportRelayState(id);
-                    } else if (type == "setProp") {
-                        saveSettings();
-                    #ifndef ESP01
-                    } else if (type == "show") {
-                        sink->showMessage(root["text"], root["totalMsToShow"].as<int>());
-                    } else if (type == "tune") {
-                        sink->showTuningMsg(root["text"]);
-                    } else if (type == "unixtime") {
-                        sink->setTime(root["value"].as<int>());
-                    #endif
-                    } else if (type == "ledstripe") {
-                        const char* val = (const char*)(root["value"]);
-                        sink->setLedStripe(decodeRGBWString(val));
-                    } else if (type == "playmp3") {
-                        uint32_t index = (uint32_t)(root["index"].as<int>());
-                        debugSerial->print("playmp3 ");
-                        debugSerial->println(index);
-                        sink->playMp3(index);
-                    } else if (type == "pwm") {
-                        int val = root["value"].as<int>();
-                        sink->setD0PWM(val);
-                    #ifndef ESP01
-                    } else if (type == "screenEnable") {
-                        int val = root["value"].as<boolean>();
-                        sink->enableScreen(val);
-                        saveBrightnessAt = millis() + 1000; // In 1 second, save brightness
-                    } else if (type == "brightness") {
-                        int val = root["value"].as<int>();
-                        val = std::max(std::min(val, 100), 0);
-                        sink->setBrightness(val);
-                        brightness._value = String(val, DEC);
-                        saveBrightnessAt = millis() + 1000; // In 1 second, save brightness
-                    #endif
-                    } else if (type == "additional-info") {
-                        // 
-                        sink->setAdditionalInfo(root["text"]);
-                    } else if (type == "reboot") {
-                        debugPrint("Let's reboot self");
-                        sink->reboot();
+                    const JsonObject& root = commandDoc.as<JsonObject>();
+                    const char* type = root["type"];
+                    if (type != NULL) {
+                        dispatchCommand(type, root);
                     }
                     break;
                 }
                 case WStype_BIN: {
-                    // debugSerial->printf("[%u] get binary length: %u\n", length);
-                    // hexdump(payload, length);
-                    debugPrint("Received binary packet of size " + String(length, DEC));
-
-                    // send message to client
-                    // webSocketClient.sendBIN(payload, length);
+                    binproto::Reader r(payload, length);
+                    if (!r.valid()) {
+                        send("{ \"errorMsg\":\"Failed to parse binary\" }");
+                        return;
+                    }
+                    lastReceived = millis();
+                    dispatchBinary(r);
                     break;
                 }
                 case WStype_DISCONNECTED: {
                     // debugSerial->print(String(millis(), DEC) + ":"); debugSerial->printf("Disconnected [%u]!\n", WiFi.status());
                     if (WiFi.status() == WL_CONNECTED && wasConnected) {
                         wasConnected = false;
+                        stateSync = false;
+                        sendQueue.clear();
                         debugSerial->println("Disconnected from server " + String(length, DEC));
-                        reconnectWebsocketAt = millis() + 4000; // In 4 second, let's try to reconnect
+                        reconnectWebsocketAt.arm(millis(), 4000); // In 4 second, let's try to reconnect
                     }
                     break;
                 }
@@ -508,8 +1133,7 @@ void setup(Sink* _sink) {
                 // Param is set
                 String val = request->getParam(d->_name)->value();
                 if (!d->_password || val.length() > 0) {
-                    if (d->_value != val) {
-                        d->_value = val;
+                    if (d->_value != val && d->set(val)) {
                         needReboot = true;
                     }
                 }
@@ -519,7 +1143,7 @@ void setup(Sink* _sink) {
         if (needReboot) {
             saveSettings();
             request->send(200, "text/html", "Settings changed, rebooting in 2 seconds...");  
-            rebootAt = millis() + 2000;
+            rebootAt.arm(millis(), 2000);
         } else {
             request->send(200, "text/html", "Nothing changed.");  
         }
@@ -540,7 +1164,7 @@ void setup(Sink* _sink) {
                 content += d->_name;
                 content += "' value='";
                 content += d->_password ? String("") : d->_value;
-                content += "' length=32/><br/>";
+                content += "' length=32 maxlength='" + String((unsigned)DevParam::maxLength, DEC) + "'/><br/>";
         }
         content += "<input type='submit'></form>";
         content += "<form action='/reboot'><input type='submit' value='Reboot'/></form>";
@@ -548,7 +1172,7 @@ void setup(Sink* _sink) {
         request->send(200, "text/html", content);  
     });
     setupServer->on("/reboot", [](AsyncWebServerRequest *request) {
-        rebootAt = millis() + 100;
+        rebootAt.arm(millis(), 100);
     });
     setupServer->onNotFound([](AsyncWebServerRequest *request) {
         request->send(404, "text/plain", "Not found: " + request->url());
@@ -594,11 +1218,11 @@ void setup(Sink* _sink) {
 
 int32_t lastEachSecond = millis() / 1000;
 int32_t lastWiFiState = millis();
-int32_t lastLoop = millis();
+uint32_t lastLoop = millis();
 
 int32_t oldStatus = WiFi.status();
-int32_t nextReconnect = millis();
-int32_t nextWiFiScan = millis();
+uint32_t nextReconnect = millis();
+uint32_t nextWiFiScan = millis();
 
 void loop() {
     if (millis() - lastLoop > 50) {
@@ -606,14 +1230,14 @@ void loop() {
     }
     lastLoop = millis();
 
-    if (WiFi.status() != WL_CONNECTED && (millis() > nextReconnect)) {
+    if (WiFi.status() != WL_CONNECTED && (int32_t)(millis() - nextReconnect) > 0) {
         debugSerial->println(String("WiFi.status() check: ") + WiFi.status());
         bool ret = WiFi.reconnect();
         debugSerial->println(String("Reconnect returned ") + String(ret, DEC));
         nextReconnect = millis() + (ret ? 4000 : 300);
     }
 
-    if (millis() > nextWiFiScan) {
+    if ((int32_t)(millis() - nextWiFiScan) > 0) {
         WiFi.scanNetworks(true);
 
         nextWiFiScan = millis() + 10000; // Scan every 4 seconds
@@ -635,26 +1259,26 @@ void loop() {
         if (WiFi.status() == WL_IDLE_STATUS || WiFi.status() == WL_DISCONNECTED) {
             long l = millis();
             debugSerial->println("Reconnecting");
-            reconnectWebsocketAt = 0x7FFFFFFF;
+            reconnectWebsocketAt.disarm();
             WiFi.reconnect();
         }
 
         if (WiFi.status() == WL_CONNECTED) {
             debugSerial->println(String("Connected to WiFi, IP:") + WiFi.localIP().toString());
-            reconnectWebsocketAt = millis() + 1000; // Wait 1000 ms and connect to websocket
+            reconnectWebsocketAt.arm(millis(), 1000); // Wait 1000 ms and connect to websocket
             // ArduinoOTA.begin(); // Begin OTA immediately
             initializedWiFi = true;
         }
     }
 
-    if (millis() >= reconnectWebsocketAt) {
+    if (reconnectWebsocketAt.passed(millis())) {
         if (webSocketClient.get() != NULL) {
             debugSerial->println(String("webSocketClient connecting to ") + websocketServer._value.c_str());
             webSocketClient->disconnect();
             uint32_t ms = millis();
             webSocketClient->begin(websocketServer._value.c_str(), websocketPort._value.toInt(), "/esp");
             debugSerial->println(String("webSocketClient.begin() took " + String(millis() - ms, DEC)));
-            reconnectWebsocketAt = millis() + 8000; // 8 seconds should be enough to cennect WS
+            reconnectWebsocketAt.arm(millis(), 8000); // 8 seconds should be enough to cennect WS
         }
     }
 
@@ -662,12 +1286,30 @@ void loop() {
         if (webSocketClient.get() != NULL) {
             uint32_t ms = millis();
             webSocketClient->loop();
+            drainQueue();
             if ((millis() - ms) > 50) {
                 debugSerial->println(String("webSocketClient.loop() took " + String(millis() - ms, DEC)));
             }
         }
     }
 
+    if (stateSync && state.liveVersion() > stateSentVersion) {
+        sendState(stateSentVersion);
+    }
+
+    if (queueStatsAt.passed(millis())) {
+        queueStatsAt.arm(millis(), 60000);
+        OutQueue::Stats s = sendQueue.takeStats();
+        send(message("queueStats")
+            .field("depth", sendQueue.depth())
+            .field("maxDepth", s.maxDepth)
+            .field("sent", s.sent)
+            .field("dropped", s.dropped)
+            .field("coalesced", s.coalesced)
+            .field("meanLatencyUs", s.sent > 0 ? s.latencySumUs / s.sent : 0)
+            .field("maxLatencyUs", s.maxLatencyUs));
+    }
+
 #ifndef ESP01
 /*
     if (millis() / 1000 != lastEachSecond) {
@@ -684,23 +1326,23 @@ void loop() {
     if (initializedWiFi) {
         if (millis() - lastReceived > msBeforeRestart) {
             //debugSerial->println("Rebooting...");
-            if (reportedGoingToReconnect <= lastReceived) {
+            if ((int32_t)(reportedGoingToReconnect - lastReceived) <= 0) {
                 sink->showMessage((String(msBeforeRestart / 1000, DEC) + " секунд без связи с сервером, перезагружаемся").c_str(), 3000);
                 debugSerial->println(String(msBeforeRestart / 1000, DEC) + " seconds w/o connect to server");
                 reportedGoingToReconnect = millis();
             }
 
-            rebootAt = millis();
+            rebootAt.arm(millis(), 0);
         }
 
-        if (rebootAt <= millis()) {
+        if (rebootAt.passed(millis())) {
             sink->reboot();
         }
     }
 
-    if (saveBrightnessAt < millis()) {
+    if (saveBrightnessAt.passed(millis())) {
         saveSettings();
-        saveBrightnessAt = 0x7FFFFFFF;
+        saveBrightnessAt.disarm();
     }
 /*
     if (millis() % 1000 == 0) {
@@ -713,9 +1355,6 @@ void loop() {
 
 void debugPrint(const String& str) {
     if (sceleton::webSocketClient.get() != NULL) {
-        String toSend;
-        toSend = "{ \"type\": \"log\", \"val\": \"" + str + "\" }";
-
-        sceleton::send(toSend);
+        sceleton::send(sceleton::message("log").field("val", str.c_str()));
     }
 }
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * Messages to the server wait here until the network step sends them, so the code
+ * that produces one never waits for the TCP window. At most Messages of them, in
+ * one buffer of Bytes. What a message does to the others depends on its policy:
+ * one with the LATEST policy replaces the queued message of the same key, and
+ * DROP_OLDEST ones are pushed out, the oldest first, when a message doesn't fit.
+ * KEEP messages are never dropped here: push() says there's no room, and the
+ * caller sends something to make it.
+ */
+template<size_t Bytes, int Messages>
+class SendQueue {
+public:
+    enum Policy {
+        KEEP,
+        LATEST,
+        DROP_OLDEST,
+    };
+
+    struct Stats {
+        uint32_t sent;
+        uint32_t dropped;
+        uint32_t coalesced;
+        uint32_t maxDepth;
+        uint32_t latencySumUs;
+        uint32_t maxLatencyUs;
+    };
+
+private:
+    struct Entry {
+        uint16_t offset;
+        uint16_t length;
+        uint32_t key;
+        uint32_t queuedAtUs;
+        uint8_t policy;
+        bool binary;
+    };
+
+    uint8_t _bytes[Bytes];
+    size_t _end = 0;       // Messages are appended here, in order of their entries
+    Entry _entries[Messages];
+    int _count = 0;
+    Stats _stats;
+
+    void remove(int i) {
+        memmove(_entries + i, _entries + i + 1, (_count - i - 1) * sizeof(Entry));
+        _count--;
+        if (_count == 0) {
+            _end = 0;
+        }
+    }
+
+    /**
+     * Moves the messages to the start of the buffer, over the holes the dropped ones left
+     */
+    void compact() {
+        size_t to = 0;
+        for (int i = 0; i < _count; ++i) {
+            memmove(_bytes + to, _bytes + _entries[i].offset, _entries[i].length);
+            _entries[i].offset = to;
+            to += _entries[i].length;
+        }
+        _end = to;
+    }
+
+    bool fits(size_t length) {
+        if (_count == Messages) {
+            return false;
+        }
+        if (Bytes - _end >= length) {
+            return true;
+        }
+        size_t used = 0;
+        for (int i = 0; i < _count; ++i) {
+            used += _entries[i].length;
+        }
+        if (Bytes - used < length) {
+            return false;
+        }
+        compact();
+        return true;
+    }
+
+public:
+    SendQueue() {
+        memset(&_stats, 0, sizeof(_stats));
+    }
+
+    /**
+     * Queues a copy of the message at nowUs, false if there is no room even after
+     * dropping what its policy lets drop
+     */
+    bool push(const uint8_t* data, size_t length, bool binary, uint32_t key, uint8_t policy, uint32_t nowUs) {
+        if (length > Bytes) {
+            _stats.dropped++;
+            return false;
+        }
+        if (policy == LATEST) {
+            for (int i = 0; i < _count; ++i) {
+                if (_entries[i].policy == LATEST && _entries[i].key == key) {
+                    remove(i);
+                    _stats.coalesced++;
+                    break;
+                }
+            }
+        }
+        while (!fits(length)) {
+            int oldest = 0;
+            while (oldest < _count && _entries[oldest].policy != DROP_OLDEST) {
+                oldest++;
+            }
+            if (oldest == _count) {
+                if (policy == DROP_OLDEST) {
+                    // There is nothing older of its kind, so it goes itself
+                    _stats.dropped++;
+                    return true;
+                }
+                return false;
+            }
+            remove(oldest);
+            _stats.dropped++;
+        }
+        memcpy(_bytes + _end, data, length);
+        Entry e = { (uint16_t)_end, (uint16_t)length, key, nowUs, policy, binary };
+        _entries[_count++] = e;
+        _end += length;
+        if ((uint32_t)_count > _stats.maxDepth) {
+            _stats.maxDepth = _count;
+        }
+        return true;
+    }
+
+    bool empty() const {
+        return _count == 0;
+    }
+
+    int depth() const {
+        return _count;
+    }
+
+    const uint8_t* frontData() const {
+        return _bytes + _entries[0].offset;
+    }
+
+    size_t frontLength() const {
+        return _entries[0].length;
+    }
+
+    bool frontBinary() const {
+        return _entries[0].binary;
+    }
+
+    /**
+     * The first message was sent at nowUs
+     */
+    void pop(uint32_t nowUs) {
+        uint32_t latency = nowUs - _entries[0].queuedAtUs;
+        _stats.sent++;
+        _stats.latencySumUs += latency;
+        if (latency > _stats.maxLatencyUs) {
+            _stats.maxLatencyUs = latency;
+        }
+        remove(0);
+    }
+
+    /**
+     * Drops everything, e.g. when the connection is gone
+     */
+    void clear() {
+        _stats.dropped += _count;
+        _count = 0;
+        _end = 0;
+    }
+
+    /**
+     * The stats since the last call, then starts them over
+     */
+    Stats takeStats() {
+        Stats s = _stats;
+        memset(&_stats, 0, sizeof(_stats));
+        _stats.maxDepth = _count;
+        return s;
+    }
+};
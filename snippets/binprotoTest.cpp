@@ -0,0 +1,228 @@
+#include "pseudo_arduino.h"
+#include "../binproto.h"
+#include "../jsonwriter.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace binproto;
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+uint8_t buf[300];
+char text[256];
+
+void checkIntegers() {
+    struct {
+        int32_t v;
+        size_t bytes;
+    } signedValues[] = {
+        { 0, 1 }, { -1, 1 }, { 127, 1 }, { -128, 1 }, { 128, 2 }, { -129, 2 }, { 32767, 2 }, { -32769, 3 },
+        { 8388607, 3 }, { 8388608, 4 }, { INT32_MAX, 4 }, { INT32_MIN, 4 },
+    };
+    for (auto& c : signedValues) {
+        Writer w(buf, sizeof(buf));
+        w.begin(BRIGHTNESS).field(VALUE, c.v);
+        Reader r(w.data(), w.length());
+        CHECK(r.valid() && r.i32(VALUE) == c.v, "%d read as %d", c.v, r.i32(VALUE));
+        CHECK(w.length() == 4 + c.bytes, "%d takes %u bytes", c.v, (unsigned)w.length() - 4);
+    }
+    struct {
+        uint32_t v;
+        size_t bytes;
+    } unsignedValues[] = {
+        { 0, 1 }, { 255, 1 }, { 256, 2 }, { 65535, 2 }, { 65536, 3 }, { 1772355600u, 4 }, { UINT32_MAX, 4 },
+    };
+    for (auto& c : unsignedValues) {
+        Writer w(buf, sizeof(buf));
+        w.begin(UNIXTIME).field(VALUE, c.v);
+        Reader r(w.data(), w.length());
+        CHECK(r.valid() && r.u32(VALUE) == c.v, "%u read as %u", c.v, r.u32(VALUE));
+        CHECK(w.length() == 4 + c.bytes, "%u takes %u bytes", c.v, (unsigned)w.length() - 4);
+    }
+    CHECK(hundredths(21.5f) == 2150 && hundredths(-0.125f) == -13 && hundredths(101325.37f) == 10132537,
+        "hundredths %d %d %d", hundredths(21.5f), hundredths(-0.125f), hundredths(101325.37f));
+}
+
+void checkRoundTrip() {
+    Writer w(buf, sizeof(buf));
+    w.begin(SHOW).field(TEXT, "Позвонить маме").field(DURATION_MS, 3000);
+    Reader show(w.data(), w.length());
+    CHECK(show.valid() && show.kind() == SHOW, "show");
+    CHECK(std::string(show.text(TEXT, text, sizeof(text))) == "Позвонить маме" && show.i32(DURATION_MS) == 3000,
+        "show %s %d", text, show.i32(DURATION_MS));
+    CHECK(!show.has(ID) && show.u32(ID, 7) == 7 && show.i32(MS, -1) == -1, "defaults for what is missing");
+
+    const uint8_t colors[] = { 0xff, 0, 0, 0, 0, 0xff, 0, 0 };
+    w.begin(LEDSTRIPE).field(COLORS, colors, sizeof(colors));
+    Reader stripe(w.data(), w.length());
+    size_t length;
+    const uint8_t* p = stripe.bytes(COLORS, length);
+    CHECK(stripe.valid() && length == sizeof(colors) && memcmp(p, colors, length) == 0, "ledstripe");
+
+    // The 64 RGBW LEDs of a whole stripe are 256 bytes, more than a field
+    uint8_t whole[64 * 4];
+    for (size_t i = 0; i < sizeof(whole); ++i) {
+        whole[i] = (uint8_t)(i * 7);
+    }
+    w.begin(LEDSTRIPE).fields(COLORS, whole, sizeof(whole));
+    Reader full(w.data(), w.length());
+    std::string joined;
+    int repeats = 0;
+    size_t from = 0;
+    while ((p = full.next(COLORS, length, from)) != NULL) {
+        joined.append((const char*)p, length);
+        repeats++;
+    }
+    CHECK(!w.overflowed() && full.valid() && repeats == 2 && joined == std::string((const char*)whole, sizeof(whole)),
+        "a whole stripe in %d fields of %u bytes", repeats, (unsigned)joined.size());
+    CHECK(w.begin(LEDSTRIPE).field(COLORS, whole, sizeof(whole)).overflowed(), "one field can't hold it");
+
+    w.begin(SWITCH).field(ID, 2u).field(ON, true);
+    Reader sw(w.data(), w.length());
+    CHECK(sw.valid() && sw.kind() == SWITCH && sw.u32(ID) == 2 && sw.u32(ON) == 1, "switch");
+
+    w.begin(IR_KEY).field(REMOTE, "encoder_left").field(KEY, "rotate_cw").field(TIMESEQ, 4000000000u);
+    Reader key(w.data(), w.length());
+    CHECK(key.valid() && std::string(key.text(REMOTE, text, sizeof(text))) == "encoder_left" &&
+        std::string(key.text(KEY, text, sizeof(text))) == "rotate_cw" && key.u32(TIMESEQ) == 4000000000u, "ir_key");
+
+    char small[5];
+    CHECK(std::string(key.text(REMOTE, small, sizeof(small))) == "enco", "text cut to the buffer");
+
+    // Repeated fields one by one
+    uint8_t inner[16];
+    Writer one(inner, sizeof(inner));
+    one.begin(PWM).field(VALUE, 7u);
+    w.begin(BATCH).field(REQUEST_ID, 5u).field(COMMAND, one.data(), one.length()).field(COMMAND, (const uint8_t*)"", 0).field(COMMAND, one.data(), one.length());
+    Reader batch(w.data(), w.length());
+    size_t at = 0;
+    std::vector<size_t> lengths;
+    while ((p = batch.next(COMMAND, length, at)) != NULL) {
+        lengths.push_back(length);
+    }
+    CHECK(batch.valid() && lengths == std::vector<size_t>({ one.length(), 0, one.length() }) && batch.next(COMMAND, length, at) == NULL, "%u commands", (unsigned)lengths.size());
+    at = 0;
+    CHECK(batch.next(REQUEST_ID, length, at) != NULL && batch.next(REQUEST_ID, length, at) == NULL, "a field once");
+
+    // A tag from a later version is skipped over
+    const uint8_t later[] = { version, PWM, 0x7f, 3, 1, 2, 3, VALUE, 1, 200 };
+    Reader pwm(later, sizeof(later));
+    CHECK(pwm.valid() && pwm.u32(VALUE) == 200, "unknown tag skipped");
+
+    for (int kind = SWITCH; kind <= TELEMETRY; ++kind) {
+        CHECK((kind > BATCH && kind < TEMP) == (kindName(kind) == NULL), "name of kind %d", kind);
+    }
+}
+
+void checkMalformed() {
+    struct {
+        std::vector<uint8_t> frame;
+        const char* what;
+    } cases[] = {
+        { {}, "empty" },
+        { { version }, "no kind" },
+        { { 2, SHOW }, "another version" },
+        { { version, SHOW, TEXT }, "tag without length" },
+        { { version, SHOW, TEXT, 3, 'a', 'b' }, "field past the end" },
+        { { version, PWM, VALUE, 1, 5, VALUE }, "a byte after the fields" },
+    };
+    for (auto& c : cases) {
+        Reader r(c.frame.data(), c.frame.size());
+        CHECK(!r.valid() && r.kind() == 0 && !r.has(VALUE), "%s is broken", c.what);
+    }
+    const uint8_t emptyShow[] = { version, SHOW };
+    CHECK(Reader(emptyShow, sizeof(emptyShow)).valid(), "no fields is fine");
+
+    uint8_t tiny[6];
+    Writer w(tiny, sizeof(tiny));
+    w.begin(SHOW).field(TEXT, "long text");
+    CHECK(w.overflowed() && w.length() == sizeof(tiny), "overflow noticed");
+    std::string tooLong(256, 'x');
+    w = Writer(buf, sizeof(buf));
+    w.begin(SHOW).field(TEXT, tooLong.c_str());
+    CHECK(w.overflowed(), "a field over 255 bytes");
+}
+
+/**
+ * The messages as JSON and binary: bytes each and host time to write and read back
+ */
+void bench() {
+    char json[300];
+    struct Message {
+        const char* type;
+        void (*writeJson)(JsonWriter& w);
+        void (*writeBinary)(Writer& w);
+    } messages[] = {
+        { "show",
+            [](JsonWriter& w) { w.beginObject().field("type", "show").field("text", "Позвонить маме").field("totalMsToShow", 3000).endObject(); },
+            [](Writer& w) { w.begin(SHOW).field(TEXT, "Позвонить маме").field(DURATION_MS, 3000); } },
+        { "ledstripe",
+            [](JsonWriter& w) { w.beginObject().field("type", "ledstripe").field("value", "FF00000000FF000000000FF0FFFFFFFF").endObject(); },
+            [](Writer& w) {
+                const uint8_t colors[] = { 0xff, 0, 0, 0, 0, 0xff, 0, 0, 0, 0, 0x0f, 0xf0, 0xff, 0xff, 0xff, 0xff };
+                w.begin(LEDSTRIPE).field(COLORS, colors, sizeof(colors));
+            } },
+        { "switch",
+            [](JsonWriter& w) { w.beginObject().field("type", "switch").field("id", "0").field("on", "true").endObject(); },
+            [](Writer& w) { w.begin(SWITCH).field(ID, 0u).field(ON, true); } },
+        { "unixtime",
+            [](JsonWriter& w) { w.beginObject().field("type", "unixtime").field("value", 1772355600).field("ms", 123).field("id", 42).endObject(); },
+            [](Writer& w) { w.begin(UNIXTIME).field(VALUE, 1772355600u).field(MS, 123).field(REQUEST_ID, 42); } },
+        { "temp",
+            [](JsonWriter& w) { w.beginObject().field("type", "temp").field("value", 21.5f).field("timeseq", 123456789u).endObject(); },
+            [](Writer& w) { w.begin(TEMP).field(VALUE, hundredths(21.5f)).field(TIMESEQ, 123456789u); } },
+        { "pressure",
+            [](JsonWriter& w) { w.beginObject().field("type", "pressure").field("value", 101325.37f).field("timeseq", 123456789u).endObject(); },
+            [](Writer& w) { w.begin(PRESSURE).field(VALUE, hundredths(101325.37f)).field(TIMESEQ, 123456789u); } },
+        { "ir_key",
+            [](JsonWriter& w) { w.beginObject().field("type", "ir_key").field("remote", "encoder_left").field("key", "rotate_cw").field("timeseq", 123456789u).endObject(); },
+            [](Writer& w) { w.begin(IR_KEY).field(REMOTE, "encoder_left").field(KEY, "rotate_cw").field(TIMESEQ, 123456789u); } },
+    };
+    const int n = 200000;
+    for (const Message& m : messages) {
+        uint64_t jsonUs = UINT64_MAX;
+        uint64_t binaryUs = UINT64_MAX;
+        size_t jsonBytes = 0;
+        size_t binaryBytes = 0;
+        uint32_t sum = 0;
+        for (int attempt = 0; attempt < 5; ++attempt) {
+            uint64_t t0 = micros64();
+            for (int i = 0; i < n; ++i) {
+                JsonWriter w(json, sizeof(json));
+                m.writeJson(w);
+                jsonBytes = w.length();
+                sum += w.c_str()[i % jsonBytes];
+            }
+            uint64_t t1 = micros64();
+            for (int i = 0; i < n; ++i) {
+                Writer w(buf, sizeof(buf));
+                m.writeBinary(w);
+                binaryBytes = w.length();
+                Reader r(w.data(), w.length());
+                sum += r.kind() + r.u32(VALUE);
+            }
+            uint64_t t2 = micros64();
+            jsonUs = std::min(jsonUs, t1 - t0);
+            binaryUs = std::min(binaryUs, t2 - t1);
+        }
+        printf("%-10s JSON %3u bytes, %6.1f ns to write; binary %3u bytes, %6.1f ns to write and read (%u)\n", m.type,
+            (unsigned)jsonBytes, jsonUs * 1000.0 / n, (unsigned)binaryBytes, binaryUs * 1000.0 / n, sum & 0xff);
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    checkIntegers();
+    checkRoundTrip();
+    checkMalformed();
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("Binary frames read back as written, broken ones are refused\n");
+    bench();
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "pseudo_arduino.h"
+
+#include "../lcd.h"
+#include "recordingtransport.h"
+
+RecordingTransport transport(false);
+
+/**
+ * Reference: what chip `chip` shows at `line`, pixel by pixel through get()
+ */
+uint8_t referenceLine(LcdScreen& screen, MAX72xx::Orientation orientation, bool mirrored, 
+        MAX72xx::ChainOrder chainOrder, int chip, int line) {
+    int w = screen.width();
+    int h = screen.height();
+    int cols = screen.modulesWide();
+    int mx = chip % cols;
+    int my = chip / cols;
+    bool turned = chainOrder == MAX72xx::CHAIN_SNAKE && my % 2 == 1;
+    if (turned) {
+        mx = cols - 1 - mx;
+    }
+    uint8_t res = 0;
+    for (int k = 0; k < 8; ++k) {
+        // Pixel of the module as if it was mounted like the rest of the panel
+        int kk = turned ? 7 - k : k;
+        int ll = turned ? 7 - line : line;
+        int x = 0;
+        int y = 0;
+        switch (orientation) {
+            case MAX72xx::ROTATE_0:   x = mx * 8 + kk;             y = my * 8 + ll;             break;
+            case MAX72xx::ROTATE_90:  x = mx * 8 + ll;             y = my * 8 + 7 - kk;         break;
+            case MAX72xx::ROTATE_180: x = w - 1 - (mx * 8 + kk);   y = h - 1 - (my * 8 + ll);   break;
+            case MAX72xx::ROTATE_270: x = mx * 8 + 7 - ll;         y = my * 8 + kk;             break;
+        }
+        if (mirrored) {
+            x = w - 1 - x;
+        }
+        res |= (screen.get(x, y) ? 1 : 0) << k;
+    }
+    return res;
+}
+
+/**
+ * What refreshAll did before: copy the screen pixel by pixel, rotated on 180
+ */
+void legacyLines(LcdScreen& screen, uint8_t* out) {
+    LcdScreen screen2;
+    int w = screen.width();
+    int h = screen.height();
+    for (int x = 0; x < w; ++x) {
+        for (int y = 0; y < h; ++y) {
+            screen2.set(w - (x + 1), h - (y + 1), screen.get(x, y));
+        }
+    }
+    for (int i = 0; i < NUM_MAX * 8; ++i) {
+        out[i] = screen2.line8(i);
+    }
+}
+
+const MAX72xx::Orientation orientations[] = {
+    MAX72xx::ROTATE_0, MAX72xx::ROTATE_90, MAX72xx::ROTATE_180, MAX72xx::ROTATE_270
+};
+const char* names[] = { "0", "90", "180", "270" };
+
+/**
+ * Every orientation, mirroring and chain order of a panel against referenceLine
+ */
+int checkGeometry(int modulesWide, int modulesHigh, int rounds) {
+    LcdScreen screen(modulesWide, modulesHigh);
+    int chain = modulesWide * modulesHigh;
+    uint8_t* frame = new uint8_t[chain * 8];
+    int failures = 0;
+    for (int round = 0; round < rounds; ++round) {
+        screen.clear();
+        for (int i = 0; i < 25 * chain; ++i) {
+            screen.set(rand() % screen.width(), rand() % screen.height(), true);
+        }
+        for (int o = 0; o < 4; ++o) {
+            for (int m = 0; m < 2; ++m) {
+                for (int c = 0; c < 2; ++c) {
+                    MAX72xx::ChainOrder order = c == 0 ? MAX72xx::CHAIN_ROWS : MAX72xx::CHAIN_SNAKE;
+                    MAX72xx controller(screen, transport, orientations[o], m == 1, order);
+                    controller.composeLines(frame);
+                    for (int chip = 0; chip < chain; ++chip) {
+                        for (int line = 0; line < 8; ++line) {
+                            uint8_t expected = referenceLine(screen, orientations[o], m == 1, order, chip, line);
+                            if (frame[chip * 8 + line] != expected && failures++ < 10) {
+                                printf("FAIL %dx%d rotate %s%s%s chip %d line %d: %02x != %02x\n",
+                                    modulesWide, modulesHigh, names[o], m ? " mirrored" : "", c ? " snake" : "", 
+                                    chip, line, frame[chip * 8 + line], expected);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    delete[] frame;
+    return failures;
+}
+
+int main(int argc, char const *argv[]) {
+    srand(1);
+    LcdScreen screen;
+    int failures = 0;
+    for (int round = 0; round < 2000; ++round) {
+        screen.clear();
+        for (int i = 0; i < 100; ++i) {
+            screen.set(rand() % screen.width(), rand() % screen.height(), true);
+        }
+        uint8_t legacy[NUM_MAX * 8];
+        uint8_t rotated[NUM_MAX * 8];
+        legacyLines(screen, legacy);
+        MAX72xx(screen, transport, MAX72xx::ROTATE_180).composeLines(rotated);
+        if (memcmp(legacy, rotated, sizeof(legacy)) != 0 && failures++ < 10) {
+            printf("FAIL rotate 180 differs from the old refreshAll copy\n");
+        }
+    }
+    const int geometries[][2] = { {4, 1}, {1, 1}, {8, 1}, {16, 1}, {4, 2}, {8, 2}, {3, 3} };
+    for (const int* g : geometries) {
+        failures += checkGeometry(g[0], g[1], 200);
+    }
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("All orientations and chain orders match the per-pixel reference\n");
+
+    // Benchmark against the old per-frame screen copy
+    const int rounds = 100000;
+    uint8_t frame[NUM_MAX * 8];
+    uint32_t sum = 0;
+    MAX72xx controller(screen, transport, MAX72xx::ROTATE_180);
+
+    uint64_t t0 = micros64();
+    for (int r = 0; r < rounds; ++r) {
+        screen.set(r % screen.width(), r % 8, r & 1);
+        legacyLines(screen, frame);
+        sum += frame[r % sizeof(frame)];
+    }
+    uint64_t t1 = micros64();
+    for (int r = 0; r < rounds; ++r) {
+        screen.set(r % screen.width(), r % 8, r & 1);
+        controller.composeLines(frame);
+        sum += frame[r % sizeof(frame)];
+    }
+    uint64_t t2 = micros64();
+
+    printf("per-pixel copy: %8.3f us/frame\n", (double)(t1 - t0) / rounds);
+    printf("SWAR kernel:    %8.3f us/frame\n", (double)(t2 - t1) / rounds);
+    printf("(checksum %u)\n", sum);
+    return 0;
+}
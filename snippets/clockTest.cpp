@@ -0,0 +1,189 @@
+#include "pseudo_arduino.h"
+#include "../deviceclock.h"
+
+#include <algorithm>
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+const int64_t unixStartUs = 1700000000ll * 1000000;
+
+/**
+ * A device whose oscillator is off by ppm, talking to a server with a one way delay
+ * of delayUs plus an exponential jitter. micros() starts 5 s before its wrap.
+ */
+struct Scenario {
+    const char* name;
+    double ppm;
+    int64_t delayUs;
+    int64_t jitterUs;
+    double maxErrorMs;   // Allowed after the first hour, one sample is off by half the path asymmetry
+};
+
+struct Result {
+    int64_t maxErrorUs;
+    double rmsErrorUs;
+    int samples;
+    int steps;
+    int64_t backwardsUs;
+    int64_t jumpUs;      // The most unixUs() moved by a sample, other than a step
+};
+
+const uint64_t local0 = (1ull << 32) - 5000000;
+
+uint64_t localAt(const Scenario& s, int64_t t) {
+    return local0 + t + (int64_t)(t * s.ppm / 1e6);
+}
+
+int64_t oneWay(const Scenario& s) {
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return s.delayUs + (int64_t)(-log(u) * s.jitterUs);
+}
+
+const int64_t simulatedUs = 3ll * 86400 * 1000000;
+const int64_t stepUs = 100000;
+
+Result runClock(const Scenario& s, DeviceClock& clock) {
+    Result r = { 0, 0, 0, 0, 0, 0 };
+    double sumSq = 0;
+    int checked = 0;
+    int64_t nextPoll = 0;
+    int64_t answerAt = -1;
+    int64_t serverUs = 0;
+    uint64_t sentUs = 0;
+    int64_t lastShown = INT64_MIN;
+    for (int64_t t = 0; t < simulatedUs; t += stepUs) {
+        if (answerAt >= 0 && t >= answerAt) {
+            pseudoMicros = localAt(s, answerAt);
+            bool wasSynced = clock.synced();
+            int64_t before = clock.unixUs();
+            clock.sample(serverUs, sentUs, clock.monotonicUs());
+            if (wasSynced && clock.steps() == (uint32_t)r.steps) {
+                r.jumpUs = std::max(r.jumpUs, (int64_t)llabs(clock.unixUs() - before));
+            }
+            r.samples++;
+            answerAt = -1;
+            nextPoll = t + clock.pollIntervalS() * 1000000ll;
+        }
+        pseudoMicros = localAt(s, t);
+        if (t >= nextPoll && answerAt < 0) {
+            sentUs = clock.monotonicUs();
+            int64_t there = oneWay(s);
+            serverUs = (unixStartUs + t + there) / 1000 * 1000; // Milliseconds in the answer
+            answerAt = t + there + oneWay(s);
+        }
+        if (!clock.synced()) {
+            continue;
+        }
+        int64_t shown = clock.unixUs();
+        if (shown < lastShown && clock.steps() == (uint32_t)r.steps) {
+            r.backwardsUs = std::max(r.backwardsUs, lastShown - shown);
+        }
+        r.steps = clock.steps();
+        lastShown = shown;
+        if (t >= 3600ll * 1000000) {
+            int64_t error = shown - (unixStartUs + t);
+            r.maxErrorUs = std::max(r.maxErrorUs, (int64_t)llabs(error));
+            sumSq += (double)error * error;
+            checked++;
+        }
+    }
+    r.rmsErrorUs = sqrt(sumSq / checked);
+    pseudoMicros = -1;
+    return r;
+}
+
+/**
+ * What the sketch did before: whole seconds pushed hourly, millis() since then
+ */
+Result runLegacy(const Scenario& s) {
+    Result r = { 0, 0, 0, 0, 0, 0 };
+    double sumSq = 0;
+    int checked = 0;
+    uint32_t initialUnixTime = 0;
+    uint32_t timeRetreivedInMs = 0;
+    for (int64_t t = 0; t < simulatedUs; t += stepUs) {
+        uint32_t millisNow = (uint32_t)(localAt(s, t) / 1000);
+        if (t % (3600ll * 1000000) == 0) {
+            initialUnixTime = (unixStartUs + t - oneWay(s)) / 1000000;
+            timeRetreivedInMs = millisNow;
+            r.samples++;
+        }
+        if (t >= 3600ll * 1000000) {
+            int64_t shown = (initialUnixTime * 1000ll + (uint32_t)(millisNow - timeRetreivedInMs)) * 1000;
+            int64_t error = shown - (unixStartUs + t);
+            r.maxErrorUs = std::max(r.maxErrorUs, (int64_t)llabs(error));
+            sumSq += (double)error * error;
+            checked++;
+        }
+    }
+    r.rmsErrorUs = sqrt(sumSq / checked);
+    return r;
+}
+
+void checkScenario(const Scenario& s) {
+    srand(1);
+    DeviceClock clock;
+    Result r = runClock(s, clock);
+    Result legacy = runLegacy(s);
+    double trueSkewPpb = (1.0 / (1.0 + s.ppm / 1e6) - 1.0) * 1e9;
+    printf("%-26s skew %+8.0f ppb (true %+8.0f), %3d samples, poll %4u s, offset %+6lld us, jitter %5u us; "
+        "error max %7.2f ms, rms %6.2f ms; legacy hourly: max %7.2f ms, rms %6.2f ms\n",
+        s.name, (double)clock.skewPpb(), trueSkewPpb, r.samples, clock.pollIntervalS(),
+        (long long)clock.offsetUs(), clock.jitterUs(),
+        r.maxErrorUs / 1000.0, r.rmsErrorUs / 1000.0, legacy.maxErrorUs / 1000.0, legacy.rmsErrorUs / 1000.0);
+    CHECK(r.maxErrorUs <= s.maxErrorMs * 1000, "%s: error %.2f ms", s.name, r.maxErrorUs / 1000.0);
+    CHECK(r.backwardsUs == 0, "%s: went back by %lld us without a step", s.name, (long long)r.backwardsUs);
+    CHECK(r.jumpUs == 0, "%s: a sample moved the clock by %lld us", s.name, (long long)r.jumpUs);
+    CHECK(r.steps == 0, "%s: %d steps", s.name, r.steps);
+}
+
+void checkWrap() {
+    DeviceClock clock;
+    pseudoMicros = 0xFFFFFF00ll;
+    uint64_t before = clock.monotonicUs();
+    pseudoMicros += 0x200;
+    uint64_t after = clock.monotonicUs();
+    CHECK(after == before + 0x200 && after > 0xFFFFFFFFull, "micros() wrap: %llx -> %llx",
+        (unsigned long long)before, (unsigned long long)after);
+    pseudoMicros = -1;
+}
+
+void checkStep() {
+    DeviceClock clock;
+    pseudoMicros = 1000000;
+    CHECK(clock.sample(unixStartUs, 1000000, 1000000), "first sample");
+    CHECK(llabs(clock.unixUs() - unixStartUs) < 1000, "set by the first sample");
+    pseudoMicros = 2000000;
+    // The server moved by 10 s: stepped, not slewed
+    CHECK(!clock.sample(unixStartUs + 11000000, 1990000, 2000000) && clock.spikes() == 1, "one sample is a spike");
+    CHECK(clock.sample(unixStartUs + 11000000, 1990000, 2000000) && clock.steps() == 1, "step");
+    CHECK(llabs(clock.unixUs() - (unixStartUs + 11005000)) < 1000, "stepped to the server");
+    // A whole second push which agrees with the clock changes nothing
+    pseudoMicros = 3000000;
+    CHECK(!clock.sample((unixStartUs + 12005000) / 1000000 * 1000000, 3000000, 3000000, 1000000), "coarse push");
+    pseudoMicros = -1;
+}
+
+int main(int argc, char const *argv[]) {
+    checkWrap();
+    checkStep();
+    const Scenario scenarios[] = {
+        { "LAN, +37 ppm", 37, 1000, 500, 5 },
+        { "LAN, -12 ppm", -12, 1000, 500, 5 },
+        { "LAN, +150 ppm", 150, 1000, 500, 5 },
+        { "WAN, +37 ppm", 37, 20000, 5000, 30 },
+        { "WAN with bursts, -25 ppm", -25, 30000, 40000, 100 },
+        { "Exact oscillator", 0, 1000, 500, 5 },
+    };
+    for (const Scenario& s : scenarios) {
+        checkScenario(s);
+    }
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("The clock follows the server through skew and jitter\n");
+    return 0;
+}
@@ -1,31 +1,186 @@
 #include "pseudo_arduino.h"
 #include "../dateutil.h"
 
-int main(int argc, char const *argv[]) {   
-    const char* weekd[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+#include <string.h>
 
-    for (int i = 10000; i <= 37000; i+=1) {
-        std::time_t seconds = i * 24l * 60l * 60l;
-        std::time_t t = seconds;
+/**
+ * The year and month loops epoc2rtc used before the civilFromDays rewrite, kept to compare against
+ */
+namespace legacy {
+    const uint8_t leapYearMonth[] = {
+        31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+    };
+    const uint8_t regularYearMonth[] = {
+        31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+    };
+    const int cycle400year = 365*400 + (100 - 3);
+    const int cycle100year = 365*100 + 25 - 1;
+    const int cycle4year = 365*4 + 1;
+
+    static void epoc2rtc(uint32_t t, date::RTC &rtc) {
+        rtc.dow = (t + 3) % 7; // Day of week
+        rtc.dayOfCycle = (((t + 719162 - 365) % cycle400year) % cycle100year) % cycle4year;
+        rtc.year = 1970 +
+            t / cycle400year * 400 +
+            t / cycle100year * 100 +
+            t / cycle4year * 4;
+
+        for (;;) {
+            int days = 365;
+            if (rtc.year % 400 == 0 || (rtc.year % 100 != 0 && rtc.year % 4 == 0)) {
+                days++; // Leap year
+            }
+            if (rtc.dayOfCycle >= days) {
+                rtc.dayOfCycle -= days;
+                rtc.year++;
+                rtc.leapYear = rtc.year % 400 == 0 || (rtc.year % 100 != 0 && rtc.year % 4 == 0);
+            } else {
+                break;
+            }
+        }
+
+        const uint8_t* dm = rtc.leapYear ? leapYearMonth : regularYearMonth;
+        rtc.doy = rtc.dayOfCycle;
+        rtc.month = 0;
+        int d = rtc.doy;
+        for (;d >= dm[rtc.month];) {
+            d -= dm[rtc.month];
+            rtc.month++;
+        }
+        rtc.day = d;
+    }
+}
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+/**
+ * Every day from 1600 to 2400 against glibc: the date, day of week and year,
+ * ISO week (strftime %G/%V) and the way back with daysFromCivil
+ */
+void checkCivil() {
+    const int32_t from = date::daysFromCivil(1600, 1, 1);
+    const int32_t to = date::daysFromCivil(2400, 12, 31);
+    CHECK(from == -135140 && to == 157419, "range %d..%d", from, to);
+    for (int32_t z = from; z <= to; ++z) {
+        std::time_t t = (std::time_t)z * 24 * 60 * 60;
+        std::tm tt;
+        gmtime_r(&t, &tt);
+
+        int32_t y;
+        uint32_t m, d;
+        date::civilFromDays(z, y, m, d);
+        CHECK(y == tt.tm_year + 1900 && (int)m == tt.tm_mon + 1 && (int)d == tt.tm_mday,
+            "day %d is %d-%02d-%02d, glibc says %d-%02d-%02d", z, y, m, d, tt.tm_year + 1900, tt.tm_mon + 1, tt.tm_mday);
+        CHECK(date::daysFromCivil(y, m, d) == z, "day %d does not come back from %d-%02d-%02d", z, y, m, d);
+        CHECK((int)date::weekday(z) == (tt.tm_wday + 6) % 7, "day %d weekday %d", z, date::weekday(z));
+
+        int32_t isoYear;
+        uint32_t week;
+        date::isoWeek(z, isoYear, week);
+        char ref[16];
+        char mine[16];
+        strftime(ref, sizeof(ref), "%G-W%V", &tt);
+        snprintf(mine, sizeof(mine), "%d-W%02u", isoYear, week);
+        CHECK(strcmp(ref, mine) == 0, "day %d ISO week %s, glibc says %s", z, mine, ref);
+
+        if (z >= 0) {
+            date::RTC rtc;
+            date::epoc2rtc(z, rtc);
+            CHECK(rtc.year == y && rtc.month == m - 1 && rtc.day == d - 1 && rtc.doy == tt.tm_yday && rtc.dayOfCycle == rtc.doy &&
+                rtc.dow == date::weekday(z) && rtc.leapYear == date::isLeapYear(y) &&
+                rtc.isoYear == isoYear && rtc.isoWeek == week,
+                "epoc2rtc of day %d", z);
+        }
+    }
+    printf("civilFromDays, daysFromCivil and isoWeek match glibc for %d days of 1600..2400\n", to - from + 1);
+}
+
+/**
+ * The legacy loops lost a year on some December 31sts and were a century off after 2069,
+ * count the days the new code fixes
+ */
+void checkLegacy() {
+    int fixed = 0;
+    uint32_t first = 0;
+    for (uint32_t z = 0; z <= 73000; ++z) {
+        date::RTC was = {0};
+        date::RTC now = {0};
+        legacy::epoc2rtc(z, was);
+        date::epoc2rtc(z, now);
+        if (was.year != now.year || was.month != now.month || was.day != now.day || was.dow != now.dow || was.doy != now.doy) {
+            first = fixed++ == 0 ? z : first;
+        }
+    }
+    printf("Legacy epoc2rtc was wrong for %d of the days 1970..2169, the first is day %u\n", fixed, first);
+}
+
+void checkCache() {
+    date::DayCache cache;
+    for (uint32_t z = 17000; z < 17400; z += 7) {
         date::RTC rtc;
-        date::epoc2rtc(i, rtc);
-        std::tm* tt = std::gmtime(&t);
-
-        if (tt->tm_year != (rtc.year - 1900) ||
-            tt->tm_mon != rtc.month ||
-            tt->tm_mday != (rtc.day + 1) ||
-            tt->tm_wday != ((rtc.dow + 1) % 7)  ||
-            tt->tm_yday != rtc.doy) {
-            
-            printf("%d ::: %d%s %s %d %d (%d %d) -> %s \n", i, 
-                rtc.year, rtc.leapYear ? "(leap)" : "", 
-                weekd[rtc.dow],
-                (rtc.day + 1),
-                rtc.month, 
-                rtc.doy,
-                rtc.dayOfCycle,
-                std::asctime(tt));
+        date::epoc2rtc(z, rtc);
+        const date::RTC& cached = cache.get(z);
+        CHECK(cached.year == rtc.year && cached.month == rtc.month && cached.day == rtc.day, "cache of day %u", z);
+        CHECK(&cache.get(z) == &cached && cache.get(z).day == rtc.day, "cache of day %u, second time", z);
+    }
+}
+
+void bench() {
+    // A typical range of clock dates
+    const uint32_t from = 17000;
+    const uint32_t days = 20000;
+    const int rounds = 20;
+    uint32_t sum = 0;
+
+    // Best of 5, the host is noisy
+    uint64_t legacyUs = UINT64_MAX;
+    uint64_t newUs = UINT64_MAX;
+    uint64_t cachedUs = UINT64_MAX;
+    for (int attempt = 0; attempt < 5; ++attempt) {
+        date::RTC rtc = {0};
+        uint64_t t0 = micros64();
+        for (int r = 0; r < rounds; ++r) {
+            for (uint32_t z = from; z < from + days; ++z) {
+                legacy::epoc2rtc(z, rtc);
+                sum += rtc.day + rtc.month;
+            }
         }
+        uint64_t t1 = micros64();
+        for (int r = 0; r < rounds; ++r) {
+            for (uint32_t z = from; z < from + days; ++z) {
+                date::epoc2rtc(z, rtc);
+                sum += rtc.day + rtc.month;
+            }
+        }
+        uint64_t t2 = micros64();
+        // What showTime does: the same day asked every frame
+        date::DayCache cache;
+        for (int r = 0; r < rounds; ++r) {
+            for (uint32_t z = 0; z < days; ++z) {
+                const date::RTC& c = cache.get(from + z / 4096);
+                sum += c.day + c.month;
+            }
+        }
+        uint64_t t3 = micros64();
+        legacyUs = std::min(legacyUs, t1 - t0);
+        newUs = std::min(newUs, t2 - t1);
+        cachedUs = std::min(cachedUs, t3 - t2);
     }
+    double calls = (double)days * rounds;
+    printf("ns per call: legacy epoc2rtc %.1f, epoc2rtc %.1f, DayCache::get %.1f (%u)\n",
+        legacyUs * 1000.0 / calls, newUs * 1000.0 / calls, cachedUs * 1000.0 / calls, sum);
+}
 
-}
\ No newline at end of file
+int main(int argc, char const *argv[]) {
+    checkCivil();
+    checkLegacy();
+    checkCache();
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    bench();
+    return 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+/**
+ * A sensor which answers if emulator::bme280.present, with fixed readings
+ */
+
+#include "Adafruit_Sensor.h"
+#include "Wire.h"
+
+namespace emulator {
+    struct Bme280 {
+        bool present = false;
+        float temperature = 22.5;
+        float humidity = 40;
+        float pressure = 101325;
+    };
+
+    Bme280 bme280;
+}
+
+class Adafruit_BME280 {
+public:
+    bool begin(uint8_t address) { return emulator::bme280.present; }
+    float readTemperature() { return emulator::bme280.temperature; }
+    float readHumidity() { return emulator::bme280.humidity; }
+    float readPressure() { return emulator::bme280.pressure; }
+};
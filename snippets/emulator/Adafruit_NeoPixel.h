@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Arduino.h"
+
+#define NEO_GRBW ((3 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+    std::vector<uint32_t> _pixels;
+
+public:
+    uint32_t shows = 0;
+
+    Adafruit_NeoPixel(uint16_t n, uint8_t pin, uint16_t type) : _pixels(n, 0) {}
+
+    void begin() {}
+
+    void show() {
+        shows++;
+    }
+
+    void setPixelColor(uint16_t n, uint32_t c) {
+        if (n < _pixels.size()) {
+            _pixels[n] = c;
+        }
+    }
+
+    uint32_t getPixelColor(uint16_t n) const {
+        return n < _pixels.size() ? _pixels[n] : 0;
+    }
+
+    uint16_t numPixels() const {
+        return _pixels.size();
+    }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+        return ((uint32_t)w << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+};
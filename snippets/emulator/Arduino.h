@@ -0,0 +1,299 @@
+#pragma once
+/**
+ * Host stand-in for the ESP8266 Arduino core, enough to build the whole sketch.
+ * Time is virtual: micros() and millis() read emulator::nowUs, which only the
+ * harness and delay() move, so runs are exact and repeatable.
+ * Everything in emulator/ is meant for a single translation unit, as a sketch is.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "WString.h"
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x00
+#define INPUT_PULLUP 0x02
+#define OUTPUT 0x01
+
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+static const uint8_t A0 = 17;
+
+namespace emulator {
+    /** Virtual time since power on */
+    uint64_t nowUs = 0;
+
+    /** What the pins were set to, and what digitalRead() and analogRead() give */
+    int pinLevels[32] = { 0 };
+    int analogLevel = 0;
+
+    /** Bytes written to the hardware serial port, and whether they go to stdout too */
+    uint64_t serialBytes = 0;
+    bool echoSerial = false;
+
+    /** ESP.reset() and ESP.restart() calls, a real device would have rebooted */
+    uint32_t resets = 0;
+
+    /** The hardware random number generator of the ESP8266, a xorshift here */
+    uint32_t randomState = 2463534242u;
+
+    uint32_t hardwareRandom() {
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+        return randomState;
+    }
+
+    /** Heap allocations with new while countAllocations is set */
+    uint64_t allocations = 0;
+    bool countAllocations = false;
+
+    /**
+     * Time on the host, for benchmarks only
+     */
+    uint64_t hostNs() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    }
+}
+
+void* operator new(size_t size) {
+    if (emulator::countAllocations) {
+        emulator::allocations++;
+    }
+    void* p = malloc(size > 0 ? size : 1);
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+uint64_t micros64() {
+    return emulator::nowUs;
+}
+
+uint32_t micros() {
+    return (uint32_t)emulator::nowUs;
+}
+
+/**
+ * As the core does it: 64-bit microseconds divided, so millis() wraps after 49.7 days
+ */
+uint32_t millis() {
+    return (uint32_t)(emulator::nowUs / 1000);
+}
+
+/**
+ * Blocks on the device, so here the virtual time passes
+ */
+void delay(unsigned long ms) {
+    emulator::nowUs += ms * 1000ull;
+}
+
+void delayMicroseconds(unsigned int us) {
+    emulator::nowUs += us;
+}
+
+void yield() {
+}
+
+#define RANDOM_REG32 (emulator::hardwareRandom())
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (mode == INPUT_PULLUP && pin < 32) {
+        emulator::pinLevels[pin] = HIGH;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin < 32) {
+        emulator::pinLevels[pin] = val ? HIGH : LOW;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < 32 ? emulator::pinLevels[pin] : LOW;
+}
+
+int analogRead(uint8_t pin) {
+    return emulator::analogLevel;
+}
+
+void analogWrite(uint8_t pin, int val) {
+}
+
+void analogWriteFreq(uint32_t freq) {
+}
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val) {
+}
+
+#define digitalPinToInterrupt(p) (p)
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+}
+
+/**
+ * print() and friends over write(), as the core has them
+ */
+class Print {
+    size_t printNumber(unsigned long long n, int base, bool negative) {
+        char buf[8 * sizeof(n) + 2];
+        char* p = buf + sizeof(buf) - 1;
+        *p = 0;
+        do {
+            int digit = n % base;
+            *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+            n /= base;
+        } while (n > 0);
+        if (negative) {
+            *--p = '-';
+        }
+        return write(p);
+    }
+
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size-- > 0) {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+
+    size_t write(const char* str) {
+        return str == NULL ? 0 : write((const uint8_t*)str, strlen(str));
+    }
+
+    size_t printf(const char* format, ...) {
+        char buf[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        return write((const uint8_t*)buf, std::min(len, (int)sizeof(buf) - 1));
+    }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n, int base = 10) { return printNumber(n, base, false); }
+    size_t print(int n, int base = 10) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = 10) { return printNumber(n, base, false); }
+    size_t print(long n, int base = 10) { return base == 10 && n < 0 ? printNumber(-(unsigned long long)n, 10, true) : printNumber((unsigned long)n, base, false); }
+    size_t print(unsigned long n, int base = 10) { return printNumber(n, base, false); }
+    size_t print(double d, int digits = 2) { return print(String(d, digits)); }
+
+    size_t println() { return write("\r\n"); }
+    size_t println(const char* s) { return print(s) + println(); }
+    size_t println(const String& s) { return print(s) + println(); }
+    size_t println(char c) { return print(c) + println(); }
+    size_t println(unsigned char n, int base = 10) { return print(n, base) + println(); }
+    size_t println(int n, int base = 10) { return print(n, base) + println(); }
+    size_t println(unsigned int n, int base = 10) { return print(n, base) + println(); }
+    size_t println(long n, int base = 10) { return print(n, base) + println(); }
+    size_t println(unsigned long n, int base = 10) { return print(n, base) + println(); }
+    size_t println(double d, int digits = 2) { return print(d, digits) + println(); }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        size_t n = 0;
+        for (int c; n < length && (c = read()) >= 0; ++n) {
+            buffer[n] = (uint8_t)c;
+        }
+        return n;
+    }
+
+    size_t readBytes(char* buffer, size_t length) {
+        return readBytes((uint8_t*)buffer, length);
+    }
+};
+
+/**
+ * Counts what the sketch prints, echoes it to stdout if emulator::echoSerial is set
+ */
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) {
+    }
+
+    using Print::write;
+
+    virtual size_t write(uint8_t c) {
+        emulator::serialBytes++;
+        if (emulator::echoSerial) {
+            putchar(c);
+        }
+        return 1;
+    }
+
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        emulator::serialBytes += size;
+        if (emulator::echoSerial) {
+            fwrite(buffer, 1, size, stdout);
+        }
+        return size;
+    }
+
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+};
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+
+class EspClass {
+public:
+    uint32_t getChipId() { return 0xC10C; }
+    uint32_t getFreeHeap() { return 40000; }
+    uint16_t getVcc() { return 3300; }
+    void reset() { emulator::resets++; }
+    void restart() { emulator::resets++; }
+};
+
+EspClass ESP;
@@ -0,0 +1,663 @@
+#pragma once
+/**
+ * The part of ArduinoJson 6 the sketch uses, over a plain tree. Documents keep
+ * their capacity: every value takes a 16 byte slot as on the ESP8266 and every
+ * string its length plus one, a parse which doesn't fit fails with NoMemory.
+ * Unlike 6.x, numbers in strings read as numbers, the sketch's server sends both.
+ */
+
+#include <ctype.h>
+
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+
+class JsonDocument;
+
+struct JsonNode {
+    enum Type { NUL, BOOLEAN, INTEGER, REAL, STRING, OBJECT, ARRAY };
+    Type type = NUL;
+    bool boolean = false;
+    long long integer = 0;
+    double real = 0;
+    std::string text;
+    std::vector<std::string> keys;   // Of an object, one per item
+    std::vector<JsonNode> items;
+
+    JsonNode* find(const char* key) {
+        if (type != OBJECT || key == NULL) {
+            return NULL;
+        }
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] == key) {
+                return &items[i];
+            }
+        }
+        return NULL;
+    }
+};
+
+// As in ArduinoJson 6, in slots
+#define JSON_ARRAY_SIZE(n) ((n) * json::slotSize)
+#define JSON_OBJECT_SIZE(n) ((n) * json::slotSize)
+
+namespace json {
+    const int slotSize = 16;
+    const int nestingLimit = 10;
+
+    inline void writeString(const std::string& s, std::string& out) {
+        out += '"';
+        for (char c : s) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default: out += c;
+            }
+        }
+        out += '"';
+    }
+
+    /**
+     * indent < 0 writes it compact, otherwise pretty with two spaces per level
+     */
+    inline void write(const JsonNode& n, std::string& out, int indent) {
+        char buf[32];
+        switch (n.type) {
+            case JsonNode::NUL: out += "null"; break;
+            case JsonNode::BOOLEAN: out += n.boolean ? "true" : "false"; break;
+            case JsonNode::INTEGER: snprintf(buf, sizeof(buf), "%lld", n.integer); out += buf; break;
+            case JsonNode::REAL: snprintf(buf, sizeof(buf), "%.9g", n.real); out += buf; break;
+            case JsonNode::STRING: writeString(n.text, out); break;
+            case JsonNode::OBJECT:
+            case JsonNode::ARRAY: {
+                bool object = n.type == JsonNode::OBJECT;
+                out += object ? '{' : '[';
+                for (size_t i = 0; i < n.items.size(); ++i) {
+                    if (i > 0) {
+                        out += ',';
+                    }
+                    if (indent >= 0) {
+                        out += '\n';
+                        out.append((indent + 1) * 2, ' ');
+                    }
+                    if (object) {
+                        writeString(n.keys[i], out);
+                        out += indent >= 0 ? ": " : ":";
+                    }
+                    write(n.items[i], out, indent >= 0 ? indent + 1 : -1);
+                }
+                if (indent >= 0 && !n.items.empty()) {
+                    out += '\n';
+                    out.append(indent * 2, ' ');
+                }
+                out += object ? '}' : ']';
+                break;
+            }
+        }
+    }
+}
+
+class JsonObject;
+class JsonArray;
+
+/**
+ * A value in a document, or where one would go: a missing member reads as null
+ * and is added to its object when assigned
+ */
+class JsonVariant {
+    JsonDocument* _doc;
+    JsonNode* _node;
+    JsonNode* _parent;
+    const char* _key;
+
+    void read(bool& v) const { v = _node != NULL && (_node->type == JsonNode::BOOLEAN ? _node->boolean : readNumber() != 0); }
+    void read(int& v) const { v = (int)readInteger(); }
+    void read(unsigned int& v) const { v = (unsigned int)readInteger(); }
+    void read(long& v) const { v = (long)readInteger(); }
+    void read(unsigned long& v) const { v = (unsigned long)readInteger(); }
+    void read(long long& v) const { v = readInteger(); }
+    void read(float& v) const { v = (float)readNumber(); }
+    void read(double& v) const { v = readNumber(); }
+    void read(const char*& v) const { v = _node != NULL && _node->type == JsonNode::STRING ? _node->text.c_str() : NULL; }
+    void read(String& v) const {
+        if (_node == NULL || _node->type == JsonNode::STRING) {
+            v = _node == NULL ? "null" : _node->text.c_str();
+        } else {
+            std::string s;
+            json::write(*_node, s, -1);
+            v = s;
+        }
+    }
+    void read(JsonObject& v) const;
+    void read(JsonArray& v) const;
+
+    long long readInteger() const {
+        if (_node == NULL) {
+            return 0;
+        }
+        switch (_node->type) {
+            case JsonNode::INTEGER: return _node->integer;
+            case JsonNode::REAL: return (long long)_node->real;
+            case JsonNode::BOOLEAN: return _node->boolean;
+            case JsonNode::STRING: return atoll(_node->text.c_str());
+            default: return 0;
+        }
+    }
+
+    double readNumber() const {
+        if (_node != NULL && _node->type == JsonNode::REAL) {
+            return _node->real;
+        }
+        if (_node != NULL && _node->type == JsonNode::STRING) {
+            return atof(_node->text.c_str());
+        }
+        return (double)readInteger();
+    }
+
+    JsonNode* slot();
+
+public:
+    JsonVariant(JsonDocument* doc = NULL, JsonNode* node = NULL, JsonNode* parent = NULL, const char* key = NULL) :
+            _doc(doc), _node(node), _parent(parent), _key(key) {
+    }
+
+    bool isNull() const {
+        return _node == NULL || _node->type == JsonNode::NUL;
+    }
+
+    template<class T>
+    T as() const {
+        T v;
+        read(v);
+        return v;
+    }
+
+    template<class T>
+    operator T() const {
+        return as<T>();
+    }
+
+    bool operator==(const char* s) const {
+        return _node != NULL && _node->type == JsonNode::STRING && s != NULL && _node->text == s;
+    }
+
+    bool operator!=(const char* s) const {
+        return !(*this == s);
+    }
+
+    JsonVariant operator[](const char* key) const {
+        return JsonVariant(_doc, _node == NULL ? NULL : _node->find(key), _node != NULL && _node->type == JsonNode::OBJECT ? _node : NULL, key);
+    }
+
+    JsonVariant operator[](const String& key) const {
+        return (*this)[key.c_str()];
+    }
+
+    bool set(const char* s);
+    bool set(const String& s) { return set(s.c_str()); }
+    bool set(bool b);
+    bool set(long long n);
+    bool set(int n) { return set((long long)n); }
+    bool set(unsigned int n) { return set((long long)n); }
+    bool set(long n) { return set((long long)n); }
+    bool set(unsigned long n) { return set((long long)n); }
+    bool set(double d);
+
+    template<class T>
+    const JsonVariant& operator=(const T& v) const {
+        const_cast<JsonVariant*>(this)->set(v);
+        return *this;
+    }
+
+    const JsonVariant& operator=(const char* s) const {
+        const_cast<JsonVariant*>(this)->set(s);
+        return *this;
+    }
+
+    const JsonVariant& operator=(const JsonVariant& v) const {
+        const_cast<JsonVariant*>(this)->set(v.as<String>());
+        return *this;
+    }
+};
+
+class JsonObject {
+    JsonDocument* _doc;
+    JsonNode* _node;
+
+public:
+    JsonObject(JsonDocument* doc = NULL, JsonNode* node = NULL) : _doc(doc), _node(node) {}
+
+    bool isNull() const {
+        return _node == NULL;
+    }
+
+    JsonVariant operator[](const char* key) const {
+        return JsonVariant(_doc, _node == NULL ? NULL : _node->find(key), _node, key);
+    }
+
+    JsonVariant operator[](const String& key) const {
+        return (*this)[key.c_str()];
+    }
+
+    bool containsKey(const char* key) const {
+        return _node != NULL && _node->find(key) != NULL;
+    }
+
+    bool containsKey(const String& key) const {
+        return containsKey(key.c_str());
+    }
+
+    size_t size() const {
+        return _node == NULL ? 0 : _node->items.size();
+    }
+
+    const JsonNode* node() const {
+        return _node;
+    }
+};
+
+/**
+ * The items of an array in a document, read only
+ */
+class JsonArray {
+    JsonDocument* _doc;
+    JsonNode* _node;
+
+public:
+    JsonArray(JsonDocument* doc = NULL, JsonNode* node = NULL) : _doc(doc), _node(node) {}
+
+    bool isNull() const {
+        return _node == NULL;
+    }
+
+    size_t size() const {
+        return _node == NULL ? 0 : _node->items.size();
+    }
+
+    JsonVariant operator[](size_t i) const {
+        return JsonVariant(_doc, i < size() ? &_node->items[i] : NULL);
+    }
+};
+
+struct DeserializationError {
+    enum Code { Ok, IncompleteInput, InvalidInput, NoMemory, NotSupported, TooDeep };
+
+    Code _code;
+
+    DeserializationError(Code code = Ok) : _code(code) {}
+
+    explicit operator bool() const { return _code != Ok; }
+    bool operator==(Code code) const { return _code == code; }
+    bool operator!=(Code code) const { return _code != code; }
+    Code code() const { return _code; }
+
+    const char* c_str() const {
+        static const char* names[] = { "Ok", "IncompleteInput", "InvalidInput", "NoMemory", "NotSupported", "TooDeep" };
+        return names[_code];
+    }
+};
+
+class JsonDocument {
+    JsonNode _root;
+    size_t _capacity;
+    size_t _used = 0;
+
+    friend class JsonVariant;
+    friend class JsonParser;
+
+protected:
+    JsonDocument(size_t capacity) : _capacity(capacity) {}
+
+public:
+    /**
+     * Takes bytes out of the pool, false if they are not there
+     */
+    bool allocate(size_t bytes) {
+        if (_used + bytes > _capacity) {
+            return false;
+        }
+        _used += bytes;
+        return true;
+    }
+
+    void clear() {
+        _root = JsonNode();
+        _used = 0;
+    }
+
+    size_t capacity() const { return _capacity; }
+    size_t memoryUsage() const { return _used; }
+    JsonNode& root() { return _root; }
+
+    template<class T>
+    T to();
+
+    template<class T>
+    T as();
+};
+
+template<>
+inline JsonObject JsonDocument::to<JsonObject>() {
+    clear();
+    _root.type = JsonNode::OBJECT;
+    allocate(json::slotSize);
+    return JsonObject(this, &_root);
+}
+
+template<>
+inline JsonObject JsonDocument::as<JsonObject>() {
+    return JsonObject(this, _root.type == JsonNode::OBJECT ? &_root : NULL);
+}
+
+template<>
+inline JsonVariant JsonDocument::as<JsonVariant>() {
+    return JsonVariant(this, &_root);
+}
+
+class DynamicJsonDocument : public JsonDocument {
+public:
+    DynamicJsonDocument(size_t capacity) : JsonDocument(capacity) {}
+};
+
+template<size_t N>
+class StaticJsonDocument : public JsonDocument {
+public:
+    StaticJsonDocument() : JsonDocument(N) {}
+};
+
+inline void JsonVariant::read(JsonObject& v) const {
+    v = JsonObject(_doc, _node != NULL && _node->type == JsonNode::OBJECT ? _node : NULL);
+}
+
+inline void JsonVariant::read(JsonArray& v) const {
+    v = JsonArray(_doc, _node != NULL && _node->type == JsonNode::ARRAY ? _node : NULL);
+}
+
+/**
+ * The node to write into, added to the parent object if it was missing
+ */
+inline JsonNode* JsonVariant::slot() {
+    if (_node == NULL && _parent != NULL && _key != NULL && _doc != NULL && _doc->allocate(json::slotSize + strlen(_key) + 1)) {
+        _parent->keys.push_back(_key);
+        _parent->items.push_back(JsonNode());
+        _node = &_parent->items.back();
+    }
+    return _node;
+}
+
+inline bool JsonVariant::set(const char* s) {
+    JsonNode* n = slot();
+    if (n == NULL || (s != NULL && !_doc->allocate(strlen(s) + 1))) {
+        return false;
+    }
+    *n = JsonNode();
+    if (s != NULL) {
+        n->type = JsonNode::STRING;
+        n->text = s;
+    }
+    return true;
+}
+
+inline bool JsonVariant::set(bool b) {
+    JsonNode* n = slot();
+    if (n == NULL) {
+        return false;
+    }
+    *n = JsonNode();
+    n->type = JsonNode::BOOLEAN;
+    n->boolean = b;
+    return true;
+}
+
+inline bool JsonVariant::set(long long v) {
+    JsonNode* n = slot();
+    if (n == NULL) {
+        return false;
+    }
+    *n = JsonNode();
+    n->type = JsonNode::INTEGER;
+    n->integer = v;
+    return true;
+}
+
+inline bool JsonVariant::set(double d) {
+    JsonNode* n = slot();
+    if (n == NULL) {
+        return false;
+    }
+    *n = JsonNode();
+    n->type = JsonNode::REAL;
+    n->real = d;
+    return true;
+}
+
+/**
+ * Recursive descent over a zero terminated or sized input
+ */
+class JsonParser {
+    JsonDocument& _doc;
+    const char* _p;
+    const char* _end;
+
+    int peek() {
+        return _p < _end ? *_p : -1;
+    }
+
+    void skipSpace() {
+        while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r')) {
+            ++_p;
+        }
+    }
+
+    DeserializationError::Code string(std::string& out) {
+        ++_p; // The quote
+        while (_p < _end && *_p != '"') {
+            char c = *_p++;
+            if (c == '\\') {
+                if (_p >= _end) {
+                    return DeserializationError::IncompleteInput;
+                }
+                c = *_p++;
+                switch (c) {
+                    case 'n': c = '\n'; break;
+                    case 'r': c = '\r'; break;
+                    case 't': c = '\t'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'u': {
+                        if (_end - _p < 4) {
+                            return DeserializationError::IncompleteInput;
+                        }
+                        uint32_t cp = strtoul(std::string(_p, 4).c_str(), NULL, 16);
+                        _p += 4;
+                        // As UTF-8, surrogate pairs are not joined
+                        if (cp < 0x80) {
+                            out += (char)cp;
+                        } else if (cp < 0x800) {
+                            out += (char)(0xC0 | (cp >> 6));
+                            out += (char)(0x80 | (cp & 0x3F));
+                        } else {
+                            out += (char)(0xE0 | (cp >> 12));
+                            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+                            out += (char)(0x80 | (cp & 0x3F));
+                        }
+                        continue;
+                    }
+                    default: break;
+                }
+            }
+            out += c;
+        }
+        if (_p >= _end) {
+            return DeserializationError::IncompleteInput;
+        }
+        ++_p;
+        return _doc.allocate(out.size() + 1) ? DeserializationError::Ok : DeserializationError::NoMemory;
+    }
+
+    DeserializationError::Code value(JsonNode& n, int depth) {
+        if (!_doc.allocate(json::slotSize)) {
+            return DeserializationError::NoMemory;
+        }
+        skipSpace();
+        int c = peek();
+        if (c < 0) {
+            return DeserializationError::IncompleteInput;
+        }
+        if (c == '{' || c == '[') {
+            if (depth >= json::nestingLimit) {
+                return DeserializationError::TooDeep;
+            }
+            bool object = c == '{';
+            n.type = object ? JsonNode::OBJECT : JsonNode::ARRAY;
+            ++_p;
+            skipSpace();
+            if (peek() == (object ? '}' : ']')) {
+                ++_p;
+                return DeserializationError::Ok;
+            }
+            for (;;) {
+                skipSpace();
+                if (object) {
+                    if (peek() != '"') {
+                        return peek() < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+                    }
+                    std::string key;
+                    DeserializationError::Code e = string(key);
+                    if (e != DeserializationError::Ok) {
+                        return e;
+                    }
+                    skipSpace();
+                    if (peek() != ':') {
+                        return peek() < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+                    }
+                    ++_p;
+                    n.keys.push_back(key);
+                }
+                n.items.push_back(JsonNode());
+                DeserializationError::Code e = value(n.items.back(), depth + 1);
+                if (e != DeserializationError::Ok) {
+                    return e;
+                }
+                skipSpace();
+                c = peek();
+                ++_p;
+                if (c == ',') {
+                    continue;
+                }
+                if (c == (object ? '}' : ']')) {
+                    return DeserializationError::Ok;
+                }
+                return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+            }
+        }
+        if (c == '"') {
+            n.type = JsonNode::STRING;
+            return string(n.text);
+        }
+        const char* start = _p;
+        while (_p < _end && (isalnum((unsigned char)*_p) || *_p == '-' || *_p == '+' || *_p == '.')) {
+            ++_p;
+        }
+        std::string word(start, _p);
+        if (word == "true" || word == "false") {
+            n.type = JsonNode::BOOLEAN;
+            n.boolean = word == "true";
+        } else if (word == "null") {
+            n.type = JsonNode::NUL;
+        } else if (!word.empty() && (isdigit((unsigned char)word[0]) || word[0] == '-')) {
+            char* end;
+            if (word.find_first_of(".eE") == std::string::npos) {
+                n.type = JsonNode::INTEGER;
+                n.integer = strtoll(word.c_str(), &end, 10);
+            } else {
+                n.type = JsonNode::REAL;
+                n.real = strtod(word.c_str(), &end);
+            }
+            if (*end != 0) {
+                return DeserializationError::InvalidInput;
+            }
+        } else {
+            return _p >= _end ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+        }
+        return DeserializationError::Ok;
+    }
+
+public:
+    JsonParser(JsonDocument& doc, const char* input, size_t length) :
+            _doc(doc), _p(input), _end(input + length) {
+    }
+
+    DeserializationError parse() {
+        _doc.clear();
+        if (_p == NULL) {
+            return DeserializationError::InvalidInput;
+        }
+        return value(_doc._root, 0);
+    }
+};
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t length) {
+    return JsonParser(doc, input, length).parse();
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input) {
+    return deserializeJson(doc, input, input == NULL ? 0 : strlen(input));
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const uint8_t* input) {
+    return deserializeJson(doc, (const char*)input);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const uint8_t* input, size_t length) {
+    return deserializeJson(doc, (const char*)input, length);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& input) {
+    return deserializeJson(doc, input.c_str(), input.length());
+}
+
+inline std::string jsonText(const JsonObject& o, int indent) {
+    std::string s;
+    if (o.node() != NULL) {
+        json::write(*o.node(), s, indent);
+    } else {
+        s = "null";
+    }
+    return s;
+}
+
+inline size_t measureJson(const JsonObject& o) {
+    return jsonText(o, -1).size();
+}
+
+inline size_t measureJsonPretty(const JsonObject& o) {
+    return jsonText(o, 0).size();
+}
+
+/**
+ * Writes at most size - 1 characters and the terminating zero
+ */
+inline size_t serializeJson(const JsonObject& o, char* buf, size_t size) {
+    std::string s = jsonText(o, -1);
+    size_t n = size == 0 ? 0 : std::min(s.size(), size - 1);
+    memcpy(buf, s.data(), n);
+    if (size > 0) {
+        buf[n] = 0;
+    }
+    return n;
+}
+
+inline size_t serializeJson(const JsonObject& o, String& out) {
+    out = jsonText(o, -1);
+    return out.length();
+}
+
+inline size_t serializeJsonPretty(const JsonObject& o, String& out) {
+    out = jsonText(o, 0);
+    return out.length();
+}
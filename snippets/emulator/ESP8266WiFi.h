@@ -0,0 +1,161 @@
+#pragma once
+/**
+ * The station interface: begin() connects connectDelayMs of virtual time later if
+ * the access point is up, scans finish after scanMs and find nothing. Host names
+ * resolve through emulator::hosts.
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "Arduino.h"
+
+typedef enum {
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } WiFiMode_t;
+typedef enum { WIFI_PHY_MODE_11B = 1, WIFI_PHY_MODE_11G = 2, WIFI_PHY_MODE_11N = 3 } WiFiPhyMode_t;
+typedef enum { WIFI_NONE_SLEEP = 0, WIFI_LIGHT_SLEEP = 1, WIFI_MODEM_SLEEP = 2 } WiFiSleepType_t;
+typedef enum {
+    WIFI_EVENT_STAMODE_CONNECTED = 0,
+    WIFI_EVENT_STAMODE_DISCONNECTED,
+    WIFI_EVENT_STAMODE_AUTHMODE_CHANGE,
+    WIFI_EVENT_STAMODE_GOT_IP
+} WiFiEvent_t;
+
+#define ENC_TYPE_NONE 7
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+struct WiFiEventStationModeDisconnected {
+    String ssid;
+    uint8_t reason;
+};
+
+struct WiFiEventHandlerOpaque {};
+typedef std::shared_ptr<WiFiEventHandlerOpaque> WiFiEventHandler;
+
+class IPAddress {
+    uint32_t _address;
+
+public:
+    IPAddress(uint32_t address = 0) : _address(address) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+
+    operator uint32_t() const { return _address; }
+
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _address & 0xFF, (_address >> 8) & 0xFF, (_address >> 16) & 0xFF, _address >> 24);
+        return String(buf);
+    }
+};
+
+namespace emulator {
+    /** Whether the access point is there, and how long an association takes */
+    bool accessPointUp = true;
+    uint32_t connectDelayMs = 1500;
+    uint32_t scanMs = 2000;
+
+    std::map<std::string, IPAddress> hosts;
+}
+
+class ESP8266WiFiClass {
+    bool _begun = false;
+    uint64_t _connectAtUs = 0;
+    int _scan = WIFI_SCAN_FAILED;
+    uint64_t _scanDoneAtUs = 0;
+
+public:
+    void persistent(bool) {}
+    bool setAutoConnect(bool) { return true; }
+    bool setAutoReconnect(bool) { return true; }
+    bool setPhyMode(WiFiPhyMode_t) { return true; }
+    bool setSleepMode(WiFiSleepType_t) { return true; }
+    void onEvent(void (*)(WiFiEvent_t)) {}
+    bool mode(WiFiMode_t) { return true; }
+    bool hostname(const String&) { return true; }
+
+    WiFiEventHandler onStationModeDisconnected(std::function<void(const WiFiEventStationModeDisconnected&)>) {
+        return WiFiEventHandler(new WiFiEventHandlerOpaque());
+    }
+
+    wl_status_t begin(const char* ssid, const char* passphrase) {
+        _begun = true;
+        _connectAtUs = emulator::nowUs + emulator::connectDelayMs * 1000ull;
+        return status();
+    }
+
+    bool reconnect() {
+        if (!_begun) {
+            return false;
+        }
+        if (status() != WL_CONNECTED) {
+            _connectAtUs = emulator::nowUs + emulator::connectDelayMs * 1000ull;
+        }
+        return true;
+    }
+
+    /**
+     * Drops the association, as a lost access point would
+     */
+    void drop() {
+        _connectAtUs = UINT64_MAX;
+    }
+
+    wl_status_t status() {
+        if (!_begun) {
+            return WL_IDLE_STATUS;
+        }
+        return emulator::accessPointUp && emulator::nowUs >= _connectAtUs ? WL_CONNECTED : WL_DISCONNECTED;
+    }
+
+    IPAddress localIP() {
+        return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress();
+    }
+
+    int hostByName(const char* host, IPAddress& result) {
+        std::map<std::string, IPAddress>::const_iterator it = emulator::hosts.find(host);
+        if (status() != WL_CONNECTED || it == emulator::hosts.end()) {
+            return 0;
+        }
+        result = it->second;
+        return 1;
+    }
+
+    int8_t scanNetworks(bool async = false) {
+        _scan = WIFI_SCAN_RUNNING;
+        _scanDoneAtUs = emulator::nowUs + emulator::scanMs * 1000ull;
+        return WIFI_SCAN_RUNNING;
+    }
+
+    int8_t scanComplete() {
+        if (_scan == WIFI_SCAN_RUNNING && emulator::nowUs >= _scanDoneAtUs) {
+            _scan = 0;
+        }
+        return _scan;
+    }
+
+    void scanDelete() {
+        _scan = WIFI_SCAN_FAILED;
+    }
+
+    String SSID(uint8_t i) { return String(); }
+    int32_t channel(uint8_t i) { return 0; }
+    int32_t RSSI(uint8_t i) { return 0; }
+    uint8_t encryptionType(uint8_t i) { return ENC_TYPE_NONE; }
+};
+
+ESP8266WiFiClass WiFi;
+
+class WiFiClient {
+};
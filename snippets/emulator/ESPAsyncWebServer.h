@@ -0,0 +1,86 @@
+#pragma once
+/**
+ * Routes and parameters only. The harness hands requests to handle() itself.
+ */
+
+#include <map>
+#include <string>
+
+#include "ESP8266WiFi.h"
+
+class AsyncWebParameter {
+    String _name;
+    String _value;
+
+public:
+    AsyncWebParameter(const String& name, const String& value) : _name(name), _value(value) {}
+
+    const String& name() const { return _name; }
+    const String& value() const { return _value; }
+};
+
+class AsyncWebServerRequest {
+    String _url;
+    std::vector<AsyncWebParameter> _params;
+
+public:
+    int code = 0;
+    String contentType;
+    String content;
+
+    AsyncWebServerRequest(const String& url) : _url(url) {}
+
+    void addParam(const String& name, const String& value) {
+        _params.push_back(AsyncWebParameter(name, value));
+    }
+
+    const String& url() const { return _url; }
+
+    bool hasParam(const String& name) const {
+        return getParam(name) != NULL;
+    }
+
+    AsyncWebParameter* getParam(const String& name) const {
+        for (size_t i = 0; i < _params.size(); ++i) {
+            if (_params[i].name() == name) {
+                return const_cast<AsyncWebParameter*>(&_params[i]);
+            }
+        }
+        return NULL;
+    }
+
+    void send(int _code, const String& _contentType, const String& _content) {
+        code = _code;
+        contentType = _contentType;
+        content = _content;
+    }
+};
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+
+class AsyncWebServer {
+    std::map<std::string, ArRequestHandlerFunction> _handlers;
+    ArRequestHandlerFunction _notFound;
+
+public:
+    AsyncWebServer(uint16_t port) {}
+
+    void on(const char* uri, ArRequestHandlerFunction handler) {
+        _handlers[uri] = handler;
+    }
+
+    void onNotFound(ArRequestHandlerFunction handler) {
+        _notFound = handler;
+    }
+
+    void begin() {}
+
+    void handle(AsyncWebServerRequest& request) {
+        std::map<std::string, ArRequestHandlerFunction>::iterator it = _handlers.find(request.url().c_str());
+        if (it != _handlers.end()) {
+            it->second(&request);
+        } else if (_notFound) {
+            _notFound(&request);
+        }
+    }
+};
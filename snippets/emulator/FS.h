@@ -0,0 +1,72 @@
+#pragma once
+/**
+ * SPIFFS in memory: the harness puts settings.json in files before setup()
+ */
+
+#include <map>
+#include <string>
+
+#include "Arduino.h"
+
+class File {
+    std::string* _data;
+    size_t _pos;
+
+public:
+    File(std::string* data = NULL) : _data(data), _pos(0) {}
+
+    operator bool() const { return _data != NULL; }
+    size_t size() const { return _data == NULL ? 0 : _data->size(); }
+
+    size_t read(uint8_t* buf, size_t size) {
+        if (_data == NULL) {
+            return 0;
+        }
+        size_t n = std::min(size, _data->size() - _pos);
+        memcpy(buf, _data->data() + _pos, n);
+        _pos += n;
+        return n;
+    }
+
+    size_t write(const uint8_t* buf, size_t size) {
+        if (_data == NULL) {
+            return 0;
+        }
+        _data->append((const char*)buf, size);
+        return size;
+    }
+
+    void flush() {}
+
+    void close() {
+        _data = NULL;
+    }
+};
+
+class FS {
+public:
+    std::map<std::string, std::string> files;
+    uint32_t writes = 0;
+
+    bool begin() { return true; }
+
+    bool exists(const char* path) const {
+        return files.count(path) > 0;
+    }
+
+    File open(const char* path, const char* mode) {
+        if (mode[0] == 'w') {
+            writes++;
+            files[path].clear();
+        } else if (!exists(path)) {
+            return File();
+        }
+        return File(&files[path]);
+    }
+
+    bool remove(const char* path) {
+        return files.erase(path) > 0;
+    }
+};
+
+FS SPIFFS;
@@ -0,0 +1,3 @@
+#pragma once
+
+#include "IRremoteESP8266.h"
@@ -0,0 +1,35 @@
+#pragma once
+/**
+ * Counts the bytes which would go out on the bus
+ */
+
+#include "Arduino.h"
+
+#define SPI_MODE0 0x00
+
+namespace emulator {
+    uint64_t spiBytes = 0;
+}
+
+class SPISettings {
+public:
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {}
+};
+
+class SPIClass {
+public:
+    void begin() {}
+    void beginTransaction(SPISettings settings) {}
+    void endTransaction() {}
+
+    uint8_t transfer(uint8_t data) {
+        emulator::spiBytes++;
+        return 0;
+    }
+
+    void writeBytes(uint8_t* data, uint32_t size) {
+        emulator::spiBytes += size;
+    }
+};
+
+SPIClass SPI;
@@ -0,0 +1,27 @@
+#pragma once
+/**
+ * Swallows what is written, nothing ever comes back
+ */
+
+#include "Arduino.h"
+
+class SoftwareSerial : public Stream {
+public:
+    uint32_t written = 0;
+
+    SoftwareSerial(int rx, int tx) {}
+
+    void begin(long baud) {}
+    void enableRx(bool on) {}
+
+    using Print::write;
+
+    virtual size_t write(uint8_t c) {
+        written++;
+        return 1;
+    }
+
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+};
@@ -0,0 +1,142 @@
+#pragma once
+/**
+ * Arduino String over std::string: the constructors, concatenation and lookups
+ * the sketch uses, with the core's formatting of numbers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <type_traits>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class String {
+    std::string _s;
+
+    static std::string number(unsigned long long n, int base, bool negative) {
+        char buf[8 * sizeof(n) + 2];
+        char* p = buf + sizeof(buf) - 1;
+        *p = 0;
+        do {
+            int digit = n % base;
+            *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+            n /= base;
+        } while (n > 0);
+        if (negative) {
+            *--p = '-';
+        }
+        return p;
+    }
+
+    static std::string number(long long n, int base) {
+        return base == 10 && n < 0 ? number(-(unsigned long long)n, 10, true) : number((unsigned long long)n, base, false);
+    }
+
+public:
+    String(const char* s = "") : _s(s == NULL ? "" : s) {}
+    String(const std::string& s) : _s(s) {}
+    explicit String(char c) : _s(1, c) {}
+    explicit String(unsigned char n, unsigned char base = 10) : _s(number((unsigned long long)n, base, false)) {}
+    explicit String(int n, unsigned char base = 10) : _s(number((long long)n, base)) {}
+    explicit String(unsigned int n, unsigned char base = 10) : _s(number((unsigned long long)n, base, false)) {}
+    explicit String(long n, unsigned char base = 10) : _s(number((long long)n, base)) {}
+    explicit String(unsigned long n, unsigned char base = 10) : _s(number((unsigned long long)n, base, false)) {}
+    explicit String(long long n, unsigned char base = 10) : _s(number(n, base)) {}
+    explicit String(unsigned long long n, unsigned char base = 10) : _s(number(n, base, false)) {}
+    explicit String(double d, unsigned char decimalPlaces = 2) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, d);
+        _s = buf;
+    }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    char operator[](unsigned int i) const { return i < _s.length() ? _s[i] : 0; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+    long toInt() const { return atol(_s.c_str()); }
+    float toFloat() const { return atof(_s.c_str()); }
+    const std::string& str() const { return _s; }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t at = _s.find(c, from);
+        return at == std::string::npos ? -1 : (int)at;
+    }
+
+    int indexOf(const char* s, unsigned int from = 0) const {
+        size_t at = _s.find(s == NULL ? "" : s, from);
+        return at == std::string::npos ? -1 : (int)at;
+    }
+
+    int indexOf(const String& s, unsigned int from = 0) const {
+        return indexOf(s.c_str(), from);
+    }
+
+    String substring(unsigned int from) const { return from < _s.length() ? String(_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const { return from < to && from < _s.length() ? String(_s.substr(from, to - from)) : String(); }
+    bool startsWith(const String& s) const { return _s.compare(0, s._s.length(), s._s) == 0; }
+    bool endsWith(const String& s) const { return _s.length() >= s._s.length() && _s.compare(_s.length() - s._s.length(), s._s.length(), s._s) == 0; }
+
+    String& operator+=(const String& s) { _s += s._s; return *this; }
+    String& operator+=(const char* s) { if (s != NULL) { _s += s; } return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    template<class T>
+    typename std::enable_if<std::is_arithmetic<T>::value, String&>::type operator+=(T n) { return *this += String(n); }
+
+    bool concat(const String& s) { *this += s; return true; }
+    bool concat(const char* s) { *this += s; return true; }
+    bool concat(char c) { *this += c; return true; }
+
+    bool operator==(const String& s) const { return _s == s._s; }
+    bool operator==(const char* s) const { return _s == (s == NULL ? "" : s); }
+    bool operator!=(const String& s) const { return !(*this == s); }
+    bool operator!=(const char* s) const { return !(*this == s); }
+    bool operator<(const String& s) const { return _s < s._s; }
+    bool equals(const String& s) const { return *this == s; }
+};
+
+inline String operator+(const String& a, const String& b) {
+    String r(a);
+    r += b;
+    return r;
+}
+
+inline String operator+(const String& a, const char* b) {
+    String r(a);
+    r += b;
+    return r;
+}
+
+inline String operator+(const char* a, const String& b) {
+    String r(a);
+    r += b;
+    return r;
+}
+
+inline String operator+(const String& a, char c) {
+    String r(a);
+    r += c;
+    return r;
+}
+
+/**
+ * Numbers, enums and bools go in as decimals, as the core's StringSumHelper does
+ */
+template<class T>
+typename std::enable_if<std::is_arithmetic<T>::value, String>::type operator+(const String& a, T n) {
+    return a + String(n);
+}
+
+template<class T>
+typename std::enable_if<std::is_enum<T>::value, String>::type operator+(const String& a, T n) {
+    return a + String((int)n);
+}
+
+inline String operator+(const String& a, bool b) {
+    return a + String((int)b);
+}
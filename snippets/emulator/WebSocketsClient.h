@@ -0,0 +1,178 @@
+#pragma once
+/**
+ * The client end of the WebSocket, the server end is emulator::wsPeer. Messages
+ * either way are delivered in loop() once their virtual arrival time has come.
+ * As the library does, a lost connection is retried every reconnectIntervalMs.
+ */
+
+#include <deque>
+#include <string>
+
+#include "ESP8266WiFi.h"
+#include "WebSockets.h"
+
+namespace emulator {
+    class WsPeer {
+    public:
+        struct Message {
+            uint64_t atUs;
+            std::string text;
+            bool binary;
+        };
+
+        std::deque<Message> toDevice;
+        uint32_t connectDelayMs = 5;
+        bool up = true;
+        // How long each send from the device blocks, as it does when the TCP window is full
+        uint64_t sendStallUs = 0;
+
+        virtual ~WsPeer() {}
+
+        /**
+         * A text from the device, at emulator::nowUs
+         */
+        virtual void received(const char* text, size_t length) {}
+
+        /**
+         * A binary frame from the device, at emulator::nowUs
+         */
+        virtual void receivedBinary(const uint8_t* data, size_t length) {}
+
+        virtual void connected() {}
+
+        virtual void disconnected() {}
+
+        /**
+         * Sends text, or a binary frame, to the device, it gets there delayUs later
+         */
+        void push(const std::string& text, uint64_t delayUs = 0, bool binary = false) {
+            Message m = { nowUs + delayUs, text, binary };
+            std::deque<Message>::iterator it = toDevice.end();
+            while (it != toDevice.begin() && (it - 1)->atUs > m.atUs) {
+                --it;
+            }
+            toDevice.insert(it, m);
+        }
+
+        /**
+         * When the next message for the device arrives, UINT64_MAX if none is on the way
+         */
+        uint64_t nextArrivalUs() const {
+            return toDevice.empty() ? UINT64_MAX : toDevice.front().atUs;
+        }
+    };
+
+    WsPeer* wsPeer = NULL;
+}
+
+typedef std::function<void(WStype_t type, uint8_t* payload, size_t length)> WebSocketClientEvent;
+
+class WebSocketsClient {
+    enum State { IDLE, CONNECTING, CONNECTED };
+
+    WebSocketClientEvent _event;
+    State _state = IDLE;
+    bool _begun = false;
+    uint64_t _connectAtUs = 0;
+    std::string _url;
+    std::vector<uint8_t> _payload;
+
+    void fire(WStype_t type, const std::string& payload) {
+        if (_event) {
+            _payload.assign(payload.begin(), payload.end());
+            _payload.push_back(0);
+            _event(type, _payload.data(), payload.size());
+        }
+    }
+
+    void tryConnect() {
+        _state = CONNECTING;
+        _connectAtUs = emulator::nowUs + (emulator::wsPeer == NULL ? 0 : emulator::wsPeer->connectDelayMs) * 1000ull;
+    }
+
+public:
+    static const uint32_t reconnectIntervalMs = 500;
+
+    void begin(const char* host, uint16_t port, const char* url = "/", const char* protocol = "arduino") {
+        _begun = true;
+        _url = url;
+        tryConnect();
+    }
+
+    void onEvent(WebSocketClientEvent event) {
+        _event = event;
+    }
+
+    void disconnect() {
+        if (_state == CONNECTED) {
+            _state = IDLE;
+            if (emulator::wsPeer != NULL) {
+                emulator::wsPeer->disconnected();
+            }
+            fire(WStype_DISCONNECTED, "");
+        }
+        _state = IDLE;
+        _connectAtUs = emulator::nowUs + reconnectIntervalMs * 1000ull;
+    }
+
+    bool isConnected() const {
+        return _state == CONNECTED;
+    }
+
+    void loop() {
+        emulator::WsPeer* peer = emulator::wsPeer;
+        bool reachable = peer != NULL && peer->up && WiFi.status() == WL_CONNECTED;
+        if (_state == CONNECTED && !reachable) {
+            disconnect();
+            return;
+        }
+        if (_state == IDLE && _begun && emulator::nowUs >= _connectAtUs) {
+            tryConnect();
+        }
+        if (_state == CONNECTING && emulator::nowUs >= _connectAtUs) {
+            if (!reachable) {
+                _state = IDLE;
+                _connectAtUs = emulator::nowUs + reconnectIntervalMs * 1000ull;
+                return;
+            }
+            _state = CONNECTED;
+            peer->toDevice.clear();
+            peer->connected();
+            fire(WStype_CONNECTED, _url);
+        }
+        while (_state == CONNECTED && !peer->toDevice.empty() && peer->toDevice.front().atUs <= emulator::nowUs) {
+            emulator::WsPeer::Message m = peer->toDevice.front();
+            peer->toDevice.pop_front();
+            fire(m.binary ? WStype_BIN : WStype_TEXT, m.text);
+        }
+    }
+
+    bool sendTXT(const char* payload, size_t length = 0) {
+        if (_state != CONNECTED) {
+            return false;
+        }
+        // What the peer does with it is not the sketch's
+        bool counting = emulator::countAllocations;
+        emulator::countAllocations = false;
+        emulator::nowUs += emulator::wsPeer->sendStallUs;
+        emulator::wsPeer->received(payload, length == 0 ? strlen(payload) : length);
+        emulator::countAllocations = counting;
+        return true;
+    }
+
+    bool sendTXT(const String& payload) {
+        return sendTXT(payload.c_str(), payload.length());
+    }
+
+    bool sendBIN(const uint8_t* payload, size_t length) {
+        if (_state != CONNECTED) {
+            return false;
+        }
+        bool counting = emulator::countAllocations;
+        emulator::countAllocations = false;
+        emulator::nowUs += emulator::wsPeer->sendStallUs;
+        emulator::wsPeer->receivedBinary(payload, length);
+        emulator::countAllocations = counting;
+        return true;
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+/**
+ * Datagrams go to emulator::udpPeer, whatever plays the hosts out there
+ */
+
+#include <vector>
+
+#include "ESP8266WiFi.h"
+
+namespace emulator {
+    class UdpPeer {
+    public:
+        virtual ~UdpPeer() {}
+
+        virtual void datagram(IPAddress to, uint16_t port, const uint8_t* data, int len) = 0;
+
+        /**
+         * Length of a datagram for the device, 0 if none arrived yet
+         */
+        virtual int answer(uint8_t* data, int cap) = 0;
+    };
+
+    UdpPeer* udpPeer = NULL;
+}
+
+class WiFiUDP {
+    IPAddress _to;
+    uint16_t _port = 0;
+    std::vector<uint8_t> _out;
+    std::vector<uint8_t> _in;
+    size_t _read = 0;
+
+public:
+    uint8_t begin(uint16_t localPort) {
+        return 1;
+    }
+
+    int beginPacket(IPAddress ip, uint16_t port) {
+        _to = ip;
+        _port = port;
+        _out.clear();
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t len) {
+        _out.insert(_out.end(), data, data + len);
+        return len;
+    }
+
+    int endPacket() {
+        if (emulator::udpPeer == NULL || WiFi.status() != WL_CONNECTED) {
+            return 0;
+        }
+        emulator::udpPeer->datagram(_to, _port, _out.data(), _out.size());
+        return 1;
+    }
+
+    int parsePacket() {
+        _in.resize(1500);
+        int len = emulator::udpPeer == NULL ? 0 : emulator::udpPeer->answer(_in.data(), _in.size());
+        _in.resize(len);
+        _read = 0;
+        return len;
+    }
+
+    int read(uint8_t* data, size_t len) {
+        size_t n = std::min(len, _in.size() - _read);
+        memcpy(data, _in.data() + _read, n);
+        _read += n;
+        return n;
+    }
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Arduino.h"
+
+class TwoWire {
+public:
+    void begin(int sda, int scl) {}
+    void setClock(uint32_t frequency) {}
+};
+
+TwoWire Wire;
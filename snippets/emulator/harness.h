@@ -0,0 +1,302 @@
+#pragma once
+/**
+ * Runs the sketch on the virtual clock against a WebSocket server and an NTP
+ * server which both know the true time. Included after the sketch: it writes the
+ * settings setup() reads, then drives loop() one pass per passUs.
+ */
+
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "../simntpserver.h"
+
+namespace emulator {
+
+// 2026-03-01 09:00:00 UTC when the device is switched on
+int64_t trueUnixStartUs = 1772355600ll * 1000000;
+
+int64_t trueUnixUs() {
+    return trueUnixStartUs + (int64_t)nowUs;
+}
+
+/**
+ * settings.json with the defaults of every DevParam, values by JSON name override them
+ */
+void writeSettings(std::initializer_list<std::pair<const char*, const char*> > overrides) {
+    DynamicJsonDocument doc(4000);
+    JsonObject root = doc.to<JsonObject>();
+    for (sceleton::DevParam* d : sceleton::devParams) {
+        root[d->_jsonName] = d->_value;
+    }
+    for (const std::pair<const char*, const char*>& o : overrides) {
+        root[o.first] = o.second;
+    }
+    String text;
+    serializeJson(root, text);
+    SPIFFS.files["settings.json"] = text.c_str();
+}
+
+/**
+ * The sketch's server: pings every pingEveryMs, answers timeRequest with the time
+ * in milliseconds after oneWayUs each way, counts what the device sends and its bytes by type.
+ * Messages which don't parse as JSON are counted as invalid, unless validate is off. If
+ * speaksBinary, it answers a hello offering the binary protocol with "binary", then
+ * binary frames from the device count by the type of their kind and time goes binary too.
+ * If syncsState, it answers hello with stateSince and keeps the device's state from the
+ * "state" messages, across connections, as values in JSON by field.
+ */
+class ClockServer : public WsPeer {
+    bool _connected = false;
+    bool _binary = false;
+    uint64_t _nextPingUs = 0;
+
+    void count(const std::string& type, size_t length) {
+        messages++;
+        bytes += length;
+        byType[type]++;
+        bytesByType[type] += length;
+    }
+
+    static std::string typeOf(const char* text, size_t length) {
+        std::string s(text, length);
+        size_t at = s.find("\"type\"");
+        if (at == std::string::npos) {
+            return "";
+        }
+        size_t from = s.find('"', s.find(':', at) + 1);
+        size_t to = s.find('"', from + 1);
+        return from == std::string::npos || to == std::string::npos ? "" : s.substr(from + 1, to - from - 1);
+    }
+
+public:
+    uint64_t oneWayUs = 3000;
+    uint32_t pingEveryMs = 10000;
+    bool validate = true;
+    bool speaksBinary = false;
+    bool syncsState = false;
+    uint32_t stateEpoch = 0;
+    uint32_t stateVersion = 0;
+    std::map<std::string, std::string> state;
+
+    std::map<std::string, uint32_t> byType;
+    std::map<std::string, uint64_t> bytesByType;
+    uint32_t messages = 0;
+    uint32_t invalid = 0;
+    uint32_t binaryMessages = 0;
+    uint64_t bytes = 0;
+    uint32_t pings = 0;
+    uint32_t connects = 0;
+    std::string last;
+    std::map<std::string, std::string> lastOfType;
+    std::map<std::string, std::string> devParams;   // As the device said them, in hello and after it
+
+    virtual void connected() {
+        _connected = true;
+        _binary = false;
+        connects++;
+        _nextPingUs = nowUs + pingEveryMs * 1000ull;
+    }
+
+    virtual void disconnected() {
+        _connected = false;
+    }
+
+    virtual void received(const char* text, size_t length) {
+        last.assign(text, length);
+        std::string type = typeOf(text, length);
+        count(type, length);
+        lastOfType[type] = last;
+        if (validate) {
+            DynamicJsonDocument doc(4000);
+            if (deserializeJson(doc, text, length)) {
+                invalid++;
+            } else if (type == "hello" || type == "devParams") {
+                const JsonNode* params = doc.as<JsonObject>()["devParams"].as<JsonObject>().node();
+                for (size_t i = 0; params != NULL && i < params->keys.size(); ++i) {
+                    devParams[params->keys[i]] = params->items[i].text;
+                }
+            }
+        }
+        if (type == "timeRequest") {
+            DynamicJsonDocument doc(200);
+            deserializeJson(doc, text, length);
+            int64_t at = trueUnixUs() + oneWayUs;
+            if (_binary) {
+                uint8_t frame[32];
+                binproto::Writer w(frame, sizeof(frame));
+                w.begin(binproto::UNIXTIME).field(binproto::VALUE, (uint32_t)(at / 1000000)).field(binproto::MS, (int32_t)(at / 1000 % 1000))
+                    .field(binproto::REQUEST_ID, doc.as<JsonObject>()["id"].as<int>());
+                pushBinary(w, 2 * oneWayUs);
+                return;
+            }
+            char answer[128];
+            snprintf(answer, sizeof(answer), "{ \"type\": \"unixtime\", \"value\": %lld, \"ms\": %d, \"id\": %d }",
+                (long long)(at / 1000000), (int)(at / 1000 % 1000), doc.as<JsonObject>()["id"].as<int>());
+            push(answer, 2 * oneWayUs);
+        }
+        if (type == "hello" && syncsState) {
+            char ask[96];
+            snprintf(ask, sizeof(ask), "{ \"type\": \"stateSince\", \"epoch\": %u, \"version\": %u }", stateEpoch, stateVersion);
+            push(ask, oneWayUs);
+        }
+        if (type == "state") {
+            DynamicJsonDocument doc(4000);
+            deserializeJson(doc, text, length);
+            JsonObject root = doc.as<JsonObject>();
+            if (root["since"].as<unsigned long>() == 0) {
+                state.clear();
+            }
+            const JsonNode* values = root["values"].as<JsonObject>().node();
+            for (size_t i = 0; values != NULL && i < values->keys.size(); ++i) {
+                std::string value;
+                json::write(values->items[i], value, -1);
+                state[values->keys[i]] = value;
+            }
+            stateEpoch = root["epoch"].as<unsigned long>();
+            stateVersion = root["version"].as<unsigned long>();
+        }
+        if (type == "hello" && speaksBinary) {
+            DynamicJsonDocument doc(4000);
+            deserializeJson(doc, text, length);
+            if (doc.as<JsonObject>()["binary"].as<int>() == binproto::version) {
+                _binary = true;
+                push("{ \"type\": \"binary\", \"version\": 1 }", oneWayUs);
+            }
+        }
+    }
+
+    virtual void receivedBinary(const uint8_t* data, size_t length) {
+        binaryMessages++;
+        last.assign((const char*)data, length);
+        binproto::Reader r(data, length);
+        const char* name = binproto::kindName(r.kind());
+        count(name != NULL ? name : "", length);
+        if (!r.valid()) {
+            invalid++;
+        }
+    }
+
+    /**
+     * The frame the writer holds, to the device
+     */
+    void pushBinary(const binproto::Writer& w, uint64_t delayUs = 0) {
+        push(std::string((const char*)w.data(), w.length()), delayUs, true);
+    }
+
+    /**
+     * The binary protocol is on for this connection
+     */
+    bool binary() const {
+        return _binary;
+    }
+
+    uint64_t nextPingUs() const {
+        return _connected ? _nextPingUs : UINT64_MAX;
+    }
+
+    /**
+     * Called every pass, sends the pings
+     */
+    void tick() {
+        if (_connected && nowUs >= _nextPingUs) {
+            pings++;
+            push("{ \"type\": \"ping\", \"pingid\": \"" + std::to_string(pings) + "\" }", oneWayUs);
+            _nextPingUs += pingEveryMs * 1000ull;
+        }
+    }
+};
+
+/**
+ * SimNtpServer on the other end of WiFiUDP
+ */
+class NtpPeer : public UdpPeer {
+public:
+    SimNtpServer server;
+
+    NtpPeer() : server(trueUnixUs) {
+    }
+
+    virtual void datagram(IPAddress to, uint16_t port, const uint8_t* data, int len) {
+        if (port == 123) {
+            server.send(data, len);
+        }
+    }
+
+    virtual int answer(uint8_t* data, int cap) {
+        return server.receive(data, cap);
+    }
+};
+
+class Device {
+public:
+    ClockServer server;
+    NtpPeer ntp;
+    uint32_t passUs = 1000;   // A loop() pass with WiFi and a screen takes about that on the ESP8266
+
+    Device() {
+        wsPeer = &server;
+        udpPeer = &ntp;
+        hosts["pool.ntp.org"] = IPAddress(10, 0, 0, 123);
+    }
+
+    void boot() {
+        ::setup();
+    }
+
+    void pass() {
+        server.tick();
+        ::loop();
+        nowUs += passUs;
+    }
+
+    void run(uint64_t forUs) {
+        for (uint64_t until = nowUs + forUs; nowUs < until;) {
+            pass();
+        }
+    }
+
+    /**
+     * Runs until untilUs, skipping the idle time: a pass comes at every arrival from
+     * the servers, so exchanges keep their real round trips, and at least every
+     * strideUs. Frames in between are skipped unless followFrames, then every frame
+     * the sketch asks for is drawn when it is due.
+     */
+    void fastForward(uint64_t untilUs, uint64_t strideUs, bool followFrames = false) {
+        while (nowUs < untilUs) {
+            server.tick();
+            ::loop();
+            uint64_t next = std::min(nowUs + strideUs, untilUs);
+            // What is due already but the sketch didn't take, e.g. while it's offline, waits for the stride
+            int64_t ntpAt = ntp.server.nextArrivalUs();
+            for (uint64_t at : { server.nextArrivalUs(), server.nextPingUs(), ntpAt == INT64_MAX ? UINT64_MAX : (uint64_t)(ntpAt - trueUnixStartUs) }) {
+                if (at > nowUs) {
+                    next = std::min(next, at);
+                }
+            }
+            if (followFrames) {
+                uint32_t now = millis();
+                uint32_t wait = renderScheduler.due(now) ? 1 : renderScheduler.deadline() - now;
+                next = std::min(next, (nowUs / 1000 + wait) * 1000);
+            }
+            nowUs = std::max(next, nowUs + 1);
+        }
+    }
+
+    /**
+     * The screen as rows of # and ., the way it reads: x of the framebuffer grows to the left
+     */
+    std::string frame() {
+        std::string s;
+        for (int y = 0; y < screen.height(); ++y) {
+            for (int x = screen.width() - 1; x >= 0; --x) {
+                s += screen.get(x, y) ? '#' : '.';
+            }
+            s += '\n';
+        }
+        return s;
+    }
+};
+
+}
@@ -0,0 +1,912 @@
+/**
+ * The whole sketch on the host: MyWiFiClock.ino against the mocks in emulator/,
+ * on a virtual clock, with a server and an NTP server that know the true time.
+ * Checks that it boots, syncs and answers, then benchmarks frames of showTime,
+ * the bytes refreshAll sends, WebSocket commands, messages to the server as JSON
+ * and binary, streams of frames to the screen and loop() passes.
+ */
+#include "../MyWiFiClock.ino"
+#include "emulator/harness.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+const int64_t mskOffsetMs = 3 * 3600 * 1000;
+
+emulator::Device device;
+
+void checkBoot() {
+    emulator::writeSettings({
+        { "screen", "true" },
+        { "scrspi", "true" },
+        { "ws", "server.local" },
+        { "tz", "MSK-3" },
+        { "ntp", "pool.ntp.org" },
+        { "relays", "Lamp;Fan" },
+        { "ledstrip", "true" },
+    });
+    device.boot();
+    CHECK(screenController != NULL && sntp != NULL, "setup() took the settings");
+    device.run(30000000);
+
+    CHECK(WiFi.status() == WL_CONNECTED, "WiFi is up");
+    CHECK(device.server.byType["hello"] == 1, "%u hellos", device.server.byType["hello"]);
+    CHECK(device.server.byType["timeRequest"] == 1, "%u time requests since connected", device.server.byType["timeRequest"]);
+    CHECK(deviceClock.synced(), "clock synced");
+    int64_t error = deviceClock.unixUs() - emulator::trueUnixUs();
+    CHECK(llabs(error) < 5000, "clock is off by %lld us", (long long)error);
+    CHECK(clockSources.best() == ClockSources::NTP, "NTP disciplines the clock, not %s", clockSources.bestName());
+    // The last frame was drawn at most a controller refresh period ago
+    int64_t shownError = (int64_t)nowMs - (emulator::trueUnixUs() / 1000 + mskOffsetMs);
+    CHECK(shownError <= 0 && shownError > -(int64_t)MAX72xx::fullRefreshPeriodMs, "shown time is off by %lld ms", (long long)shownError);
+    CHECK(emulator::spiBytes == screenController->bytesSent(), "%llu bytes on SPI, %u counted",
+        (unsigned long long)emulator::spiBytes, screenController->bytesSent());
+}
+
+void checkServer() {
+    device.run(60000000);
+    CHECK(device.server.pings >= 6 && device.server.byType["pingresult"] == device.server.pings, "%u pings, %u answers",
+        device.server.pings, device.server.byType["pingresult"]);
+    CHECK(device.server.byType["renderStats"] >= 1, "render stats every minute");
+    CHECK(device.server.invalid == 0, "%u of %u messages from the device are no JSON, e.g. %s",
+        device.server.invalid, device.server.messages, device.server.last.c_str());
+
+    device.server.push("{ \"type\": \"ping\", oops", 1000);
+    device.run(100000);
+    CHECK(device.server.last.find("Failed to parse JSON") != std::string::npos, "broken JSON answered with %s", device.server.last.c_str());
+
+    AsyncWebServerRequest settingsPage("/");
+    sceleton::setupServer->handle(settingsPage);
+    CHECK(settingsPage.code == 200 && settingsPage.content.indexOf("time.zone") >= 0, "settings page");
+
+    CHECK(emulator::resets == 0, "%u resets", emulator::resets);
+    CHECK(device.server.connects == 1, "%u connects", device.server.connects);
+
+    // Every devParam at its longest, and escaped at its longest: hello goes, what doesn't fit it follows
+    std::vector<String> values;
+    size_t shown = 0;
+    for (sceleton::DevParam* d : sceleton::devParams) {
+        values.push_back(d->_value);
+        CHECK(!d->set(std::string(sceleton::DevParam::maxLength + 1, 'x').c_str()) && d->_value == values.back(), "%s too long", d->_name);
+        d->set(std::string(sceleton::DevParam::maxLength, '\x01').c_str());
+        shown += !d->_password;
+    }
+    uint32_t hellos = device.server.byType["hello"];
+    device.server.devParams.clear();
+    sceleton::sendHello();
+    device.run(100000);
+    CHECK(device.server.byType["hello"] == hellos + 1 && device.server.invalid == 0, "hello with the longest devParams");
+    CHECK(device.server.devParams.size() == shown && device.server.devParams["ntp.server"] == std::string(sceleton::DevParam::maxLength, '\x01'),
+        "%u of %u devParams in %u messages after hello", (unsigned)device.server.devParams.size(), (unsigned)shown, device.server.byType["devParams"]);
+    for (size_t i = 0; i < values.size(); ++i) {
+        sceleton::devParams[i]->_value = values[i];
+    }
+}
+
+/**
+ * Drops the connection and runs until the sketch said hello to a server which reads binary or not
+ */
+void reconnect(bool binary) {
+    device.server.speaksBinary = binary;
+    device.server.up = false;
+    device.run(1000000);
+    device.server.up = true;
+    device.run(10000000);
+}
+
+std::string binaryFrame(const binproto::Writer& w) {
+    return std::string((const char*)w.data(), w.length());
+}
+
+void checkBinary() {
+    uint32_t hellos = device.server.byType["hello"];
+    reconnect(true);
+    CHECK(device.server.byType["hello"] == hellos + 1 && device.server.binary() && sceleton::binaryTelemetry, "binary negotiated");
+
+    uint32_t binaries = device.server.binaryMessages;
+    uint32_t temps = device.server.byType["temp"];
+    sendReading("temp", 21.5f, binproto::TEMP, binproto::hundredths(21.5f));
+    sendKey("encoder_left", "click");
+    sceleton::flushQueue();
+    CHECK(device.server.binaryMessages == binaries + 2 && device.server.byType["temp"] == temps + 1, "telemetry goes binary");
+    sendReading("potentiometer", "42");
+    sceleton::flushQueue();
+    CHECK(device.server.binaryMessages == binaries + 2 && device.server.last.find("potentiometer") != std::string::npos, "no kind, JSON");
+
+    uint8_t frame[64];
+    binproto::Writer w(frame, sizeof(frame));
+    device.server.pushBinary(w.begin(binproto::BRIGHTNESS).field(binproto::VALUE, 40), 1000);
+    uint32_t relayStates = device.server.byType["relayState"];
+    device.server.pushBinary(w.begin(binproto::SWITCH).field(binproto::ID, 0u).field(binproto::ON, true), 2000);
+    device.run(100000);
+    CHECK(sceleton::brightness._value == "40", "brightness %s", sceleton::brightness._value.c_str());
+    CHECK(device.server.byType["relayState"] == relayStates + 1, "switch answered with relayState");
+
+    // All 64 LEDs of the stripe in one frame, their COLORS take two fields
+    uint8_t colors[64 * 4];
+    for (size_t i = 0; i < sizeof(colors); ++i) {
+        colors[i] = (uint8_t)(i + 1);
+    }
+    uint8_t wide[300];
+    binproto::Writer ws(wide, sizeof(wide));
+    device.server.pushBinary(ws.begin(binproto::LEDSTRIPE).fields(binproto::COLORS, colors, sizeof(colors)), 1000);
+    device.run(100000);
+    const std::vector<uint32_t>& stripeColors = sceleton::sink->getLedStripe();
+    CHECK(stripeColors.size() == 64 && stripeColors[0] == 0x01020304u && stripeColors[63] == 0xfdfeff00u,
+        "a whole stripe of %u LEDs", (unsigned)stripeColors.size());
+    device.server.push(std::string("\x01\x02\x03\x05", 4), 1000, true);
+    device.run(2000);
+    CHECK(device.server.last.find("Failed to parse binary") != std::string::npos, "broken frame answered with %s", device.server.last.c_str());
+
+    // Time requests are answered with binary unixtime now
+    device.run(120000000);
+    int64_t error = deviceClock.unixUs() - emulator::trueUnixUs();
+    CHECK(llabs(error) < 5000, "clock is off by %lld us", (long long)error);
+    CHECK(device.server.invalid == 0, "%u invalid messages", device.server.invalid);
+
+    reconnect(false);
+    CHECK(!sceleton::binaryTelemetry, "JSON again with a server that doesn't read binary");
+    CHECK(emulator::resets == 0, "%u resets", emulator::resets);
+}
+
+/**
+ * A burst of count keys, logs and potentiometer readings, interleaved, made in one
+ * go as a busy sketch would. Then loop() drains it; returns the longest pass in us.
+ */
+uint64_t burst(int count) {
+    char text[32];
+    for (int i = 0; i < count; ++i) {
+        sendKey("encoder_left", "rotate_cw");
+        snprintf(text, sizeof(text), "log %d", i);
+        debugPrint(text);
+        snprintf(text, sizeof(text), "%d", i);
+        sendReading("potentiometer", (const char*)text);
+    }
+    uint64_t longestUs = 0;
+    while (!sceleton::sendQueue.empty()) {
+        uint64_t t0 = emulator::nowUs;
+        device.pass();
+        longestUs = std::max(longestUs, emulator::nowUs - t0);
+    }
+    return longestUs;
+}
+
+void checkQueue() {
+    const int n = 20;
+    device.server.sendStallUs = 3000;
+    uint32_t keys = device.server.byType["ir_key"];
+    uint32_t logs = device.server.byType["log"];
+    uint32_t readings = device.server.byType["potentiometer"];
+    uint32_t statsSent = device.server.byType["queueStats"];
+    uint64_t longestUs = burst(n);
+    CHECK(device.server.byType["ir_key"] == keys + n, "%u of %d keys sent", device.server.byType["ir_key"] - keys, n);
+    CHECK(device.server.byType["potentiometer"] - readings < n && device.server.lastOfType["potentiometer"].find("\"19\"") != std::string::npos,
+        "%u readings, the last %s", device.server.byType["potentiometer"] - readings, device.server.lastOfType["potentiometer"].c_str());
+    CHECK(device.server.byType["log"] - logs < n && device.server.lastOfType["log"].find("log 19") != std::string::npos,
+        "%u logs, the last %s", device.server.byType["log"] - logs, device.server.lastOfType["log"].c_str());
+    CHECK(longestUs <= device.passUs + 2 * device.server.sendStallUs, "a pass took %u us draining", (unsigned)longestUs);
+
+    // The temperatures of the BME280 and the DS18B20 don't replace each other
+    uint32_t temps = device.server.byType["temp"];
+    for (int i = 0; i < 10; ++i) {
+        sendReading("temp", 20 + i, 0, 0, i % 2 == 0 ? BME280_SOURCE : DS18B20_SOURCE);
+    }
+    CHECK(sceleton::sendQueue.depth() == 2, "%d queued", sceleton::sendQueue.depth());
+    burst(0);
+    CHECK(device.server.byType["temp"] == temps + 2 && device.server.lastOfType["temp"].find("\"value\":29") != std::string::npos,
+        "%u temperatures, the last %s", device.server.byType["temp"] - temps, device.server.lastOfType["temp"].c_str());
+
+    // Keys beyond the room in the queue wait for the oldest to go, none is lost
+    keys = device.server.byType["ir_key"];
+    for (int i = 0; i < 100; ++i) {
+        sendKey("encoder_left", "rotate_ccw");
+    }
+    burst(0);
+    CHECK(device.server.byType["ir_key"] == keys + 100, "%u of 100 keys sent", device.server.byType["ir_key"] - keys);
+    device.server.sendStallUs = 0;
+
+    device.run(61000000);
+    const std::string& stats = device.server.lastOfType["queueStats"];
+    CHECK(device.server.byType["queueStats"] > statsSent && stats.find("\"coalesced\"") != std::string::npos, "queue stats %s", stats.c_str());
+    CHECK(device.server.invalid == 0, "%u invalid messages", device.server.invalid);
+    CHECK(emulator::resets == 0, "%u resets", emulator::resets);
+}
+
+/**
+ * A BME280 and a load cell on the device, their readings in batches of a second
+ * with the default thresholds, as JSON and then binary
+ */
+void checkTelemetry() {
+    bme = new Adafruit_BME280();
+    emulator::bme280.present = true;
+    hx711 = new Q2HX711(D5, D6);
+    emulator::scale.present = true;
+    emulator::scale.value = 5000;
+    sceleton::hasHX711._value = "true";
+    telemetry.setInterval(1000);
+    uint32_t readings = device.server.byType["temp"] + device.server.byType["humidity"] + device.server.byType["weight"];
+    uint32_t batches = device.server.byType["telemetry"];
+    device.run(5000000);
+    emulator::scale.value = 45000;
+    device.run(5000000);
+    CHECK(device.server.byType["temp"] + device.server.byType["humidity"] + device.server.byType["weight"] == readings, "no reading by itself");
+    CHECK(device.server.byType["telemetry"] == batches + 2, "%u batches", device.server.byType["telemetry"] - batches);
+    const std::string& batch = device.server.lastOfType["telemetry"];
+    CHECK(batch.find("{\"type\":\"weight\",\"value\":45000,") != std::string::npos && batch.find("temp") == std::string::npos,
+        "the step of weight alone: %s", batch.c_str());
+
+    // Unchanged readings go again after keepAliveMs, in binary frames now: the
+    // BME280 ones and the weight, taken 5 s later
+    reconnect(true);
+    batches = device.server.byType["telemetry"];
+    uint32_t binaries = device.server.binaryMessages;
+    device.run(telemetry.keepAliveMs * 1000ull);
+    CHECK(device.server.byType["telemetry"] == batches + 2 && device.server.binaryMessages >= binaries + 2,
+        "%u binary batches", device.server.byType["telemetry"] - batches);
+    CHECK(device.server.invalid == 0, "%u invalid messages", device.server.invalid);
+
+    // Unbatched, the weight goes as the whole number it is read as
+    telemetry.setInterval(0);
+    reconnect(false);
+    CHECK(device.server.lastOfType["weight"].find("\"value\":45000,") != std::string::npos, "a weight by itself: %s",
+        device.server.lastOfType["weight"].c_str());
+    sceleton::hasHX711._value = "false";
+    emulator::scale.present = false;
+    delete bme;
+    bme = NULL;
+    reconnect(false);
+}
+
+/**
+ * A server which syncs the state: all of it on the first connect, changes as they
+ * come, and after a reconnect only what changed while the link was down
+ */
+void checkState() {
+    uint32_t relayStates = device.server.byType["relayState"];
+    uint32_t ledstripeStates = device.server.byType["ledstripeState"];
+    device.server.syncsState = true;
+    reconnect(false);
+    std::string state = device.server.lastOfType["state"];
+    CHECK(state.find("\"since\":0,") != std::string::npos && device.server.state["firmware"] == std::string("\"") + sceleton::firmwareVersion + "\"" &&
+        device.server.state.count("relay1") == 1 && device.server.state.count("ledstripe") == 1, "all of it: %s", state.c_str());
+    CHECK(device.server.byType["relayState"] == relayStates + 2 && device.server.byType["ledstripeState"] == ledstripeStates + 1,
+        "relayState and ledstripeState on connect, as before: %u relayState, %u ledstripeState",
+        device.server.byType["relayState"] - relayStates, device.server.byType["ledstripeState"] - ledstripeStates);
+    CHECK(device.server.stateEpoch == sceleton::state.epoch() && device.server.stateVersion == sceleton::state.version(), "in sync");
+
+    // A change goes as it comes, alone
+    device.server.push("{ \"type\": \"switch\", \"id\": \"1\", \"on\": \"true\" }", 1000);
+    device.run(100000);
+    state = device.server.lastOfType["state"];
+    CHECK(device.server.state["relay1"] == "true" && state.find("firmware") == std::string::npos, "the switch: %s", state.c_str());
+    CHECK(device.server.stateVersion == sceleton::state.version(), "in sync after the switch");
+
+    // What changed while the link was down goes on reconnect, and only that
+    device.server.up = false;
+    device.run(1000000);
+    sceleton::applyBrightness(30);
+    sendSample("temp", 23.5f, binproto::TEMP, 2350);
+    device.server.up = true;
+    device.run(10000000);
+    state = device.server.lastOfType["state"];
+    CHECK(state.find("\"brightness\":30") != std::string::npos && state.find("\"temp\":23.50") != std::string::npos &&
+        state.find("firmware") == std::string::npos && state.find("relay") == std::string::npos, "the changes: %s", state.c_str());
+    CHECK(device.server.state["brightness"] == "30" && device.server.stateVersion == sceleton::state.version(), "in sync after the reconnect");
+
+    // A server that knows of another boot gets all of it
+    device.server.stateEpoch++;
+    reconnect(false);
+    CHECK(device.server.lastOfType["state"].find("\"since\":0,") != std::string::npos, "all again: %s", device.server.lastOfType["state"].c_str());
+
+    device.server.syncsState = false;
+    relayStates = device.server.byType["relayState"];
+    ledstripeStates = device.server.byType["ledstripeState"];
+    reconnect(false);
+    CHECK(device.server.byType["relayState"] == relayStates + 2 && device.server.byType["ledstripeState"] == ledstripeStates + 1,
+        "a server which doesn't sync the state: %u relayState, %u ledstripeState",
+        device.server.byType["relayState"] - relayStates, device.server.byType["ledstripeState"] - ledstripeStates);
+    CHECK(device.server.invalid == 0, "%u invalid messages", device.server.invalid);
+}
+
+void checkBatch() {
+    device.server.syncsState = true;
+    reconnect(false);
+    uint32_t relayStates = device.server.byType["relayState"];
+    uint32_t states = device.server.byType["state"];
+    device.server.push("{ \"type\": \"batch\", \"id\": 7, \"commands\": [ { \"type\": \"switch\", \"id\": \"0\", \"on\": \"true\" }, "
+        "{ \"type\": \"switch\", \"id\": \"1\", \"on\": \"true\" }, { \"type\": \"brightness\", \"value\": 55 }, "
+        "{ \"type\": \"ledstripe\", \"value\": \"00FF000000FF0000\" } ] }", 1000);
+    device.run(100000);
+    std::string ack = device.server.lastOfType["batchAck"];
+    CHECK(ack == "{\"type\":\"batchAck\",\"id\":7,\"applied\":4,\"version\":" + std::to_string(sceleton::state.version()) +
+        ",\"relays\":{\"0\":true,\"1\":true}}", "one ack: %s", ack.c_str());
+    CHECK(device.server.byType["relayState"] == relayStates && device.server.byType["state"] == states + 1,
+        "no relayState, one state: %u relayState, %u state", device.server.byType["relayState"] - relayStates, device.server.byType["state"] - states);
+    CHECK(device.server.state["brightness"] == "55" && device.server.state["relay1"] == "true" && device.server.state["ledstripe"] == "\"00FF000000FF0000\"",
+        "the state: %s", device.server.lastOfType["state"].c_str());
+
+    // A batch with one command which can't run runs none of them
+    uint32_t acks = device.server.byType["batchAck"];
+    device.server.push("{ \"type\": \"batch\", \"id\": 8, \"commands\": [ { \"type\": \"switch\", \"id\": \"0\", \"on\": \"false\" }, "
+        "{ \"type\": \"reboot\" } ] }", 1000);
+    device.server.push("{ \"type\": \"batch\", \"id\": 9, \"commands\": [ { \"type\": \"brightness\", \"value\": 5 }, "
+        "{ \"type\": \"switch\", \"id\": \"1\" } ] }", 2000);
+    device.run(100000);
+    CHECK(device.server.byType["batchAck"] == acks + 2 &&
+        device.server.lastOfType["batchAck"] == "{\"type\":\"batchAck\",\"id\":9,\"applied\":0,\"error\":\"missing field\",\"index\":1}",
+        "refused: %s", device.server.lastOfType["batchAck"].c_str());
+    CHECK(sceleton::sink->relayState(0) && sceleton::brightness._value == "55", "nothing of them ran");
+
+    // Only the relays in relay.names, an id past them would stand for another in the ack
+    device.server.push("{ \"type\": \"batch\", \"id\": 12, \"commands\": [ { \"type\": \"brightness\", \"value\": 5 }, "
+        "{ \"type\": \"switch\", \"id\": \"32\", \"on\": \"false\" } ] }", 1000);
+    device.run(100000);
+    CHECK(device.server.lastOfType["batchAck"] == "{\"type\":\"batchAck\",\"id\":12,\"applied\":0,\"error\":\"no such relay\",\"index\":1}",
+        "no such relay: %s", device.server.lastOfType["batchAck"].c_str());
+
+    // A full batch fits commandDoc
+    std::string full = "{ \"type\": \"batch\", \"id\": 13, \"commands\": [ ";
+    for (int i = 0; i < sceleton::maxBatch; ++i) {
+        full += std::string(i > 0 ? ", " : "") + "{ \"type\": \"switch\", \"id\": \"" + std::to_string(i % 2) + "\", \"on\": \"true\" }";
+    }
+    device.server.push(full + " ] }", 1000);
+    device.run(100000);
+    ack = device.server.lastOfType["batchAck"];
+    CHECK(ack.find("\"id\":13,\"applied\":" + std::to_string(sceleton::maxBatch) + ",") != std::string::npos, "full batch: %s", ack.c_str());
+
+    // The same in binary, answered in JSON
+    uint8_t frames[3][32];
+    binproto::Writer off0(frames[0], sizeof(frames[0]));
+    off0.begin(binproto::SWITCH).field(binproto::ID, 0u).field(binproto::ON, 0u);
+    binproto::Writer off1(frames[1], sizeof(frames[1]));
+    off1.begin(binproto::SWITCH).field(binproto::ID, 1u).field(binproto::ON, 0u);
+    binproto::Writer dim(frames[2], sizeof(frames[2]));
+    dim.begin(binproto::BRIGHTNESS).field(binproto::VALUE, (int32_t)20);
+    uint8_t frame[128];
+    binproto::Writer w(frame, sizeof(frame));
+    w.begin(binproto::BATCH).field(binproto::REQUEST_ID, (int32_t)10).field(binproto::COMMAND, off0.data(), off0.length())
+        .field(binproto::COMMAND, off1.data(), off1.length()).field(binproto::COMMAND, dim.data(), dim.length());
+    device.server.pushBinary(w, 1000);
+    device.run(100000);
+    ack = device.server.lastOfType["batchAck"];
+    CHECK(ack.find("\"id\":10,\"applied\":3,") != std::string::npos && ack.find("\"relays\":{\"0\":false,\"1\":false}") != std::string::npos,
+        "binary batch: %s", ack.c_str());
+    CHECK(!sceleton::sink->relayState(0) && sceleton::brightness._value == "20" && device.server.state["relay0"] == "false", "ran");
+
+    binproto::Writer later(frames[0], sizeof(frames[0]));
+    later.begin(binproto::UNIXTIME).field(binproto::VALUE, 1u);
+    w.begin(binproto::BATCH).field(binproto::REQUEST_ID, (int32_t)11).field(binproto::COMMAND, dim.data(), dim.length())
+        .field(binproto::COMMAND, later.data(), later.length());
+    device.server.pushBinary(w, 1000);
+    device.run(100000);
+    CHECK(device.server.lastOfType["batchAck"] == "{\"type\":\"batchAck\",\"id\":11,\"applied\":0,\"error\":\"not allowed in a batch\",\"index\":1}",
+        "binary refused: %s", device.server.lastOfType["batchAck"].c_str());
+    binproto::Writer other(frames[0], sizeof(frames[0]));
+    other.begin(binproto::SWITCH).field(binproto::ID, 2u).field(binproto::ON, 1u);
+    w.begin(binproto::BATCH).field(binproto::REQUEST_ID, (int32_t)14).field(binproto::COMMAND, other.data(), other.length());
+    device.server.pushBinary(w, 1000);
+    device.run(100000);
+    CHECK(device.server.lastOfType["batchAck"] == "{\"type\":\"batchAck\",\"id\":14,\"applied\":0,\"error\":\"no such relay\",\"index\":0}",
+        "binary no such relay: %s", device.server.lastOfType["batchAck"].c_str());
+    CHECK(device.server.byType["relayState"] == relayStates && device.server.invalid == 0, "%u invalid messages", device.server.invalid);
+    device.server.syncsState = false;
+}
+
+/**
+ * count frames drawn by draw(canvas, k) streamed to the device as binary frames at
+ * 50 fps, arriving up to jitterUs late in order, every 25th raw and the rest of
+ * encoding. Returns the bytes of the pixels sent, leaves the last frame in canvas.
+ */
+template<typename Draw>
+size_t streamFrames(LcdScreen& canvas, int count, uint8_t encoding, uint64_t jitterUs, Draw draw) {
+    std::mt19937 rnd(5);
+    std::vector<uint8_t> previous(canvas.bufferSize(), 0);
+    uint8_t packed[256];
+    uint8_t frame[300];
+    binproto::Writer w(frame, sizeof(frame));
+    uint64_t atUs = 0;
+    size_t bytes = 0;
+    for (int k = 0; k < count; ++k) {
+        canvas.clear();
+        draw(canvas, k);
+        const uint8_t* pixels = canvas.block(0);
+        uint8_t e = k % 25 == 0 ? (encoding & FrameStream::RLE) : encoding;
+        size_t length = FrameStream::encode(pixels, previous.data(), canvas.bufferSize(), e, packed, sizeof(packed));
+        previous.assign(pixels, pixels + canvas.bufferSize());
+        bytes += length;
+        atUs = std::max(atUs, (uint64_t)(k * 20000ull + (jitterUs > 0 ? rnd() % jitterUs : 0)));
+        device.server.pushBinary(w.begin(binproto::FRAME).field(binproto::SEQ, (uint32_t)k).field(binproto::TIMESTAMP_MS, (uint32_t)(k * 20))
+            .field(binproto::ENCODING, (uint32_t)e).field(binproto::PIXELS, packed, length), atUs);
+    }
+    return bytes;
+}
+
+void checkStream() {
+    LcdScreen canvas(screen.modulesWide(), screen.modulesHigh());
+    const int n = 100;
+    streamFrames(canvas, n, FrameStream::XOR | FrameStream::RLE, 30000, [](LcdScreen& c, int k) {
+        for (int y = 0; y < c.height(); ++y) {
+            c.set(k % c.width(), y, true);
+        }
+    });
+    device.run(n * 20000 + 100000);
+    CHECK(frameStream.active() && memcmp(screen.block(0), canvas.block(0), screen.bufferSize()) == 0, "the last frame is shown");
+    device.run(1500000);
+    CHECK(!frameStream.active() && device.server.byType["streamStats"] == 1, "stream over");
+    DynamicJsonDocument doc(500);
+    deserializeJson(doc, device.server.lastOfType["streamStats"].c_str());
+    JsonObject stats = doc.as<JsonObject>();
+    CHECK(stats["received"].as<int>() == n && stats["presented"].as<int>() == n && stats["dropped"].as<int>() == 0 && stats["late"].as<int>() == 0,
+        "%s", device.server.lastOfType["streamStats"].c_str());
+    CHECK(memcmp(screen.block(0), canvas.block(0), screen.bufferSize()) != 0, "the clock is back");
+}
+
+/**
+ * clear() and showTime() as loop() calls them, 20 ms apart through a quarter of an hour,
+ * on a screen of its own. With a message rolling over the clock as well.
+ */
+void benchShowTime() {
+    uint64_t savedUs = emulator::nowUs;
+    const uint32_t day = 20520;   // 2026-03-08
+    const int frames = 15 * 60 * 50;
+    uint32_t sum = 0;
+    for (int withMessage = 0; withMessage < 2; ++withMessage) {
+        uint64_t bestNs = UINT64_MAX;
+        for (int attempt = 0; attempt < 3; ++attempt) {
+            LcdScreen s;
+            emulator::nowUs = 0;
+            if (withMessage) {
+                s.showMessage("Погода: ясно, ветер 3 м/с, давление 752 мм рт. ст.", 1000000000);
+            }
+            uint64_t t0 = emulator::hostNs();
+            for (int f = 0; f < frames; ++f) {
+                emulator::nowUs += 20000;
+                s.clear();
+                s.showTime(day, 12 * 3600000 + f * 20);
+                sum += s.block(0)[3];
+            }
+            bestNs = std::min(bestNs, emulator::hostNs() - t0);
+        }
+        printf("showTime%s: %.0f frames per second, %.2f us per frame\n", withMessage ? " with a rolling message" : "",
+            frames * 1e9 / bestNs, bestNs / 1000.0 / frames);
+    }
+    emulator::nowUs = savedUs;
+    if (sum == 1) {
+        printf("\n");
+    }
+}
+
+/**
+ * What refreshAll() sends over ten minutes of the clock face, against a full refresh of every frame
+ */
+void benchRefresh() {
+    const uint64_t forUs = 600000000;
+    uint32_t bytes0 = screenController->bytesSent();
+    uint32_t frames = 0;
+    for (uint64_t until = emulator::nowUs + forUs; emulator::nowUs < until;) {
+        frames += renderScheduler.due(millis());
+        device.pass();
+    }
+    uint32_t bytes = screenController->bytesSent() - bytes0;
+    uint32_t fullFrameBytes = (4 + 8) * screenController->modules() * 2;
+    double seconds = forUs / 1e6;
+    printf("refreshAll: %u frames in %.0f s (%.1f fps), %u bytes, %.1f per frame, %.0f per second; "
+        "a full refresh of every frame would be %u per frame, %.0f per second\n",
+        frames, seconds, frames / seconds, bytes, (double)bytes / frames, bytes / seconds,
+        fullFrameBytes, (double)fullFrameBytes * frames / seconds);
+}
+
+/**
+ * Commands the server sends, all arriving at once; the loop() passes that take them in
+ */
+void benchCommands() {
+    const char* commands[] = {
+        "{ \"type\": \"ping\", \"pingid\": \"42\" }",
+        "{ \"type\": \"show\", \"text\": \"Позвонить маме\", \"totalMsToShow\": 3000 }",
+        "{ \"type\": \"tune\", \"text\": \"Громкость 7\" }",
+        "{ \"type\": \"additional-info\", \"text\": \"-3°C, снег\" }",
+        "{ \"type\": \"brightness\", \"value\": 40 }",
+        "{ \"type\": \"unixtime\", \"value\": 1772355600 }",
+        "{ \"type\": \"nothingLikeThat\", \"value\": 1 }",
+    };
+    const int n = 35000;
+    device.server.validate = false;
+    for (int i = 0; i < n; ++i) {
+        device.server.toDevice.push_back(emulator::WsPeer::Message { emulator::nowUs, commands[i % __countof(commands)] });
+    }
+    uint32_t before = device.server.messages;
+    uint64_t t0 = emulator::hostNs();
+    int passes = 0;
+    while (!device.server.toDevice.empty()) {
+        loop();
+        passes++;
+    }
+    uint64_t ns = emulator::hostNs() - t0;
+    device.server.validate = true;
+    printf("WebSocket commands: %d in %d loop() passes, %.0f per second, %.2f us each, %u answers\n",
+        n, passes, n * 1e9 / ns, ns / 1000.0 / n, device.server.messages - before);
+    // Let the brightness get saved
+    device.run(2000000);
+}
+
+/**
+ * Bursts of show, ledstripe and switch commands, one taken in per loop() pass, and
+ * broken ones: commands per second, the mean and the slow passes
+ */
+void benchBursts() {
+    const char* bursts[][3] = {
+        {
+            "{ \"type\": \"show\", \"text\": \"Позвонить маме\", \"totalMsToShow\": 3000 }",
+            "{ \"type\": \"ledstripe\", \"value\": \"FF00000000FF000000000FF0FFFFFFFF\" }",
+            "{ \"type\": \"switch\", \"id\": \"0\", \"on\": \"true\" }",
+        },
+        {
+            "{ \"type\": \"show\", oops",
+            "{ \"type\": \"ledstripe\", \"value\": \"FF0000\" } }",
+            "[ \"switch\" ]",
+        },
+    };
+    const int n = 30000;
+    device.server.validate = false;
+    for (int broken = 0; broken < 2; ++broken) {
+        std::vector<uint64_t> ns;
+        uint64_t sumNs = 0;
+        for (int i = 0; i < n; ++i) {
+            device.server.toDevice.push_back(emulator::WsPeer::Message { emulator::nowUs, bursts[broken][i % 3] });
+            uint64_t t0 = emulator::hostNs();
+            loop();
+            ns.push_back(emulator::hostNs() - t0);
+            sumNs += ns.back();
+        }
+        std::sort(ns.begin(), ns.end());
+        printf("%s commands, one per loop() pass: %.0f per second, mean %.2f us, 99.9%% %.2f us, max %.2f us\n",
+            broken ? "Broken" : "show/ledstripe/switch", n * 1e9 / sumNs, sumNs / 1000.0 / n, ns[n * 999 / 1000] / 1000.0, ns.back() / 1000.0);
+    }
+    device.server.validate = true;
+}
+
+/**
+ * Bytes of what the sketch sent since boot by message type. Then the messages the
+ * sketch writes with JsonWriter, one type after the other, against the String
+ * concatenation that built them before: bytes, heap allocations and host time each.
+ */
+void benchTelemetry() {
+    printf("Sent since boot:");
+    for (const std::pair<const std::string, uint64_t>& t : device.server.bytesByType) {
+        printf(" %s %u x %.0f bytes,", t.first.empty() ? "(untyped)" : t.first.c_str(), device.server.byType[t.first], (double)t.second / device.server.byType[t.first]);
+    }
+    printf("\n");
+
+    struct Producer {
+        const char* type;
+        void (*write)();
+        void (*concat)();
+    } producers[] = {
+        { "relayState",
+            [] { sceleton::reportRelayState(0); },
+            [] { sceleton::send("{ \"type\": \"relayState\", \"id\": " + String(0, DEC) + ", \"value\":" + (sceleton::sink->relayState(0) ? "true" : "false") + " }"); } },
+        { "ir_key",
+            [] { sendKey("encoder_left", "rotate_cw"); },
+            [] {
+                String s = "encoder_";
+                s += "left";
+                sceleton::send(String("{ \"type\": \"ir_key\", ") + "\"remote\": \"" + s + "\", " + "\"key\": \"" + "rotate_cw" + "\", " +
+                    "\"timeseq\": " + String(millis(), DEC) + " " + "}");
+            } },
+        { "temp",
+            [] { sendReading("temp", 21.5f); },
+            [] {
+                sceleton::send(String("{ \"type\": \"") + String("temp") + String("\", ") + "\"value\": " + String(21.5f) + ", " +
+                    "\"timeseq\": " + String((uint32_t)millis(), DEC) + " " + "}");
+            } },
+        { "log",
+            [] { debugPrint("Wrong temp: 10"); },
+            [] { sceleton::send("{ \"type\": \"log\", \"val\": \"" + String("Wrong temp: 10") + "\" }"); } },
+        { "clockStats",
+            [] { sendClockStats(); },
+            [] {
+                sceleton::send(String("{ \"type\": \"clockStats\", ") + "\"source\": \"" + clockSources.bestName() + "\", " +
+                    "\"offsetUs\": " + String((int32_t)deviceClock.offsetUs(), DEC) + ", " + "\"skewPpb\": " + String(deviceClock.skewPpb(), DEC) + ", " +
+                    "\"jitterUs\": " + String(deviceClock.jitterUs(), DEC) + ", " + "\"pollS\": " + String(deviceClock.pollIntervalS(), DEC) + ", " +
+                    "\"steps\": " + String(deviceClock.steps(), DEC) + " " + "}");
+            } },
+    };
+    const int n = 20000;
+    device.server.validate = false;
+    for (const Producer& p : producers) {
+        for (int concat = 0; concat < 2; ++concat) {
+            uint64_t bytes0 = device.server.bytes;
+            uint64_t allocations0 = emulator::allocations;
+            emulator::countAllocations = true;
+            uint64_t t0 = emulator::hostNs();
+            for (int i = 0; i < n; ++i) {
+                (concat ? p.concat : p.write)();
+                sceleton::flushQueue();
+            }
+            uint64_t ns = emulator::hostNs() - t0;
+            emulator::countAllocations = false;
+            printf("%-10s %-10s %5.1f bytes, %4.1f allocations, %5.3f us per message\n", p.type, concat ? "String" : "JsonWriter",
+                (double)(device.server.bytes - bytes0) / n, (double)(emulator::allocations - allocations0) / n, ns / 1000.0 / n);
+        }
+    }
+    device.server.validate = true;
+}
+
+/**
+ * The bursts of show, ledstripe and switch commands as binary frames, then the
+ * readings and keys as binary: bytes and host time each
+ */
+void benchBinary() {
+    reconnect(true);
+    uint8_t frame[64];
+    binproto::Writer w(frame, sizeof(frame));
+    const uint8_t colors[] = { 0xff, 0, 0, 0, 0, 0xff, 0, 0, 0, 0, 0x0f, 0xf0, 0xff, 0xff, 0xff, 0xff };
+    std::string burst[] = {
+        binaryFrame(w.begin(binproto::SHOW).field(binproto::TEXT, "Позвонить маме").field(binproto::DURATION_MS, 3000)),
+        binaryFrame(w.begin(binproto::LEDSTRIPE).field(binproto::COLORS, colors, sizeof(colors))),
+        binaryFrame(w.begin(binproto::SWITCH).field(binproto::ID, 0u).field(binproto::ON, true)),
+    };
+    const int n = 30000;
+    std::vector<uint64_t> ns;
+    uint64_t sumNs = 0;
+    for (int i = 0; i < n; ++i) {
+        device.server.push(burst[i % 3], 0, true);
+        uint64_t t0 = emulator::hostNs();
+        loop();
+        ns.push_back(emulator::hostNs() - t0);
+        sumNs += ns.back();
+    }
+    std::sort(ns.begin(), ns.end());
+    printf("Binary show/ledstripe/switch, one per loop() pass: %.0f per second, mean %.2f us, 99.9%% %.2f us, max %.2f us, %u+%u+%u bytes\n",
+        n * 1e9 / sumNs, sumNs / 1000.0 / n, ns[n * 999 / 1000] / 1000.0, ns.back() / 1000.0,
+        (unsigned)burst[0].size(), (unsigned)burst[1].size(), (unsigned)burst[2].size());
+
+    struct Producer {
+        const char* type;
+        void (*write)();
+    } producers[] = {
+        { "ir_key", [] { sendKey("encoder_left", "rotate_cw"); } },
+        { "temp", [] { sendReading("temp", 21.5f, binproto::TEMP, binproto::hundredths(21.5f)); } },
+        { "pressure", [] { sendReading("pressure", 101325.37f, binproto::PRESSURE, binproto::hundredths(101325.37f)); } },
+    };
+    const int m = 20000;
+    for (const Producer& p : producers) {
+        uint64_t bytes0 = device.server.bytes;
+        uint64_t t0 = emulator::hostNs();
+        for (int i = 0; i < m; ++i) {
+            p.write();
+            sceleton::flushQueue();
+        }
+        uint64_t ns = emulator::hostNs() - t0;
+        printf("%-10s binary     %5.1f bytes, %5.3f us per message\n", p.type, (double)(device.server.bytes - bytes0) / m, ns / 1000.0 / m);
+    }
+    reconnect(false);
+}
+
+/**
+ * The burst over a connection that takes 3 ms a send, queued and sent as it is made,
+ * as before the queue: how long the code making it waits, the longest loop() pass
+ * and the messages that went
+ */
+void benchQueue() {
+    const int n = 40;
+    device.server.sendStallUs = 3000;
+    for (int direct = 0; direct < 2; ++direct) {
+        char text[32];
+        uint32_t messages = device.server.messages;
+        uint64_t t0 = emulator::nowUs;
+        for (int i = 0; i < n; ++i) {
+            sendKey("encoder_left", "rotate_cw");
+            snprintf(text, sizeof(text), "log %d", i);
+            debugPrint(text);
+            snprintf(text, sizeof(text), "%d", i);
+            sendReading("potentiometer", (const char*)text);
+            if (direct) {
+                sceleton::flushQueue();
+            }
+        }
+        uint64_t blockedUs = emulator::nowUs - t0;
+        uint64_t longestUs = burst(0);
+        printf("Burst of %d keys, logs and readings, 3 ms a send, %-6s: made in %5.1f ms, longest loop() pass %4.1f ms, %3u messages sent\n",
+            n, direct ? "direct" : "queued", blockedUs / 1000.0, longestUs / 1000.0, device.server.messages - messages);
+    }
+    device.server.sendStallUs = 0;
+}
+
+/**
+ * What a reconnect costs with 2 relays and 60 LEDs: the relayState and ledstripeState
+ * messages every server gets, and on top of them the state to one which syncs it,
+ * when nothing changed and when it knows nothing
+ */
+void benchState() {
+    sceleton::applyLedStripe(std::vector<uint32_t>(60, 0xff000000));
+    device.server.syncsState = true;
+    reconnect(false);
+    struct Case {
+        const char* name;
+        bool syncs;
+        bool forget;
+    } cases[] = {
+        { "doesn't sync", false, false },
+        { "syncs, nothing changed", true, false },
+        { "syncs, knows nothing", true, true },
+    };
+    for (const Case& c : cases) {
+        device.server.syncsState = c.syncs;
+        if (c.forget) {
+            device.server.stateEpoch = 0;
+        }
+        const char* types[] = { "relayState", "ledstripeState", "state" };
+        uint32_t messages = 0;
+        uint64_t bytes = 0;
+        for (const char* t : types) {
+            messages -= device.server.byType[t];
+            bytes -= device.server.bytesByType[t];
+        }
+        reconnect(false);
+        for (const char* t : types) {
+            messages += device.server.byType[t];
+            bytes += device.server.bytesByType[t];
+        }
+        printf("Reconnect to a server which %-23s %u messages of the state, %4u bytes\n", (std::string(c.name) + ":").c_str(), messages, (unsigned)bytes);
+    }
+    device.server.syncsState = false;
+}
+
+/**
+ * A scene of six commands, each changing the state, sent one by one, each after
+ * the device answered the one before, against one batch: the time from the first
+ * command sent until the server heard the last answer, and frames and bytes both ways
+ */
+void benchBatch() {
+    const char* scene[] = {
+        "{ \"type\": \"switch\", \"id\": \"0\", \"on\": \"true\" }",
+        "{ \"type\": \"switch\", \"id\": \"1\", \"on\": \"true\" }",
+        "{ \"type\": \"brightness\", \"value\": 35 }",
+        "{ \"type\": \"ledstripe\", \"value\": \"FF800000FF800000\" }",
+        "{ \"type\": \"switch\", \"id\": \"1\", \"on\": \"false\" }",
+        "{ \"type\": \"brightness\", \"value\": 50 }",
+    };
+    device.server.syncsState = true;
+    reconnect(false);
+    // Back to where the scene starts
+    device.server.push("{ \"type\": \"batch\", \"id\": 1, \"commands\": [ { \"type\": \"switch\", \"id\": \"0\", \"on\": \"false\" }, "
+        "{ \"type\": \"brightness\", \"value\": 20 }, { \"type\": \"ledstripe\", \"value\": \"00000000\" } ] }");
+    device.run(100000);
+
+    const uint64_t oneWayUs = device.server.oneWayUs;
+    // Runs until the server heard something more than before, then its trip back
+    auto untilAnswered = [&](uint32_t before) {
+        for (uint64_t until = emulator::nowUs + 100000; emulator::nowUs < until && device.server.messages == before;) {
+            device.pass();
+        }
+        emulator::nowUs += oneWayUs;
+    };
+    for (bool batched : { false, true }) {
+        uint64_t startUs = emulator::nowUs;
+        uint32_t messages = device.server.messages;
+        uint64_t bytes = device.server.bytes;
+        size_t toDevice = 0;
+        std::string batch = "{ \"type\": \"batch\", \"id\": 2, \"commands\": [ ";
+        for (size_t i = 0; i < __countof(scene); ++i) {
+            if (batched) {
+                batch += std::string(i > 0 ? ", " : "") + scene[i];
+                continue;
+            }
+            toDevice += strlen(scene[i]);
+            uint32_t before = device.server.messages;
+            device.server.push(scene[i], oneWayUs);
+            untilAnswered(before);
+        }
+        if (batched) {
+            batch += " ] }";
+            toDevice += batch.length();
+            uint32_t before = device.server.messages;
+            device.server.push(batch, oneWayUs);
+            untilAnswered(before);
+        }
+        uint64_t us = emulator::nowUs - startUs;
+        device.run(100000);
+        printf("Scene of %u commands %-10s %5.1f ms, %u frames to the device, %2u back, %4u bytes\n", (unsigned)__countof(scene),
+            batched ? "batched:" : "one by one:", us / 1000.0, batched ? 1 : (unsigned)__countof(scene),
+            device.server.messages - messages, (unsigned)(toDevice + device.server.bytes - bytes));
+        // Undo the scene for the next run
+        device.server.push("{ \"type\": \"batch\", \"id\": 3, \"commands\": [ { \"type\": \"switch\", \"id\": \"0\", \"on\": \"false\" }, "
+            "{ \"type\": \"brightness\", \"value\": 20 }, { \"type\": \"ledstripe\", \"value\": \"00000000\" } ] }");
+        device.run(100000);
+    }
+    device.server.syncsState = false;
+}
+
+/**
+ * Ten seconds of the clock face drawn on the server and streamed at 50 fps, raw and
+ * as XOR+RLE: bytes per frame and host time of the loop() passes meanwhile
+ */
+void benchStream() {
+    LcdScreen canvas(screen.modulesWide(), screen.modulesHigh());
+    const int n = 500;
+    for (uint8_t encoding : { (uint8_t)FrameStream::RAW, (uint8_t)(FrameStream::XOR | FrameStream::RLE) }) {
+        uint64_t startMs = 1772355600000ull + 10 * 3600000ull;
+        size_t bytes = streamFrames(canvas, n, encoding, 30000, [=](LcdScreen& c, int k) {
+            uint64_t ms = startMs + k * 20;
+            c.showTime(ms / dayInMs, ms % dayInMs);
+        });
+        std::vector<uint64_t> ns;
+        uint64_t sumNs = 0;
+        uint32_t spiBytes = screenController->bytesSent();
+        for (uint64_t until = emulator::nowUs + n * 20000ull + 200000; emulator::nowUs < until;) {
+            device.server.tick();
+            uint64_t t0 = emulator::hostNs();
+            loop();
+            ns.push_back(emulator::hostNs() - t0);
+            sumNs += ns.back();
+            emulator::nowUs += device.passUs;
+        }
+        device.run(1500000);
+        std::sort(ns.begin(), ns.end());
+        const FrameStream::Stats& stats = frameStream.stats();
+        printf("Stream of %d frames %-7s %5.1f pixel bytes per frame; %u presented, %u dropped, %u late; loop() mean %.2f us, 99.9%% %.2f us; %.1f SPI bytes per frame\n",
+            n, encoding == FrameStream::RAW ? "raw" : "XOR+RLE", (double)bytes / n, stats.presented, stats.dropped, stats.late,
+            sumNs / 1000.0 / ns.size(), ns[ns.size() * 999 / 1000] / 1000.0, (double)(screenController->bytesSent() - spiBytes) / n);
+    }
+}
+
+/**
+ * Host time of every loop() pass over a minute, those which render apart
+ */
+void benchLoop() {
+    std::vector<uint64_t> idle;
+    std::vector<uint64_t> render;
+    for (uint64_t until = emulator::nowUs + 60000000; emulator::nowUs < until;) {
+        device.server.tick();
+        bool rendering = renderScheduler.due(millis());
+        uint64_t t0 = emulator::hostNs();
+        loop();
+        uint64_t ns = emulator::hostNs() - t0;
+        (rendering ? render : idle).push_back(ns);
+        emulator::nowUs += device.passUs;
+    }
+    for (std::vector<uint64_t>* v : { &idle, &render }) {
+        std::sort(v->begin(), v->end());
+        uint64_t sum = 0;
+        for (uint64_t ns : *v) {
+            sum += ns;
+        }
+        printf("loop() %s passes: %6u, mean %6.2f us, median %6.2f us, 99%% %6.2f us, max %7.2f us\n",
+            v == &idle ? "idle     " : "rendering", (unsigned)v->size(), sum / 1000.0 / v->size(),
+            (*v)[v->size() / 2] / 1000.0, (*v)[v->size() * 99 / 100] / 1000.0, v->back() / 1000.0);
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    checkBoot();
+    checkServer();
+    checkBinary();
+    checkStream();
+    checkQueue();
+    checkTelemetry();
+    checkState();
+    checkBatch();
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("The sketch boots, syncs and talks to the server on the emulator\n");
+    benchShowTime();
+    benchRefresh();
+    benchCommands();
+    benchBursts();
+    benchTelemetry();
+    benchBinary();
+    benchQueue();
+    benchState();
+    benchBatch();
+    benchStream();
+    benchLoop();
+    return 0;
+}
@@ -0,0 +1,328 @@
+/**
+ * Font compiler: turns BDF fonts into the packed variable width format of
+ * packedfont.h and writes them all into one header.
+ *
+ *   fontCompiler ../fontdata.h fontClock=../fonts/clock.bdf [fontOther=other.bdf ...]
+ *
+ * Glyphs are stored as tightly packed column bytes with an offset table, identical
+ * glyphs (e.g. the same letter under two code points) are stored once, and so are
+ * identical blocks of the code point index. Glyph ids are one byte, up to 254 glyphs.
+ * Fonts may be up to 8 pixels high.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+
+const uint16_t NO_GLYPH = 0xFFFF;
+const uint8_t NONE = 0xFF;     // PACKED_NONE: no such page, block or glyph
+
+struct BdfGlyph {
+    uint32_t codePoint;
+    std::vector<uint8_t> columns;
+};
+
+struct Font {
+    std::string name;
+    std::string source;
+    int height;
+    std::vector<BdfGlyph> glyphs;
+};
+
+static bool startsWith(const char* s, const char* prefix) {
+    return strncmp(s, prefix, strlen(prefix)) == 0;
+}
+
+bool readBdf(const char* fileName, Font& font) {
+    FILE* f = fopen(fileName, "r");
+    if (f == NULL) {
+        perror(fileName);
+        return false;
+    }
+
+    int ascent = 0;
+    int descent = 0;
+    char line[512];
+    BdfGlyph glyph;
+    int bbxW = 0, bbxH = 0, bbxX = 0, bbxY = 0;
+    long encoding = -1;
+    int bitmapRow = -1;
+    int lineNo = 0;
+    bool ok = true;
+
+    while (ok && fgets(line, sizeof(line), f) != NULL) {
+        lineNo++;
+        if (startsWith(line, "FONT_ASCENT ")) {
+            ascent = atoi(line + 12);
+        } else if (startsWith(line, "FONT_DESCENT ")) {
+            descent = atoi(line + 13);
+        } else if (startsWith(line, "STARTCHAR")) {
+            encoding = -1;
+            bitmapRow = -1;
+            bbxW = bbxH = bbxX = bbxY = 0;
+        } else if (startsWith(line, "ENCODING ")) {
+            encoding = atol(line + 9);
+        } else if (startsWith(line, "BBX ")) {
+            sscanf(line + 4, "%d %d %d %d", &bbxW, &bbxH, &bbxX, &bbxY);
+        } else if (startsWith(line, "BITMAP")) {
+            if (bbxX < 0 || bbxX + bbxW > 32) {
+                fprintf(stderr, "%s:%d: glyph is wider than 32 columns\n", fileName, lineNo);
+                ok = false;
+            }
+            glyph.codePoint = encoding;
+            glyph.columns.assign(bbxX + bbxW, 0);
+            bitmapRow = 0;
+        } else if (startsWith(line, "ENDCHAR")) {
+            if (encoding >= 0) {
+                font.glyphs.push_back(glyph);
+            }
+            bitmapRow = -1;
+        } else if (bitmapRow >= 0) {
+            // Rows are top to bottom, leftmost pixel is the highest bit
+            uint32_t bits = strtoul(line, NULL, 16);
+            int hexDigits = strspn(line, "0123456789abcdefABCDEF");
+            int y = (ascent - (bbxY + bbxH)) + bitmapRow;
+            for (int x = 0; x < bbxW; ++x) {
+                if ((bits >> (hexDigits * 4 - 1 - x)) & 1) {
+                    if (y < 0 || y >= 8) {
+                        fprintf(stderr, "%s:%d: pixel outside of 8 rows\n", fileName, lineNo);
+                        ok = false;
+                    } else {
+                        glyph.columns[bbxX + x] |= 1 << y;
+                    }
+                }
+            }
+            bitmapRow++;
+        }
+    }
+    fclose(f);
+
+    font.height = ascent + descent;
+    if (font.height > 8) {
+        fprintf(stderr, "%s: fonts up to 8 pixels high are supported, this one is %d\n", fileName, font.height);
+        ok = false;
+    }
+    return ok;
+}
+
+std::string hex(const std::vector<uint8_t>& v) {
+    std::string res;
+    char buf[8];
+    for (uint8_t b : v) {
+        snprintf(buf, sizeof(buf), "%02x", b);
+        res += buf;
+    }
+    return res;
+}
+
+bool writeFont(FILE* out, const Font& font) {
+    // Unique glyphs get ids in order of their first code point
+    std::vector<uint16_t> index(0x10000, NO_GLYPH);
+    std::map<std::string, uint16_t> ids;
+    std::vector<const BdfGlyph*> unique;
+    for (const BdfGlyph& g : font.glyphs) {
+        if (g.codePoint > 0xFFFF) {
+            fprintf(stderr, "%s: U+%04X is outside of the BMP\n", font.source.c_str(), g.codePoint);
+            return false;
+        }
+        if (index[g.codePoint] != NO_GLYPH) {
+            fprintf(stderr, "%s: U+%04X is defined twice\n", font.source.c_str(), g.codePoint);
+            return false;
+        }
+        std::string key = hex(g.columns) + "/" + std::to_string(g.columns.size());
+        if (ids.find(key) == ids.end()) {
+            ids[key] = unique.size();
+            unique.push_back(&g);
+        }
+        index[g.codePoint] = ids[key];
+    }
+
+    if (unique.size() >= NONE) {
+        fprintf(stderr, "%s: %d glyphs, one byte ids hold up to %d\n", font.source.c_str(), (int)unique.size(), NONE - 1);
+        return false;
+    }
+
+    // Blocks of 16 code points, identical ones stored once; rows of 16 blocks per page
+    std::map<std::vector<uint8_t>, uint8_t> blockIds;
+    std::vector<std::vector<uint8_t> > blocks;
+    std::vector<std::vector<uint8_t> > rows;
+    std::vector<int> rowPages;
+    uint8_t pageRows[256];
+    for (int p = 0; p < 256; ++p) {
+        std::vector<uint8_t> row(16, NONE);
+        bool any = false;
+        for (int b = 0; b < 16; ++b) {
+            std::vector<uint8_t> block(16, NONE);
+            bool used = false;
+            for (int i = 0; i < 16; ++i) {
+                uint16_t g = index[p * 256 + b * 16 + i];
+                if (g != NO_GLYPH) {
+                    block[i] = g;
+                    used = true;
+                }
+            }
+            if (!used) {
+                continue;
+            }
+            if (blockIds.find(block) == blockIds.end()) {
+                blockIds[block] = blocks.size();
+                blocks.push_back(block);
+            }
+            row[b] = blockIds[block];
+            any = true;
+        }
+        pageRows[p] = NONE;
+        if (any) {
+            pageRows[p] = rows.size();
+            rows.push_back(row);
+            rowPages.push_back(p);
+        }
+    }
+    if (blocks.size() >= NONE || rows.size() >= NONE) {
+        fprintf(stderr, "%s: too many blocks for one byte ids\n", font.source.c_str());
+        return false;
+    }
+
+    // Columns start at the base of their 16 glyphs plus a byte
+    std::vector<uint16_t> bases;
+    std::vector<uint8_t> offsets;
+    size_t columnBytes = 0;
+    for (size_t g = 0; g <= unique.size(); ++g) {
+        if (g % 16 == 0) {
+            bases.push_back(columnBytes);
+        }
+        if (columnBytes - bases[g / 16] > 0xFF) {
+            fprintf(stderr, "%s: glyphs %d.. are too wide for one byte offsets\n", font.source.c_str(), (int)(g / 16 * 16));
+            return false;
+        }
+        offsets.push_back(columnBytes - bases[g / 16]);
+        if (g < unique.size()) {
+            columnBytes += unique[g]->columns.size();
+        }
+    }
+    if (columnBytes > 0xFFFF) {
+        fprintf(stderr, "%s: too many columns for 16-bit offsets\n", font.source.c_str());
+        return false;
+    }
+    size_t offsetBytes = bases.size() * sizeof(uint16_t) + offsets.size();
+    size_t indexBytes = sizeof(pageRows) + rows.size() * 16 + blocks.size() * 16;
+    size_t fixedSlotBytes = unique.size() * 9; // Width prefix + 8 columns per glyph
+
+    const char* n = font.name.c_str();
+    fprintf(out, "// %s, from %s\n", n, font.source.c_str());
+    fprintf(out, "//   %d code points, %d glyphs, %d pixels high\n", (int)font.glyphs.size(), (int)unique.size(), font.height);
+    fprintf(out, "//   %d bytes of columns, %d of offsets, %d of index (fixed 8-column slots would take %d)\n",
+        (int)columnBytes, (int)offsetBytes, (int)indexBytes, (int)fixedSlotBytes);
+    fprintf(out, "//   Coverage:");
+    for (uint32_t cp = 0; cp < 0x10000; ++cp) {
+        if (index[cp] != NO_GLYPH) {
+            uint32_t last = cp;
+            while (last + 1 < 0x10000 && index[last + 1] != NO_GLYPH) {
+                last++;
+            }
+            fprintf(out, "\n//     U+%04X..U+%04X %4d", cp, last, last - cp + 1);
+            cp = last;
+        }
+    }
+    fprintf(out, "\n\n");
+
+    fprintf(out, "const uint8_t %sPages[256] PROGMEM = {", n);
+    for (int p = 0; p < 256; ++p) {
+        fprintf(out, "%s0x%02X,", p % 16 == 0 ? "\n    " : " ", pageRows[p]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "const uint8_t %sBlocks[%d * 16] PROGMEM = {\n", n, (int)rows.size());
+    for (size_t r = 0; r < rows.size(); ++r) {
+        fprintf(out, "   ");
+        for (uint8_t b : rows[r]) {
+            fprintf(out, " 0x%02X,", b);
+        }
+        fprintf(out, " // U+%02X00\n", rowPages[r]);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const uint8_t %sIndex[%d * 16] PROGMEM = {\n", n, (int)blocks.size());
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        fprintf(out, "   ");
+        for (uint8_t g : blocks[b]) {
+            fprintf(out, " 0x%02X,", g);
+        }
+        fprintf(out, " // %d\n", (int)b);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const uint16_t %sBases[%d] PROGMEM = {", n, (int)bases.size());
+    for (size_t i = 0; i < bases.size(); ++i) {
+        fprintf(out, "%s%d,", i % 16 == 0 ? "\n    " : " ", bases[i]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "const uint8_t %sOffsets[%d] PROGMEM = {", n, (int)offsets.size());
+    for (size_t g = 0; g < offsets.size(); ++g) {
+        fprintf(out, "%s%d,", g % 16 == 0 ? "\n    " : " ", offsets[g]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "const uint8_t %sColumns[%d] PROGMEM = {\n", n, (int)std::max(columnBytes, (size_t)1));
+    for (size_t g = 0; g < unique.size(); ++g) {
+        fprintf(out, "    ");
+        for (uint8_t c : unique[g]->columns) {
+            fprintf(out, "0x%02x, ", c);
+        }
+        fprintf(out, "// %d: U+%04X\n", (int)g, unique[g]->codePoint);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const PackedFont %s = {\n", n);
+    fprintf(out, "    %sPages,\n    %sBlocks,\n    %sIndex,\n    %sBases,\n    %sOffsets,\n    %sColumns,\n", n, n, n, n, n, n);
+    fprintf(out, "    %d,\n    %d\n};\n\n", (int)unique.size(), font.height);
+
+    printf("%s: %d code points, %d glyphs, %d bytes total (%d columns + %d offsets + %d index), fixed slots: %d\n",
+        n, (int)font.glyphs.size(), (int)unique.size(), (int)(columnBytes + offsetBytes + indexBytes),
+        (int)columnBytes, (int)offsetBytes, (int)indexBytes, (int)fixedSlotBytes);
+    return true;
+}
+
+int main(int argc, char const *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s out.h fontName=font.bdf [fontName=font.bdf ...]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Font> fonts;
+    for (int i = 2; i < argc; ++i) {
+        const char* eq = strchr(argv[i], '=');
+        if (eq == NULL) {
+            fprintf(stderr, "Expected fontName=file.bdf, got %s\n", argv[i]);
+            return 1;
+        }
+        Font font;
+        font.name = std::string(argv[i], eq - argv[i]);
+        font.source = eq + 1;
+        if (!readBdf(font.source.c_str(), font)) {
+            return 1;
+        }
+        fonts.push_back(font);
+    }
+
+    FILE* out = fopen(argv[1], "w");
+    if (out == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    fprintf(out, "#pragma once\n\n");
+    fprintf(out, "// Generated by snippets/fontCompiler.cpp, don't edit by hand.\n\n");
+    fprintf(out, "#include \"packedfont.h\"\n\n");
+    for (const Font& font : fonts) {
+        if (!writeFont(out, font)) {
+            fclose(out);
+            return 1;
+        }
+    }
+    fclose(out);
+    return 0;
+}
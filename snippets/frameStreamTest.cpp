@@ -0,0 +1,222 @@
+#include "pseudo_arduino.h"
+#include "../framestream.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+typedef std::vector<uint8_t> Bytes;
+
+const size_t frameBytes = 32;   // NUM_MAX modules of 8 rows
+
+/**
+ * Frame k of a test animation: a bar running along the rows and a counter
+ */
+Bytes animationFrame(uint32_t k) {
+    Bytes f(frameBytes, 0);
+    f[(k / 8) % frameBytes] = 1 << (k % 8);
+    f[frameBytes - 1] = (uint8_t)(k / 256);
+    f[frameBytes - 2] = (uint8_t)k;
+    return f;
+}
+
+void checkRle() {
+    std::mt19937 rnd(1);
+    std::vector<Bytes> inputs = {
+        Bytes(), Bytes(1, 7), Bytes(2, 7), Bytes(300, 0), Bytes(129, 1), Bytes(130, 1),
+    };
+    Bytes noise(400);
+    for (uint8_t& b : noise) {
+        b = rnd();
+    }
+    inputs.push_back(noise);
+    Bytes mixed;
+    for (int i = 0; i < 40; ++i) {
+        mixed.insert(mixed.end(), rnd() % 20, rnd() % 3);
+        mixed.insert(mixed.end(), noise.begin(), noise.begin() + rnd() % 5);
+    }
+    inputs.push_back(mixed);
+    for (const Bytes& in : inputs) {
+        Bytes packed(in.size() * 2 + 2);
+        size_t length = FrameStream::rlePack(in.data(), in.size(), packed.data(), packed.size());
+        Bytes out(in.size() + 1);
+        size_t unpacked = FrameStream::rleUnpack(packed.data(), length, out.data(), out.size());
+        CHECK(unpacked == in.size() && std::equal(in.begin(), in.end(), out.begin()), "%u bytes come back as %u", (unsigned)in.size(), (unsigned)unpacked);
+        CHECK(length <= in.size() + (in.size() + 127) / 128, "%u bytes packed to %u", (unsigned)in.size(), (unsigned)length);
+    }
+    CHECK(FrameStream::rlePack(Bytes(300, 0).data(), 300, Bytes(4).data(), 3) == 0, "short cap");
+
+    uint8_t out[8];
+    const uint8_t pastEnd[] = { 5, 1, 2 };
+    const uint8_t runWithoutByte[] = { 130 };
+    const uint8_t tooLong[] = { 200, 0 };
+    CHECK(FrameStream::rleUnpack(pastEnd, sizeof(pastEnd), out, sizeof(out)) == 0, "literals past the end");
+    CHECK(FrameStream::rleUnpack(runWithoutByte, sizeof(runWithoutByte), out, sizeof(out)) == 0, "run without its byte");
+    CHECK(FrameStream::rleUnpack(tooLong, sizeof(tooLong), out, sizeof(out)) == 0, "more than cap");
+}
+
+/**
+ * count frames of the animation 20 ms apart through a connection that delays each
+ * by up to jitterMs but keeps them in order, as TCP does. Every keyEvery-th frame is
+ * raw, the rest are of encoding; the ones in lose never come. Runs the screen side
+ * every ms and checks each frame shown against the animation.
+ */
+FrameStream::Stats stream(FrameStream& fs, int count, uint32_t jitterMs, uint8_t encoding, int keyEvery, std::vector<int> lose = {}) {
+    std::mt19937 rnd(7);
+    const uint32_t periodMs = 20;
+    const uint32_t startMs = 0xffffff00u;   // Through the wrap of millis()
+    struct Arrival {
+        uint32_t at;
+        uint32_t seq;
+        Bytes data;
+        uint8_t encoding;
+    };
+    std::vector<Arrival> arrivals;
+    uint32_t lastAt = 0;   // From startMs
+    Bytes previous(frameBytes, 0);
+    for (int k = 0; k < count; ++k) {
+        Bytes frame = animationFrame(k);
+        uint8_t e = k % keyEvery == 0 ? (encoding & FrameStream::RLE) : encoding;
+        Bytes packed(frameBytes * 2);
+        packed.resize(FrameStream::encode(frame.data(), previous.data(), frameBytes, e, packed.data(), packed.size()));
+        previous = frame;
+        lastAt = std::max(lastAt, k * periodMs + (uint32_t)(jitterMs > 0 ? rnd() % jitterMs : 0));
+        if (std::find(lose.begin(), lose.end(), k) == lose.end()) {
+            arrivals.push_back(Arrival { startMs + lastAt, (uint32_t)k, packed, e });
+        }
+    }
+    size_t next = 0;
+    int shownK = -1;
+    bool ended = false;
+    for (uint32_t now = startMs; !ended && now != startMs + count * periodMs + 5000; ++now) {
+        while (next < arrivals.size() && arrivals[next].at == now) {
+            const Arrival& a = arrivals[next++];
+            fs.received(now, a.seq, a.seq * periodMs, a.encoding, a.data.data(), a.data.size());
+        }
+        const uint8_t* frame = fs.present(now);
+        if (frame != NULL) {
+            // Which frame of the animation it is, by the counter in it
+            int k = frame[frameBytes - 2] | frame[frameBytes - 1] << 8;
+            Bytes expected = animationFrame(k);
+            CHECK(k > shownK && std::equal(expected.begin(), expected.end(), frame), "frame %d after %d", k, shownK);
+            shownK = k;
+        }
+        ended = fs.ended(now);
+    }
+    CHECK(ended && !fs.active(), "stream ended");
+    return fs.stats();
+}
+
+void checkStream() {
+    for (uint8_t encoding = 0; encoding <= (FrameStream::XOR | FrameStream::RLE); ++encoding) {
+        FrameStream fs;
+        fs.setFrameBytes(frameBytes);
+        FrameStream::Stats s = stream(fs, 500, 40, encoding, 50);
+        CHECK(s.received == 500 && s.presented == 500 && s.dropped == 0 && s.late == 0,
+            "encoding %d: %u received, %u presented, %u dropped, %u late", encoding, s.received, s.presented, s.dropped, s.late);
+    }
+
+    // The deltas after a lost frame wait for the next raw one
+    FrameStream fs;
+    fs.setFrameBytes(frameBytes);
+    FrameStream::Stats s = stream(fs, 100, 0, FrameStream::XOR | FrameStream::RLE, 25, { 10, 60 });
+    CHECK(s.received == 98 && s.presented == 100 - 2 * 15 && s.dropped == 2 * 15 && s.late == 0,
+        "with losses: %u received, %u presented, %u dropped, %u late", s.received, s.presented, s.dropped, s.late);
+
+    // Jitter beyond the buffer makes frames late, yet they are all shown
+    fs.setFrameBytes(frameBytes);
+    s = stream(fs, 500, 200, FrameStream::RAW, 1);
+    CHECK(s.late > 0 && s.presented + s.dropped == 500, "big jitter: %u presented, %u dropped, %u late", s.presented, s.dropped, s.late);
+
+    // More than the slots at once push the oldest out
+    fs.setFrameBytes(frameBytes);
+    for (uint32_t k = 0; k < 10; ++k) {
+        Bytes f = animationFrame(k);
+        CHECK(fs.received(1000, k, k * 20, FrameStream::RAW, f.data(), f.size()), "frame %u taken", k);
+    }
+    CHECK(fs.stats().dropped == 10 - FrameStream::slots, "%u dropped of a burst", fs.stats().dropped);
+    const uint8_t* shown = fs.present(1000 + fs.jitterMs + 9 * 20);
+    CHECK(shown != NULL && shown[frameBytes - 2] == 9 && fs.stats().dropped == 9, "the newest due frame is shown, %u dropped", fs.stats().dropped);
+
+    // A raw frame 0 starts over, stale and broken ones are dropped
+    Bytes f = animationFrame(0);
+    CHECK(fs.received(2000, 0, 0, FrameStream::RAW, f.data(), f.size()) && fs.stats().received == 1, "started over");
+    CHECK(!fs.received(2001, 0, 20, FrameStream::XOR, f.data(), f.size()), "duplicate");
+    CHECK(!fs.received(2002, 1, 20, FrameStream::RAW, f.data(), f.size() - 1), "short frame");
+    CHECK(!fs.received(2003, 2, 40, FrameStream::XOR, f.data(), f.size()), "delta after a broken frame");
+    CHECK(fs.stats().dropped == 3, "%u dropped", fs.stats().dropped);
+
+    // Frames bigger than any screen aren't buffered, all of them are dropped
+    CHECK(!fs.setFrameBytes(FrameStream::maxFrameBytes + 1) && !fs.setFrameBytes(0), "no buffers for such frames");
+    CHECK(!fs.received(3000, 0, 0, FrameStream::RAW, f.data(), f.size()), "dropped without buffers");
+    CHECK(fs.setFrameBytes(FrameStream::maxFrameBytes), "the biggest screen");
+    Bytes big(FrameStream::maxFrameBytes + 1, 0x55);
+    Bytes out(big.size() * 2);
+    CHECK(FrameStream::encode(big.data(), big.data(), big.size(), FrameStream::XOR, out.data(), out.size()) == 0 &&
+        FrameStream::encode(big.data(), big.data(), FrameStream::maxFrameBytes, FrameStream::XOR | FrameStream::RLE, out.data(), out.size()) > 0,
+        "encoded up to maxFrameBytes");
+}
+
+/**
+ * Bytes per frame of the animation and of noise in each encoding, and the ns to take one in
+ */
+void bench() {
+    std::mt19937 rnd(3);
+    const char* names[] = { "raw", "XOR", "RLE", "XOR+RLE" };
+    for (int noise = 0; noise < 2; ++noise) {
+        const int n = 2000;
+        std::vector<Bytes> frames;
+        for (int k = 0; k < n; ++k) {
+            frames.push_back(animationFrame(k));
+            if (noise) {
+                for (uint8_t& b : frames.back()) {
+                    b = rnd();
+                }
+                frames.back()[frameBytes - 2] = k;
+            }
+        }
+        for (uint8_t encoding = 0; encoding < 4; ++encoding) {
+            std::vector<Bytes> packed;
+            size_t bytes = 0;
+            Bytes previous(frameBytes, 0);
+            for (const Bytes& f : frames) {
+                Bytes p(frameBytes * 2);
+                p.resize(FrameStream::encode(f.data(), previous.data(), frameBytes, encoding, p.data(), p.size()));
+                bytes += p.size();
+                packed.push_back(p);
+                previous = f;
+            }
+            uint64_t best = UINT64_MAX;
+            uint32_t sum = 0;
+            for (int attempt = 0; attempt < 5; ++attempt) {
+                FrameStream fs;
+                fs.setFrameBytes(frameBytes);
+                uint64_t t0 = micros64();
+                for (int k = 0; k < n; ++k) {
+                    fs.received(k * 20, k, k * 20, k == 0 ? (encoding & FrameStream::RLE) : encoding, packed[k].data(), packed[k].size());
+                    const uint8_t* f = fs.present(k * 20 + fs.jitterMs);
+                    sum += f != NULL ? f[k % frameBytes] : 0;
+                }
+                best = std::min(best, micros64() - t0);
+            }
+            printf("%-9s %-8s %5.1f bytes per frame, %5.1f ns to take and show one (%u)\n", noise ? "noise" : "animation", names[encoding],
+                (double)bytes / n, best * 1000.0 / n, sum & 0xff);
+        }
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    checkRle();
+    checkStream();
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("Streamed frames are shown in order and on time, losses are counted\n");
+    bench();
+    return 0;
+}
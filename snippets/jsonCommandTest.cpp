@@ -0,0 +1,116 @@
+#include "pseudo_arduino.h"
+#include "../jsoncommand.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+const char* commands[] = {
+    "ping", "switch", "setProp", "show", "tune", "unixtime", "screenEnable", "brightness",
+    "ledstripe", "playmp3", "pwm", "additional-info", "reboot",
+};
+const size_t commandCount = sizeof(commands) / sizeof(commands[0]);
+
+void checkHash() {
+    static_assert(commandHash("") == 2166136261u, "FNV-1a offset basis");
+    static_assert(commandHash("a") == 0xe40c292cu, "FNV-1a of a");
+    std::set<uint32_t> hashes;
+    for (const char* c : commands) {
+        hashes.insert(commandHash(c));
+    }
+    CHECK(hashes.size() == commandCount, "%u hashes for %u commands", (unsigned)hashes.size(), (unsigned)commandCount);
+}
+
+void checkPrescan() {
+    struct {
+        const char* text;
+        bool ok;
+    } cases[] = {
+        { "{ \"type\": \"ping\", \"pingid\": \"42\" }", true },
+        { "  {\"a\":[1,{\"b\":[]}],\"s\":\"} ] { [\"}\r\n", true },
+        { "{\"s\":\"quote \\\" and backslash \\\\\"}", true },
+        { "{\"s\":\"Погода\"}", true },
+        { "{}", true },
+        { "", false },
+        { "   ", false },
+        { "[1, 2]", false },
+        { "\"type\"", false },
+        { "{ \"type\": \"show\", oops", false },
+        { "{ \"type\": \"show\" } }", false },
+        { "{ \"type\": \"show\" } x", false },
+        { "{ \"a\": [1, 2} ]", false },
+        { "{ \"a\": { ] }", false },
+        { "{ \"s\": \"not closed }", false },
+        { "{ \"s\": \"tab\tinside\" }", false },
+        { "{\"a\":[[[[[[[[[[1]]]]]]]]]]}", false },
+        { "{\"a\":[[[[[[[[1]]]]]]]]}", true },
+    };
+    for (auto& c : cases) {
+        CHECK(looksLikeJsonObject(c.text, strlen(c.text), 10) == c.ok, "%s is %s", c.text, c.ok ? "fine" : "broken");
+    }
+    const char withZero[] = "{\"a\":\0\"b\"}";
+    CHECK(!looksLikeJsonObject(withZero, sizeof(withZero) - 1, 10), "zero byte inside");
+    const char* deep = "{\"a\":{\"b\":{\"c\":1}}}";
+    CHECK(looksLikeJsonObject(deep, strlen(deep), 3) && !looksLikeJsonObject(deep, strlen(deep), 2), "depth limit");
+}
+
+/**
+ * The dispatch of the sketch against the chain of compares it replaced, and the prescan per byte
+ */
+void bench() {
+    const int rounds = 2000000;
+    uint64_t hashUs = UINT64_MAX;
+    uint64_t chainUs = UINT64_MAX;
+    uint64_t scanUs = UINT64_MAX;
+    uint32_t sum = 0;
+    const char* text = "{ \"type\": \"show\", \"text\": \"Позвонить маме\", \"totalMsToShow\": 3000 }";
+    size_t length = strlen(text);
+    for (int attempt = 0; attempt < 5; ++attempt) {
+        uint64_t t0 = micros64();
+        for (int i = 0; i < rounds; ++i) {
+            const char* type = commands[i % commandCount];
+            switch (commandHash(type)) {
+                case commandHash("ping"): sum += strcmp(type, "ping") == 0; break;
+                case commandHash("show"): sum += strcmp(type, "show") == 0 ? 2 : 0; break;
+                case commandHash("reboot"): sum += strcmp(type, "reboot") == 0 ? 3 : 0; break;
+                case commandHash("additional-info"): sum += strcmp(type, "additional-info") == 0 ? 4 : 0; break;
+            }
+        }
+        uint64_t t1 = micros64();
+        for (int i = 0; i < rounds; ++i) {
+            std::string type = commands[i % commandCount];
+            for (size_t c = 0; c < commandCount; ++c) {
+                if (type == commands[c]) {
+                    sum += c;
+                    break;
+                }
+            }
+        }
+        uint64_t t2 = micros64();
+        for (int i = 0; i < rounds / 10; ++i) {
+            sum += looksLikeJsonObject(text, length - (i & 1), 10);
+        }
+        uint64_t t3 = micros64();
+        hashUs = std::min(hashUs, t1 - t0);
+        chainUs = std::min(chainUs, t2 - t1);
+        scanUs = std::min(scanUs, t3 - t2);
+    }
+    printf("ns per command: hashed switch %.1f, chain of compares %.1f; prescan %.2f ns per byte (%u)\n",
+        hashUs * 1000.0 / rounds, chainUs * 1000.0 / rounds, scanUs * 1000.0 / (rounds / 10) / length, sum & 0xff);
+}
+
+int main(int argc, char const *argv[]) {
+    checkHash();
+    checkPrescan();
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("Command hashes are distinct, the prescan tells broken messages\n");
+    bench();
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "pseudo_arduino.h"
+#include "../jsonwriter.h"
+
+#include <algorithm>
+#include <string>
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+char buf[256];
+
+void checkMessages() {
+    JsonWriter w(buf, sizeof(buf));
+    w.beginObject().field("type", "relayState").field("id", 3u).field("value", true).endObject();
+    CHECK(std::string(w.c_str()) == "{\"type\":\"relayState\",\"id\":3,\"value\":true}", "%s", w.c_str());
+    CHECK(w.length() == strlen(w.c_str()) && !w.overflowed(), "length %u", (unsigned)w.length());
+
+    w.reset();
+    w.beginObject().field("type", "hello").beginObject("devParams").field("screen", "true").field("tz", "MSK-3").endObject()
+        .beginObject("empty").endObject().field("screenEnabled", 1).endObject();
+    CHECK(std::string(w.c_str()) == "{\"type\":\"hello\",\"devParams\":{\"screen\":\"true\",\"tz\":\"MSK-3\"},\"empty\":{},\"screenEnabled\":1}",
+        "%s", w.c_str());
+
+    w.reset();
+    w.beginObject().field("type", "telemetry").beginArray("samples").beginObject().field("type", "temp").endObject()
+        .beginObject().field("type", "weight").endObject().endArray().beginArray("empty").endArray().field("timeseq", 5).endObject();
+    CHECK(std::string(w.c_str()) == "{\"type\":\"telemetry\",\"samples\":[{\"type\":\"temp\"},{\"type\":\"weight\"}],\"empty\":[],\"timeseq\":5}",
+        "%s", w.c_str());
+}
+
+void checkEscaping() {
+    JsonWriter w(buf, sizeof(buf));
+    w.value("a\"b\\c\nd\re\tf\x01g\x1fh/ Погода");
+    CHECK(std::string(w.c_str()) == "\"a\\\"b\\\\c\\nd\\re\\tf\\u0001g\\u001fh/ Погода\"", "%s", w.c_str());
+    w.reset();
+    w.beginObject().field("ke\"y", "").endObject();
+    CHECK(std::string(w.c_str()) == "{\"ke\\\"y\":\"\"}", "%s", w.c_str());
+}
+
+void checkNumbers() {
+    struct {
+        double v;
+        int digits;
+        const char* text;
+    } doubles[] = {
+        { 21.5, 2, "21.50" },
+        { -0.125, 2, "-0.13" },
+        { 0.004, 2, "0.00" },
+        { 101325.37, 2, "101325.37" },
+        { 9.999, 2, "10.00" },
+        { 3.7, 0, "4" },
+        { 1.0 / 3, 4, "0.3333" },
+        { NAN, 2, "null" },
+        { INFINITY, 2, "null" },
+        { -INFINITY, 2, "null" },
+        { 1e30, 2, "null" },
+    };
+    for (auto& d : doubles) {
+        JsonWriter w(buf, sizeof(buf));
+        w.value(d.v, d.digits);
+        CHECK(std::string(w.c_str()) == d.text, "%g with %d digits is %s, not %s", d.v, d.digits, w.c_str(), d.text);
+    }
+
+    JsonWriter w(buf, sizeof(buf));
+    w.beginObject().field("a", 0).field("b", -1).field("c", INT32_MIN).field("d", UINT32_MAX).field("e", (long long)INT64_MIN)
+        .field("f", (unsigned long long)UINT64_MAX).field("g", false).endObject();
+    CHECK(std::string(w.c_str()) == "{\"a\":0,\"b\":-1,\"c\":-2147483648,\"d\":4294967295,\"e\":-9223372036854775808,"
+        "\"f\":18446744073709551615,\"g\":false}", "%s", w.c_str());
+}
+
+void checkOverflow() {
+    char small[16];
+    memset(small, 'x', sizeof(small));
+    JsonWriter w(small, 12);
+    w.beginObject().field("type", "relayState").endObject();
+    CHECK(w.overflowed(), "overflow noticed");
+    CHECK(w.length() == 11 && strlen(w.c_str()) == 11 && small[12] == 'x', "cut at the capacity: %s", small);
+    w.reset();
+    w.beginObject().field("a", 1).endObject();
+    CHECK(!w.overflowed() && std::string(w.c_str()) == "{\"a\":1}", "reset clears it: %s", small);
+}
+
+void checkRewind() {
+    char small[24];
+    JsonWriter w(small, sizeof(small));
+    w.beginObject().field("a", 1);
+    JsonWriter::Mark m = w.mark();
+    w.field("long", "does not fit the buffer");
+    CHECK(w.overflowed(), "overflow");
+    w.rewind(m);
+    w.field("b", 2).endObject();
+    CHECK(!w.overflowed() && std::string(w.c_str()) == "{\"a\":1,\"b\":2}", "rewound: %s", w.c_str());
+}
+
+/**
+ * A clockStats message the way the sketch writes it, against std::string concatenation
+ */
+void bench() {
+    const int n = 200000;
+    uint64_t writerUs = UINT64_MAX;
+    uint64_t concatUs = UINT64_MAX;
+    size_t sum = 0;
+    for (int attempt = 0; attempt < 5; ++attempt) {
+        uint64_t t0 = micros64();
+        for (int i = 0; i < n; ++i) {
+            JsonWriter w(buf, sizeof(buf));
+            w.beginObject().field("type", "clockStats").field("source", "NTP").field("offsetUs", -1234 + i % 7)
+                .field("skewPpb", 15200).field("jitterUs", 840).field("pollS", 1024u).field("steps", 1u).endObject();
+            sum += w.length();
+        }
+        uint64_t t1 = micros64();
+        for (int i = 0; i < n; ++i) {
+            std::string s = std::string("{ \"type\": \"clockStats\", ") + "\"source\": \"" + "NTP" + "\", " +
+                "\"offsetUs\": " + std::to_string(-1234 + i % 7) + ", " + "\"skewPpb\": " + std::to_string(15200) + ", " +
+                "\"jitterUs\": " + std::to_string(840) + ", " + "\"pollS\": " + std::to_string(1024) + ", " +
+                "\"steps\": " + std::to_string(1) + " " + "}";
+            sum += s.length();
+        }
+        uint64_t t2 = micros64();
+        writerUs = std::min(writerUs, t1 - t0);
+        concatUs = std::min(concatUs, t2 - t1);
+    }
+    printf("ns per clockStats message: JsonWriter %.1f, string concatenation %.1f (%u)\n",
+        writerUs * 1000.0 / n, concatUs * 1000.0 / n, (unsigned)(sum & 0xff));
+}
+
+int main(int argc, char const *argv[]) {
+    checkMessages();
+    checkEscaping();
+    checkNumbers();
+    checkOverflow();
+    checkRewind();
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("JsonWriter writes and escapes as JSON wants it\n");
+    bench();
+    return 0;
+}
@@ -1,8 +1,253 @@
 #include "pseudo_arduino.h"
 
 #include "../lcd.h"
+#include "../renderscheduler.h"
+#include "recordingtransport.h"
+
+/**
+ * Old renderer: one bounds-checked set() per glyph pixel. Kept here to compare against.
+ */
+int printStrPerPixel(LcdScreen& screen, int _x, int _y, WSTR str) {
+    int w = 0;
+    for (int i=0; str[i] != 0; ++i) {
+        Glyph glyph;
+        if (glyphOf(str[i], glyph)) {
+            int symbolW = glyph.width;
+            for (int x = 0; x < symbolW; ++x) {
+                uint8_t data = glyph.column(x);
+                for (int y = 0; y < 8; ++y) {
+                    screen.set(_x - w - x, y + _y, (data >> y) & 1);
+                }
+            }
+            w += symbolW + 1;
+        }
+    }
+    return w;
+}
+
+/**
+ * Renders every frame of a rolling message with both renderers, checks they are
+ * pixel-exact and prints per-frame cost.
+ */
+int bench() {
+    const WSTR msg = L"Hello, it is a very-very-very-very long line. Погода: ясно, ветер 3 м/с";
+    LcdScreen a;
+    LcdScreen b;
+    int strW = a.getStrWidth(msg);
+    int frames = strW + a.width();
+    const int rounds = 200;
+
+    for (int y = -3; y <= 3; ++y) {
+        for (int x = 0; x < frames; ++x) {
+            a.clear();
+            b.clear();
+            printStrPerPixel(a, x, y, msg);
+            b.printStr(x, y, msg);
+            for (int i = 0; i < a.width() * a.height(); ++i) {
+                if (a.get(i % a.width(), i / a.width()) != b.get(i % a.width(), i / a.width())) {
+                    printf("MISMATCH at frame x=%d y=%d\n", x, y);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    uint64_t t0 = micros64();
+    for (int r = 0; r < rounds; ++r) {
+        for (int x = 0; x < frames; ++x) {
+            a.clear();
+            printStrPerPixel(a, x, 0, msg);
+        }
+    }
+    uint64_t t1 = micros64();
+    for (int r = 0; r < rounds; ++r) {
+        for (int x = 0; x < frames; ++x) {
+            b.clear();
+            b.printStr(x, 0, msg);
+        }
+    }
+    uint64_t t2 = micros64();
+
+    FixedMsg<256, 1536> strip;
+    strip.set(&msg, 1);
+    if (strip.width() != strW) {
+        printf("MISMATCH strip width %d != %d\n", strip.width(), strW);
+        return 1;
+    }
+    for (int x = 0; x < frames; ++x) {
+        b.clear();
+        a.clear();
+        a.printStr(x, 0, msg);
+        b.printStrip(x, 0, strip);
+        for (int i = 0; i < a.width() / 8 * a.height(); ++i) {
+            if (a.line8(i) != b.line8(i)) {
+                printf("MISMATCH strip at frame x=%d\n", x);
+                return 1;
+            }
+        }
+    }
+
+    // Nothing to draw is drawn as nothing, whatever the strip held before
+    strip.set("8888", 0);
+    strip.set("", 0);
+    for (int x = -8; x < 16; ++x) {
+        b.clear();
+        b.printStrip(x, 0, strip);
+        for (int i = 0; i < b.bufferSize(); ++i) {
+            if (b.line8(i) != 0) {
+                printf("MISMATCH empty strip at frame x=%d\n", x);
+                return 1;
+            }
+        }
+    }
+    strip.set(&msg, 1);
+
+    uint64_t t3 = micros64();
+    for (int r = 0; r < rounds; ++r) {
+        for (int x = 0; x < frames; ++x) {
+            b.clear();
+            b.printStrip(x, 0, strip);
+        }
+    }
+    uint64_t t4 = micros64();
+
+    double total = (double)rounds * frames;
+    printf("String width %d px, %d frames x %d rounds\n", strW, frames, rounds);
+    printf("per-pixel set(): %8.3f us/frame\n", (t1 - t0) / total);
+    printf("column blit:     %8.3f us/frame\n", (t2 - t1) / total);
+    printf("scroll strip:    %8.3f us/frame\n", (t4 - t3) / total);
+    // A static object on the ESP8266, what it takes comes off the free heap
+    printf("LcdScreen:       %8u bytes\n", (unsigned)sizeof(LcdScreen));
+    return 0;
+}
+
+/**
+ * Render and transfer cost of long and stacked panels: the clock face and a full
+ * scroll of a message, then composing chip rows and shifting out what changed.
+ */
+int benchPanels() {
+    const WSTR msg = L"Hello, it is a very-very-very-very long line. Погода: ясно, ветер 3 м/с";
+    const int geometries[][2] = { {4, 1}, {16, 1}, {32, 1}, {16, 2} };
+    const int frames = 3000; // 20 ms apart, as the main loop refreshes
+
+    printf("modules | clock face  | scroll      | compose     | bytes/frame      | wire time at 1 MHz\n");
+    printf("        | us/frame    | us/frame    | us/frame    | full   changed   | full      changed\n");
+    for (const int* g : geometries) {
+        LcdScreen screen(g[0], g[1]);
+        screen._showDay = false;
+        RecordingTransport transport(false);
+        MAX72xx controller(screen, transport, MAX72xx::ROTATE_180, false, MAX72xx::CHAIN_SNAKE);
+        uint8_t* frame = new uint8_t[controller.modules() * 8];
+        uint32_t sum = 0;
+
+        uint64_t t0 = micros64();
+        for (int f = 0; f < frames; ++f) {
+            screen.showTime(17000, 12 * 3600000 + f * 20);
+            sum += screen.line8(f % screen.bufferSize());
+        }
+        uint64_t t1 = micros64();
+
+        FixedMsg<256, 1536> strip;
+        strip.set(&msg, 1);
+        int scrollFrames = strip.width() + screen.width();
+        for (int x = 0; x < scrollFrames; ++x) {
+            screen.clear();
+            screen.printStrip(x, screen.textY(), strip);
+            sum += screen.line8(x % screen.bufferSize());
+        }
+        uint64_t t2 = micros64();
+
+        for (int f = 0; f < frames; ++f) {
+            screen.set(f % screen.width(), f % screen.height(), f & 1);
+            controller.composeLines(frame);
+            sum += frame[f % (controller.modules() * 8)];
+        }
+        uint64_t t3 = micros64();
+
+        // The first refresh sends the init sequence and every row, the rest only changes
+        controller.refreshAll();
+        uint32_t fullBytes = controller.bytesSent();
+        for (int f = 0; f < frames; ++f) {
+            screen.showTime(17000, 12 * 3600000 + f * 20);
+            controller.refreshAll();
+        }
+        double changedBytes = (double)(controller.bytesSent() - fullBytes) / frames;
+
+        printf("%3dx%d   | %9.3f   | %9.3f   | %9.3f   | %5u  %8.1f  | %6.0f us %6.0f us   (%u)\n",
+            g[0], g[1],
+            (double)(t1 - t0) / frames, (double)(t2 - t1) / scrollFrames, (double)(t3 - t2) / frames,
+            fullBytes, changedBytes, fullBytes * 8.0, changedBytes * 8.0, sum);
+        delete[] frame;
+    }
+    return 0;
+}
+
+/**
+ * Runs showTime through a simulated timeline twice: every ms as the reference, and
+ * only on RenderScheduler deadlines. The scheduled picture must never be stale.
+ */
+int checkSchedule(int modulesWide, int modulesHigh) {
+    LcdScreen reference(modulesWide, modulesHigh);
+    LcdScreen scheduled(modulesWide, modulesHigh);
+    RenderScheduler scheduler(20, 1000);
+    const uint32_t faceStartMs = 12 * 3600000 + 17321;
+    const uint32_t durationMs = 5 * 60000;
+    uint32_t stale = 0;
+    printf("%dx%d panel\n", modulesWide, modulesHigh);
+    for (uint32_t t = 0; t <= durationMs; ++t) {
+        pseudoMicros = (uint64_t)(t + 5000) * 1000;
+        uint32_t now = millis();
+        uint32_t faceMs = faceStartMs + t;
+        if (t == 20000 || t == 150000) {
+            reference.showMessage("Hello, it is a very-very-very-very long line", t == 20000 ? 0 : 9000);
+            scheduled.showMessage("Hello, it is a very-very-very-very long line", t == 20000 ? 0 : 9000);
+            scheduler.invalidate();
+        }
+        if (t == 100000) {
+            reference.showTuningMsg("Тест");
+            scheduled.showTuningMsg("Тест");
+            scheduler.invalidate();
+        }
+
+        reference.clear();
+        reference.showTime(17000, faceMs);
+        if (scheduler.due(now)) {
+            scheduled.clear();
+            scheduled.showTime(17000, faceMs);
+            scheduler.rendered(now, scheduled.msToNextChange(faceMs));
+        }
+        for (int i = 0; i < reference.bufferSize(); ++i) {
+            if (reference.line8(i) != scheduled.line8(i)) {
+                if (stale++ < 10) {
+                    printf("STALE at t=%u ms\n", t);
+                }
+                break;
+            }
+        }
+        if (scheduler.statsWindowPassed(now) && t > 0) {
+            printf("  minute %u: %u frames rendered, %u of 20 ms polls skipped\n", 
+                t / 60000, scheduler.rendered(), scheduler.skipped());
+        }
+    }
+    pseudoMicros = -1;
+    if (stale > 0) {
+        printf("%u stale ms\n", stale);
+        return 1;
+    }
+    return 0;
+}
 
 int main(int argc, char const *argv[]) {   
+    if (argc > 1 && std::string(argv[1]) == "schedule") {
+        return checkSchedule(4, 1) + checkSchedule(16, 2);
+    }
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        return bench();
+    }
+    if (argc > 1 && std::string(argv[1]) == "panels") {
+        return benchPanels();
+    }
+
     if (!cur_term) {
         int result;
         setupterm( NULL, STDOUT_FILENO, &result );
@@ -11,9 +256,10 @@ int main(int argc, char const *argv[]) {
   
     putp(tigetstr((char *)"clear"));
 
-    LcdScreen screen;
+    // lcdtest [modules wide] [modules high]
+    LcdScreen screen(argc > 1 ? atoi(argv[1]) : NUM_MAX, argc > 2 ? atoi(argv[2]) : 1);
     screen._showDay = false;
-    screen.showMessage("Hello, it is a very-very-very-very long line");
+    screen.showMessage("Hello, it is a very-very-very-very long line", 0);
 
     // screen.showMessage("ЁЁЁёёёЁЁЁёёё!");
 
@@ -21,7 +267,7 @@ int main(int argc, char const *argv[]) {
         // Move cursor to top left
         putp( tparm( tigetstr((char *)"cup" ), 0, 0, 0, 0, 0, 0, 0, 0, 0 ) );
         if (ii == 100) {
-            screen.showMessage("Another string");
+            screen.showMessage("Another string", 0);
         }
         
         screen.clear();
@@ -36,7 +282,7 @@ int main(int argc, char const *argv[]) {
         /////////////////////////////////////////////////////////
         // OUT!
        
-        for (int y = 0; y < 8; ++y) {
+        for (int y = 0; y < screen.height(); ++y) {
             for (int cnt = 0; cnt < 2; ++cnt) {
                 printf("%01d |", y);
                 for (int x = 0; x < screen.width(); ++x) {
@@ -47,7 +293,7 @@ int main(int argc, char const *argv[]) {
         }
 
         printf("  |");
-        for (int x = 0; x < NUM_MAX*8; ++x) {
+        for (int x = 0; x < screen.width(); ++x) {
             printf("%02d |", screen.width() - 1 - x);
         }
 
@@ -0,0 +1,201 @@
+/**
+ * Months of the sketch in seconds: the emulator fast-forwards through idle time,
+ * so the millis() wrap at 49.7 days, the 24.8 days where signed comparisons of
+ * millis() turn, midnights and a DST change all pass by. At checkpoints it draws
+ * every frame and compares the screen with the golden frames below.
+ * longRunTest update prints the frames for pasting once a change is checked by eye.
+ */
+#include "../MyWiFiClock.ino"
+#include "emulator/harness.h"
+
+#include <string>
+#include <vector>
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+const uint64_t secondUs = 1000000;
+const uint64_t dayUs = 86400 * secondUs;
+// millis() turns negative as int32_t, and wraps to 0
+const uint64_t millisSignUs = 0x80000000ull * 1000;
+const uint64_t millisWrapUs = 0x100000000ull * 1000;
+
+const uint64_t runUs = 100 * dayUs + 20 * secondUs;
+const uint64_t strideUs = 10 * secondUs;
+// Frames are followed that long before a checkpoint
+const uint64_t leadUs = 2 * secondUs;
+
+emulator::Device device;
+
+/**
+ * Uptime when the true UTC time is unixS
+ */
+uint64_t uptimeAt(int64_t unixS) {
+    return unixS * secondUs - emulator::trueUnixStartUs;
+}
+
+struct Golden {
+    const char* name;
+    uint64_t atUs;
+    const char* frame;
+};
+
+// Kyiv time, EET and EEST from 2026-03-29 01:00 UTC
+const Golden goldens[] = {
+    { "synced", 30 * secondUs + 500000,
+        "..#.....#.....###...###....#..#.\n"
+        ".##....##....#...#.#...#.###.###\n"
+        "#.#...#.#....#...#.#...#........\n"
+        "..#.....#....#...#.#...#.###.###\n"
+        "..#.....#....#...#.#...#...#.#.#\n"
+        "..#.....#....#...#.#...#.###.#.#\n"
+        "..#.....#....#...#.#...#...#.#.#\n"
+        "#####.#####...###...###..###.###\n"
+    },
+    { "first midnight", uptimeAt(1772402400) + 500000,
+        ".###...###....###...###..#.#..#.\n"
+        "#...#.#...#..#...#.#...#.###.###\n"
+        "#...#.#...#..#...#.#...#........\n"
+        "#...#.#...#..#...#.#...#.###.###\n"
+        "#...#.#...#..#...#.#...#.#.#.#.#\n"
+        "#...#.#...#..#...#.#...#.#.#.#.#\n"
+        "#...#.#...#..#...#.#...#.#.#.#.#\n"
+        ".###...###....###...###..###.###\n"
+    },
+    { "date banner", uptimeAt(1772439357),
+        "##..............................\n"
+        "..#.............................\n"
+        "..#....#...#..###..####..#####..\n"
+        "##.....##.##.....#.#...#.#.#.#..\n"
+        ".......#.#.#..####.#...#...#....\n"
+        ".......#...#.#...#.####....#...#\n"
+        "###....#...#..####.#.......#....\n"
+        "...................#............\n"
+    },
+    { "message across millis() sign", millisSignUs + 500000,
+        "................................\n"
+        "................................\n"
+        "....###.#...#..###..#...#.#.....\n"
+        "#..#..#.#...#.#...#.#...#.#.....\n"
+        "#..#..#.#####.#...#..####.####..\n"
+        "#..#..#.#...#.#...#.....#.#...#.\n"
+        "..#...#.#...#..###......#.####..\n"
+        "................................\n"
+    },
+    { "DST begins", uptimeAt(1774746020),
+        ".###......#...###...###..#....#.\n"
+        "#...#....##..#...#.#...#.###.###\n"
+        "#...#...#.#..#...#.#...#........\n"
+        "#...#..#..#..#...#.#...#.###.###\n"
+        "#...#.#####..#...#.#...#...#.#.#\n"
+        "#...#.....#..#...#.#...#.###.#.#\n"
+        "#...#.....#..#...#.#...#.#...#.#\n"
+        ".###......#...###...###..###.###\n"
+    },
+    { "before millis() wrap", millisWrapUs - 300000,
+        ".###..#####...###...###....#.#.#\n"
+        "#...#.#......#...#.#...#...#.###\n"
+        "#...#.#......#...#.....#........\n"
+        "#...#.####...#...#....#..#.#.###\n"
+        "#...#.....#..#...#...#...#.#...#\n"
+        "#...#.....#..#...#..#....###...#\n"
+        "#...#.#...#..#...#.#.......#...#\n"
+        ".###...###....###..#####...#...#\n"
+    },
+    { "after millis() wrap", millisWrapUs + 700000,
+        ".###..#####...###...###....#...#\n"
+        "#...#.#......#...#.#...#...#.###\n"
+        "#...#.#......#...#.....#........\n"
+        "#...#.####...#...#....#..#.#.###\n"
+        "#...#.....#..#...#...#...#.#.#.#\n"
+        "#...#.....#..#...#..#....###.###\n"
+        "#...#.#...#..#...#.#.......#.#.#\n"
+        ".###...###....###..#####...#.###\n"
+    },
+    { "date banner after wrap", uptimeAt(1776677697),
+        "##...###........................\n"
+        "..#.#...#.......................\n"
+        "..#.#..##.....###..#####.####...\n"
+        "##..#.#.#........#.#...#.#...#.#\n"
+        "....##..#.....####.#...#.#...#.#\n"
+        "....#...#....#...#.#...#.####..#\n"
+        "###..###......####.#...#.#......\n"
+        ".........................#......\n"
+    },
+    { "end", runUs,
+        "..#....###....###...###..#....#.\n"
+        ".##...#...#..#...#.#...#.###.###\n"
+        "#.#.......#..#...#.#...#........\n"
+        "..#......#...#...#.#...#.###.###\n"
+        "..#.....#....#...#.#...#...#.#.#\n"
+        "..#....#.....#...#.#...#.###.#.#\n"
+        "..#...#......#...#.#...#.#...#.#\n"
+        "#####.#####...###...###..###.###\n"
+    },
+};
+
+int main(int argc, char const *argv[]) {
+    bool update = argc > 1 && std::string(argv[1]) == "update";
+    emulator::writeSettings({
+        { "screen", "true" },
+        { "ws", "server.local" },
+        { "tz", "EET-2EEST,M3.5.0/3,M10.5.0/4" },
+        { "ntp", "pool.ntp.org" },
+    });
+    device.boot();
+    // Connecting and the first sync pass by at full detail
+    device.run(20 * secondUs);
+
+    uint64_t t0 = emulator::hostNs();
+    uint32_t brightnessSent = 0;
+    uint32_t writes0 = SPIFFS.writes;
+    uint64_t nextBrightnessUs = dayUs / 2;
+    uint64_t messageUs = millisSignUs - 3 * secondUs;
+    for (const Golden& g : goldens) {
+        // What the server does meanwhile: the brightness once a day, which is saved a second
+        // later, and a message shortly before millis() turns negative that rolls on past it
+        for (uint64_t next; (next = std::min(nextBrightnessUs, messageUs)) < g.atUs - leadUs;) {
+            device.fastForward(next, strideUs);
+            if (next == messageUs) {
+                device.server.push("{ \"type\": \"show\", \"text\": \"Через полночь\", \"totalMsToShow\": 8000 }", 0);
+                messageUs = UINT64_MAX;
+            } else {
+                device.server.push("{ \"type\": \"brightness\", \"value\": " + std::to_string(10 + brightnessSent % 50) + " }", 0);
+                brightnessSent++;
+                nextBrightnessUs += dayUs;
+            }
+        }
+        device.fastForward(g.atUs - leadUs, strideUs);
+        device.fastForward(g.atUs, strideUs, true);
+        std::string frame = device.frame();
+        if (update) {
+            printf("    { \"%s\", ...,\n", g.name);
+            for (size_t from = 0; from < frame.size(); from = frame.find('\n', from) + 1) {
+                printf("        \"%s\\n\"\n", frame.substr(from, frame.find('\n', from) - from).c_str());
+            }
+            printf("    },\n");
+        } else {
+            CHECK(frame == g.frame, "%s at %.3f s differs:\n%s", g.name, g.atUs / 1e6, frame.c_str());
+        }
+    }
+    double wallS = (emulator::hostNs() - t0) / 1e9;
+
+    CHECK(emulator::resets == 0, "%u resets", emulator::resets);
+    CHECK(device.server.connects == 1, "%u connects to the server", device.server.connects);
+    CHECK(device.server.invalid == 0, "%u messages are no JSON", device.server.invalid);
+    CHECK(SPIFFS.writes - writes0 == brightnessSent, "%u brightness changes saved %u times", brightnessSent, SPIFFS.writes - writes0);
+    int64_t error = deviceClock.unixUs() - emulator::trueUnixUs();
+    CHECK(llabs(error) < 5000, "clock is off by %lld us after %.0f days", (long long)error, emulator::nowUs / 1e6 / 86400);
+    CHECK(device.server.byType["pingresult"] == device.server.pings, "%u pings, %u answers",
+        device.server.pings, device.server.byType["pingresult"]);
+
+    printf("%.1f days simulated in %.2f s: %.0f simulated seconds per wall second\n",
+        emulator::nowUs / 1e6 / 86400, wallS, emulator::nowUs / 1e6 / wallS);
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("Months on the emulator match the golden frames\n");
+    return 0;
+}
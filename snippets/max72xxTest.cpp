@@ -0,0 +1,200 @@
+#include "pseudo_arduino.h"
+
+#include "../lcd.h"
+#include "recordingtransport.h"
+
+/**
+ * What a daisy chain of MAX7219 does with the bytes: every chip is a 16 bit shift
+ * register feeding the next one, on the CS rising edge each chip runs its pair.
+ */
+class ChainModel {
+public:
+    int chips;
+    std::vector<uint8_t> shift;   // shift[2 * chip] is data, shift[2 * chip + 1] opcode
+    std::vector<uint8_t> digits;  // chip * 8 + digit
+    std::vector<uint8_t> regs;    // chip * 16 + opcode, for the control registers
+    std::vector<int> writes;      // Non-NOOP pairs each chip got
+
+    ChainModel(int _chips) :
+            chips(_chips),
+            shift(_chips * 2, 0),
+            digits(_chips * 8, 0),
+            regs(_chips * 16, 0xff),
+            writes(_chips, 0) {
+    }
+
+    void latch(const std::vector<uint8_t>& bytes) {
+        for (uint8_t b : bytes) {
+            shift.insert(shift.begin(), b);
+            shift.pop_back();
+        }
+        for (int chip = 0; chip < chips; ++chip) {
+            uint8_t op = shift[chip * 2 + 1];
+            uint8_t data = shift[chip * 2];
+            if (op == OP_NOOP) {
+                continue;
+            }
+            writes[chip]++;
+            if (op >= OP_DIGIT0 && op <= OP_DIGIT7) {
+                digits[chip * 8 + op - OP_DIGIT0] = data;
+            } else {
+                regs[chip * 16 + (op & 15)] = data;
+            }
+        }
+    }
+};
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+/**
+ * Plays latches recorded since `from` into the model
+ */
+int play(ChainModel& model, RecordingTransport& transport, size_t from) {
+    for (size_t i = from; i < transport.latches.size(); ++i) {
+        model.latch(transport.latches[i]);
+    }
+    return transport.latches.size() - from;
+}
+
+void checkShows(ChainModel& model, MAX72xx& controller, const char* what) {
+    std::vector<uint8_t> expected(controller.modules() * 8);
+    controller.composeLines(expected.data());
+    for (int chip = 0; chip < controller.modules(); ++chip) {
+        for (int line = 0; line < 8; ++line) {
+            CHECK(model.digits[chip * 8 + line] == expected[chip * 8 + line],
+                "%s: chip %d digit %d shows %02x instead of %02x",
+                what, chip, line, model.digits[chip * 8 + line], expected[chip * 8 + line]);
+        }
+    }
+}
+
+void checkProtocol(int modulesWide, int modulesHigh, MAX72xx::Orientation orientation, MAX72xx::ChainOrder order) {
+    LcdScreen screen(modulesWide, modulesHigh);
+    RecordingTransport transport;
+    MAX72xx controller(screen, transport, orientation, false, order);
+    int chips = controller.modules();
+    ChainModel model(chips);
+
+    pseudoMicros = 1000000;
+    controller.setup();
+    screen.printStr(screen.width() - 1, 0, L"Тест 12:34");
+
+    // First refresh: the init sequence, then every digit row, a pair per chip each
+    controller.refreshAll();
+    CHECK(transport.latches.size() == 4 + 8, "first refresh sent %d latches", (int)transport.latches.size());
+    for (size_t i = 0; i < transport.latches.size(); ++i) {
+        CHECK(transport.latches[i].size() == (size_t)chips * 2, "latch %d is %d bytes", (int)i, (int)transport.latches[i].size());
+    }
+    play(model, transport, 0);
+    for (int chip = 0; chip < chips; ++chip) {
+        CHECK(model.regs[chip * 16 + OP_DISPLAYTEST] == 0, "chip %d display test", chip);
+        CHECK(model.regs[chip * 16 + OP_SCANLIMIT] == 7, "chip %d scan limit", chip);
+        CHECK(model.regs[chip * 16 + OP_DECODEMODE] == 0, "chip %d decode mode", chip);
+        CHECK(model.regs[chip * 16 + OP_SHUTDOWN] == 1, "chip %d shutdown", chip);
+    }
+    checkShows(model, controller, "after the first refresh");
+
+    // Nothing changed: nothing is sent
+    size_t mark = transport.latches.size();
+    pseudoMicros += 20000;
+    controller.refreshAll();
+    CHECK(transport.latches.size() == mark, "unchanged screen sent %d latches", (int)(transport.latches.size() - mark));
+
+    // Random changes: only changed rows go out, and the chain ends up showing the screen
+    srand(modulesWide * 100 + modulesHigh * 10 + orientation);
+    for (int round = 0; round < 200; ++round) {
+        pseudoMicros += 20000;
+        int n = rand() % 4;
+        for (int i = 0; i < n; ++i) {
+            screen.invert(rand() % screen.width(), rand() % screen.height());
+        }
+        std::vector<uint8_t> before(chips * 8);
+        controller.composeLines(before.data());
+        mark = transport.latches.size();
+        controller.refreshAll();
+        int sent = play(model, transport, mark);
+        CHECK(sent <= 8 || (sent == 12), "round %d sent %d latches", round, sent);
+        checkShows(model, controller, "after a partial refresh");
+    }
+
+    // Once per fullRefreshPeriodMs everything is sent again
+    pseudoMicros += MAX72xx::fullRefreshPeriodMs * 1000;
+    mark = transport.latches.size();
+    controller.refreshAll();
+    CHECK(play(model, transport, mark) == 12, "periodic full refresh");
+
+    // Commands for one chip leave the rest alone
+    std::fill(model.writes.begin(), model.writes.end(), 0);
+    mark = transport.latches.size();
+    controller.sendCmd(chips - 1, OP_INTENSITY, 7);
+    play(model, transport, mark);
+    for (int chip = 0; chip < chips; ++chip) {
+        CHECK(model.writes[chip] == (chip == chips - 1 ? 1 : 0), "sendCmd reached chip %d", chip);
+    }
+    CHECK(model.regs[(chips - 1) * 16 + OP_INTENSITY] == 7, "intensity of the last chip");
+
+    mark = transport.latches.size();
+    controller.setBrightness(100);
+    play(model, transport, mark);
+    for (int chip = 0; chip < chips; ++chip) {
+        CHECK(model.regs[chip * 16 + OP_INTENSITY] == 15, "chip %d brightness", chip);
+    }
+    CHECK(controller.bytesSent() == transport.bytes, "bytesSent %u, on the wire %u", controller.bytesSent(), transport.bytes);
+    pseudoMicros = -1;
+}
+
+/**
+ * Bytes per frame of the clock face, as the main loop drives it
+ */
+void measure(int modulesWide, int modulesHigh) {
+    LcdScreen screen(modulesWide, modulesHigh);
+    screen._showDay = false;
+    RecordingTransport transport(false);
+    MAX72xx controller(screen, transport, MAX72xx::ROTATE_180);
+    const int frames = 3000;
+
+    pseudoMicros = 1000000;
+    controller.refreshAll();
+    uint32_t first = transport.bytes;
+    for (int f = 0; f < frames; ++f) {
+        pseudoMicros += 20000;
+        screen.clear();
+        screen.showTime(17000, 12 * 3600000 + f * 20);
+        controller.refreshAll();
+    }
+    pseudoMicros = -1;
+    printf("%3dx%d: %5u bytes full frame, %7.1f bytes/frame on average over %d s of clock face\n",
+        modulesWide, modulesHigh, first, (double)(transport.bytes - first) / frames, frames / 50);
+}
+
+int main(int argc, char const *argv[]) {
+    const MAX72xx::Orientation orientations[] = {
+        MAX72xx::ROTATE_0, MAX72xx::ROTATE_90, MAX72xx::ROTATE_180, MAX72xx::ROTATE_270
+    };
+    const int geometries[][2] = { {4, 1}, {1, 1}, {16, 1}, {8, 2} };
+    for (const int* g : geometries) {
+        for (MAX72xx::Orientation o : orientations) {
+            checkProtocol(g[0], g[1], o, MAX72xx::CHAIN_ROWS);
+            checkProtocol(g[0], g[1], o, MAX72xx::CHAIN_SNAKE);
+        }
+    }
+
+    // A panel bigger than the framebuffer may be is refused, the one before stays
+    LcdScreen screen;
+    CHECK(!screen.setGeometry(LcdScreen::maxModules + 1, 1) && !screen.setGeometry(16, 5) && screen.modulesWide() == NUM_MAX &&
+        screen.modulesHigh() == 1, "too big a panel is %dx%d", screen.modulesWide(), screen.modulesHigh());
+    CHECK(screen.setGeometry(16, 4) && screen.bufferSize() == LcdScreen::maxModules * 8, "the biggest panel");
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("Wire protocol matches the chain model\n");
+
+    measure(4, 1);
+    measure(16, 1);
+    measure(32, 1);
+    measure(16, 2);
+    return 0;
+}
@@ -1,7 +1,12 @@
 #include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
 #include <unistd.h>
 #include <term.h>
 #include <string>
+#include <ctime>
 
 #include <sys/time.h>
 #include <iomanip>
@@ -15,6 +20,8 @@
 #define BYTE 0
 
 #define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
 #define HIGH 0x1
 #define LOW  0x0
 
@@ -37,7 +44,13 @@ void pinMode(int,int) {}
 void digitalWrite(int pin, int val) {}
 void shiftOut(int dataPin, int clockPin, int bitOrder, int value);
 
+// Tests may drive the clock by hand, negative means the real time
+int64_t pseudoMicros = -1;
+
 uint64_t micros64() {
+    if (pseudoMicros >= 0) {
+        return pseudoMicros;
+    }
     timeval tv1 = {0};
     struct timezone tz = {0};
     gettimeofday(&tv1, &tz);
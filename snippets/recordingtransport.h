@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+#include "../max72xxtransport.h"
+
+/**
+ * Host transport for MAX72xx: counts what would go over the wire and,
+ * if asked to, keeps every latch for the test to look at.
+ */
+class RecordingTransport : public MAX72xxTransport {
+public:
+    std::vector<std::vector<uint8_t> > latches;
+    uint32_t bytes = 0;
+    bool keep;
+
+    RecordingTransport(bool _keep = true) : keep(_keep) {
+    }
+
+    virtual void setup() {
+    }
+
+    virtual void latch(const uint8_t* data, int len) {
+        bytes += len;
+        if (keep) {
+            latches.push_back(std::vector<uint8_t>(data, data + len));
+        }
+    }
+};
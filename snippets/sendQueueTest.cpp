@@ -0,0 +1,97 @@
+#include "pseudo_arduino.h"
+#include "../sendqueue.h"
+
+#include <string>
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+typedef SendQueue<64, 4> Queue;
+
+bool push(Queue& q, const std::string& text, uint32_t key, uint8_t policy, uint32_t nowUs = 0) {
+    return q.push((const uint8_t*)text.data(), text.size(), false, key, policy, nowUs);
+}
+
+std::string front(Queue& q) {
+    return std::string((const char*)q.frontData(), q.frontLength());
+}
+
+/**
+ * Pops all that is queued at nowUs, the messages joined by commas
+ */
+std::string drain(Queue& q, uint32_t nowUs = 0) {
+    std::string all;
+    while (!q.empty()) {
+        all += (all.empty() ? "" : ",") + front(q);
+        q.pop(nowUs);
+    }
+    return all;
+}
+
+void checkPolicies() {
+    Queue q;
+    CHECK(push(q, "key1", 1, Queue::KEEP) && push(q, "pot1", 2, Queue::LATEST) && push(q, "key2", 1, Queue::KEEP) && push(q, "pot2", 2, Queue::LATEST),
+        "pushed");
+    CHECK(q.depth() == 3, "depth %d", q.depth());
+    CHECK(drain(q) == "key1,key2,pot2", "the latest reading goes after the keys");
+
+    // Logs make room for what may not be dropped, the oldest first
+    CHECK(push(q, "log1", 3, Queue::DROP_OLDEST) && push(q, "log2", 3, Queue::DROP_OLDEST) && push(q, "key1", 1, Queue::KEEP) &&
+        push(q, "key2", 1, Queue::KEEP), "pushed");
+    CHECK(push(q, "key3", 1, Queue::KEEP) && q.depth() == 4, "a log dropped for a key");
+    CHECK(push(q, "key4", 1, Queue::KEEP), "the other log dropped");
+    CHECK(push(q, "log3", 3, Queue::DROP_OLDEST) && q.depth() == 4, "a log with no room goes itself");
+    CHECK(!push(q, "key5", 1, Queue::KEEP), "no room for a key");
+    Queue::Stats s = q.takeStats();
+    CHECK(s.dropped == 3 && s.coalesced == 1 && s.maxDepth == 4, "%u dropped, %u coalesced, max depth %u", s.dropped, s.coalesced, s.maxDepth);
+    CHECK(drain(q) == "key1,key2,key3,key4", "keys in order");
+
+    // Bytes run out before the entries do
+    std::string big(31, 'b');
+    CHECK(push(q, big, 1, Queue::KEEP) && push(q, big, 1, Queue::KEEP) && !push(q, "key", 1, Queue::KEEP), "full of bytes");
+    CHECK(!push(q, std::string(65, 'x'), 4, Queue::DROP_OLDEST), "longer than the queue");
+    drain(q);
+    q.clear();
+}
+
+void checkCompaction() {
+    // Readings replaced in the middle leave holes, which are filled when bytes run out
+    Queue q;
+    std::string a(20, 'a');
+    std::string b(20, 'b');
+    for (int i = 0; i < 100; ++i) {
+        std::string reading = std::to_string(i);
+        CHECK(push(q, a, 1, Queue::LATEST) && push(q, reading + b, 2, Queue::LATEST), "%d pushed", i);
+        CHECK(q.depth() == 2 && front(q) == a, "%d: depth %d, front %s", i, q.depth(), front(q).c_str());
+    }
+    CHECK(drain(q) == a + ",99" + b, "the latest of each");
+    Queue::Stats s = q.takeStats();
+    CHECK(s.coalesced == 198 && s.sent == 2, "%u coalesced, %u sent", s.coalesced, s.sent);
+}
+
+void checkStats() {
+    Queue q;
+    push(q, "one", 1, Queue::KEEP, 0xfffffc00u);   // Through the wrap of micros()
+    push(q, "two", 1, Queue::KEEP, 0xfffffe00u);
+    q.pop(0x00000400u);
+    q.pop(0x00000400u);
+    Queue::Stats s = q.takeStats();
+    CHECK(s.sent == 2 && s.latencySumUs == 0x800 + 0x600 && s.maxLatencyUs == 0x800, "%u sent, latency %u, max %u", s.sent, s.latencySumUs, s.maxLatencyUs);
+    push(q, "three", 1, Queue::KEEP);
+    q.clear();
+    s = q.takeStats();
+    CHECK(s.sent == 0 && s.dropped == 1 && s.maxDepth == 1, "cleared: %u sent, %u dropped, max depth %u", s.sent, s.dropped, s.maxDepth);
+}
+
+int main(int argc, char const *argv[]) {
+    checkPolicies();
+    checkCompaction();
+    checkStats();
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("The send queue keeps keys, coalesces readings and drops the oldest logs\n");
+    return 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <deque>
+#include <math.h>
+
+#include "../sntpclient.h"
+
+/**
+ * An NTP server and the network to it, in virtual time: trueUs() is what the
+ * server's clock says, every datagram takes delayUs plus an exponential jitter
+ * each way and may get lost. Answers the way ntpd does, origin is the client's
+ * transmit timestamp.
+ */
+class SimNtpServer : public UdpTransport {
+    struct InFlight {
+        int64_t arrivesUs;
+        uint8_t packet[ntp::packetSize];
+    };
+    std::deque<InFlight> _toClient;
+
+public:
+    int64_t (*trueUs)();
+    int64_t delayUs = 1000;
+    int64_t jitterUs = 500;
+    int64_t processingUs = 30;
+    double lossRate = 0;
+    bool down = false;
+    uint8_t stratum = 2;
+    uint32_t received = 0;
+
+    SimNtpServer(int64_t (*_trueUs)()) :
+            trueUs(_trueUs) {
+    }
+
+    int64_t oneWay() {
+        double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+        return delayUs + (int64_t)(-log(u) * jitterUs);
+    }
+
+    virtual bool send(const uint8_t* data, int len) {
+        if (down || len < ntp::packetSize || (data[0] & 7) != 3 || rand() < lossRate * RAND_MAX) {
+            return true; // Gone on the way, the client can't know
+        }
+        received++;
+        InFlight answer;
+        int64_t at = trueUs() + oneWay();
+        uint8_t* p = answer.packet;
+        memset(p, 0, ntp::packetSize);
+        p[0] = (0 << 6) | (4 << 3) | 4;  // Server
+        p[1] = stratum;
+        p[3] = (uint8_t)-20;             // About a microsecond
+        memcpy(p + 24, data + 40, 8);    // Origin
+        ntp::writeTimestamp(p + 32, at);
+        ntp::writeTimestamp(p + 40, at + processingUs);
+        answer.arrivesUs = at + processingUs + oneWay();
+        // A datagram may overtake another one
+        auto it = _toClient.begin();
+        while (it != _toClient.end() && it->arrivesUs <= answer.arrivesUs) {
+            ++it;
+        }
+        _toClient.insert(it, answer);
+        return true;
+    }
+
+    /**
+     * When the next answer gets to the client, INT64_MAX if none is on the way
+     */
+    int64_t nextArrivalUs() const {
+        return _toClient.empty() ? INT64_MAX : _toClient.front().arrivesUs;
+    }
+
+    virtual int receive(uint8_t* data, int cap) {
+        if (_toClient.empty() || _toClient.front().arrivesUs > trueUs()) {
+            return 0;
+        }
+        int len = ntp::packetSize < cap ? ntp::packetSize : cap;
+        memcpy(data, _toClient.front().packet, len);
+        _toClient.pop_front();
+        return len;
+    }
+};
@@ -0,0 +1,274 @@
+#include "pseudo_arduino.h"
+#include "../deviceclock.h"
+#include "../sntpclient.h"
+#include "simntpserver.h"
+
+#include <algorithm>
+#include <vector>
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+const int64_t unixStartUs = 1700000000ll * 1000000;
+const uint64_t local0 = 1000000;
+
+// Virtual time since the start, and how fast the device's oscillator runs
+int64_t nowTrue = 0;
+double devicePpm = 0;
+
+int64_t trueUnixUs() {
+    return unixStartUs + nowTrue;
+}
+
+uint64_t deviceLocalUs() {
+    return local0 + nowTrue + (int64_t)(nowTrue * devicePpm / 1e6);
+}
+
+void setTime(int64_t t) {
+    nowTrue = t;
+    pseudoMicros = deviceLocalUs();
+}
+
+void checkTimestamps() {
+    uint8_t p[8];
+    const int64_t times[] = { unixStartUs, unixStartUs + 123456, 2085978495ll * 1000000 + 999999, 2085978496ll * 1000000, 2200000000ll * 1000000 + 1 };
+    for (int64_t t : times) {
+        ntp::writeTimestamp(p, t);
+        CHECK(llabs(ntp::readTimestamp(p) - t) <= 1, "timestamp %lld reads as %lld", (long long)t, (long long)ntp::readTimestamp(p));
+    }
+    // 2036-02-07 06:28:16 UTC is where the first NTP era ends
+    ntp::writeTimestamp(p, 2085978496ll * 1000000);
+    CHECK(p[0] == 0 && p[1] == 0 && p[2] == 0 && p[3] == 0, "era 1 starts at 0");
+}
+
+/**
+ * The next loop pass: 20 ms later, or as soon as something arrives
+ */
+int64_t nextPass(int64_t arrivalUnixUs) {
+    return std::min(nowTrue + 20000, std::max(nowTrue + 1, arrivalUnixUs - unixStartUs));
+}
+
+/**
+ * Plays the client against the server for a while
+ */
+int run(SntpClient& client, SimNtpServer& server, int64_t forUs, std::vector<SntpClient::Sample>& samples) {
+    SntpClient::Sample s;
+    int64_t until = nowTrue + forUs;
+    for (; nowTrue < until; setTime(nextPass(server.nextArrivalUs()))) {
+        if (client.poll(pseudoMicros, 64, s)) {
+            samples.push_back(s);
+        }
+    }
+    return samples.size();
+}
+
+void checkProtocol() {
+    setTime(0);
+    SimNtpServer server(trueUnixUs);
+    SntpClient client(server);
+    std::vector<SntpClient::Sample> samples;
+    run(client, server, 10000000, samples);
+    CHECK(samples.size() == 1 && client.requests() == 4 && client.answers() == 4, "a burst: %d samples of %u requests, %u answers",
+        (int)samples.size(), client.requests(), client.answers());
+    if (samples.size() == 1) {
+        const SntpClient::Sample& s = samples[0];
+        CHECK(s.delayUs >= 2000 && s.delayUs < 20000 + 2000, "delay %lld", (long long)s.delayUs);
+        int64_t measured = s.serverUs + (int64_t)(s.receivedUs - s.sentUs) / 2;
+        int64_t truth = unixStartUs + (int64_t)(s.receivedUs - local0);
+        CHECK(llabs(measured - truth) <= s.delayUs / 2 + 10, "sample is off by %lld us", (long long)(measured - truth));
+    }
+
+    // Nothing until the poll interval passed
+    run(client, server, 50000000, samples);
+    CHECK(samples.size() == 1, "no burst before the poll interval");
+    run(client, server, 20000000, samples);
+    CHECK(samples.size() == 2, "the next burst");
+
+    // Lost answers time out, the burst goes on with the rest
+    server.lossRate = 0.5;
+    int before = samples.size();
+    run(client, server, 20 * 72000000ll, samples);
+    CHECK((int)samples.size() >= before + 18, "bursts with losses gave %d samples", (int)samples.size() - before);
+
+    // Kiss-o'-death ends the burst, nothing comes out
+    server.lossRate = 0;
+    server.stratum = 0;
+    before = samples.size();
+    uint32_t rejected = client.rejected();
+    run(client, server, 80000000, samples);
+    CHECK((int)samples.size() == before && client.rejected() > rejected, "kiss-o'-death");
+    server.stratum = 2;
+
+    // A reply that doesn't carry our transmit timestamp is not taken
+    uint8_t forged[48] = { 0x24, 2 };
+    struct Forger : public UdpTransport {
+        uint8_t* packet;
+        bool sent = false;
+        virtual bool send(const uint8_t* data, int len) { sent = true; return true; }
+        virtual int receive(uint8_t* data, int cap) {
+            if (!sent) {
+                return 0;
+            }
+            sent = false;
+            memcpy(data, packet, 48);
+            return 48;
+        }
+    } forger;
+    forger.packet = forged;
+    SntpClient fooled(forger);
+    std::vector<SntpClient::Sample> none;
+    SntpClient::Sample s;
+    for (int i = 0; i < 1000; ++i) {
+        setTime(nowTrue + 20000);
+        if (fooled.poll(pseudoMicros, 64, s)) {
+            none.push_back(s);
+        }
+    }
+    CHECK(none.empty() && fooled.rejected() > 0, "forged answers taken");
+
+    // A server that can't be reached, as without DNS: one try a burst, not one a request
+    struct Unreachable : public UdpTransport {
+        int sends = 0;
+        int losts = 0;
+        virtual bool send(const uint8_t* data, int len) { sends++; return false; }
+        virtual int receive(uint8_t* data, int cap) { return 0; }
+        virtual void lost() { losts++; }
+    } unreachable;
+    SntpClient unreached(unreachable);
+    for (int64_t until = nowTrue + 200000000; nowTrue < until; setTime(nowTrue + 20000)) {
+        if (unreached.poll(pseudoMicros, 64, s)) {
+            none.push_back(s);
+        }
+    }
+    CHECK(none.empty() && unreachable.sends == 4 && unreachable.losts == 4, "unreachable: %d sends, %d bursts lost",
+        unreachable.sends, unreachable.losts);
+    pseudoMicros = -1;
+}
+
+/**
+ * Error of one exchange against the best of a burst, as the jitter grows
+ */
+void benchFilter() {
+    const int64_t jitters[] = { 500, 2000, 10000, 40000 };
+    for (int64_t jitter : jitters) {
+        srand(1);
+        setTime(0);
+        SimNtpServer server(trueUnixUs);
+        server.delayUs = 5000;
+        server.jitterUs = jitter;
+        std::vector<int64_t> single;
+        std::vector<int64_t> best;
+        for (int burst = 0; burst < 3000; ++burst) {
+            int64_t bestDelay = INT64_MAX;
+            int64_t bestError = 0;
+            for (int i = 0; i < SntpClient::burstSize; ++i) {
+                int64_t there = server.oneWay();
+                int64_t back = server.oneWay();
+                // The server stamps when the request is there, the client halves the round trip
+                int64_t error = (back - there) / 2;
+                if (i == 0) {
+                    single.push_back(llabs(error));
+                }
+                if (there + back < bestDelay) {
+                    bestDelay = there + back;
+                    bestError = error;
+                }
+            }
+            best.push_back(llabs(bestError));
+        }
+        std::sort(single.begin(), single.end());
+        std::sort(best.begin(), best.end());
+        auto at = [](const std::vector<int64_t>& v, double q) { return v[(size_t)(q * (v.size() - 1))] / 1000.0; };
+        printf("jitter %5.1f ms: one exchange median %6.2f ms, 95%% %6.2f ms; best of %d median %6.2f ms, 95%% %6.2f ms\n",
+            jitter / 1000.0, at(single, 0.5), at(single, 0.95), SntpClient::burstSize, at(best, 0.5), at(best, 0.95));
+    }
+    pseudoMicros = -1;
+}
+
+/**
+ * The sketch's sources over three days: NTP on the LAN, the WebSocket server further away.
+ * NTP is down for the second half of the first day, then comes back.
+ */
+void checkSources() {
+    srand(2);
+    devicePpm = 37;
+    setTime(0);
+    SimNtpServer server(trueUnixUs);
+    SntpClient client(server);
+    DeviceClock clock;
+    ClockSources sources(clock);
+
+    const int64_t wsDelayUs = 20000;
+    const int64_t wsJitterUs = 10000;
+    uint64_t wsNextUs = 0;
+    int64_t wsAnswerAt = -1;
+    int64_t wsServerUs = 0;
+    uint64_t wsSentUs = 0;
+
+    int64_t maxError = 0;
+    int64_t maxErrorNtpDown = 0;
+    int switches = 0;
+    int lastBest = -1;
+    const int64_t day = 86400ll * 1000000;
+    for (setTime(0); nowTrue < 3 * day; setTime(nextPass(std::min(server.nextArrivalUs(), wsAnswerAt < 0 ? INT64_MAX : unixStartUs + wsAnswerAt)))) {
+        server.down = nowTrue >= day / 2 && nowTrue < day;
+        uint64_t local = clock.monotonicUs();
+
+        SntpClient::Sample s;
+        if (client.poll(local, clock.pollIntervalS(), s)) {
+            sources.offer(ClockSources::NTP, s.serverUs, s.sentUs, s.receivedUs, s.precisionUs);
+        }
+
+        // timeRequest over the WebSocket, answered with milliseconds
+        if (wsAnswerAt < 0 && local >= wsNextUs) {
+            wsSentUs = local;
+            double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+            int64_t there = wsDelayUs + (int64_t)(-log(u) * wsJitterUs);
+            u = (rand() + 1.0) / (RAND_MAX + 2.0);
+            int64_t back = wsDelayUs + (int64_t)(-log(u) * wsJitterUs);
+            wsServerUs = (trueUnixUs() + there) / 1000 * 1000;
+            wsAnswerAt = nowTrue + there + back;
+        }
+        if (wsAnswerAt >= 0 && nowTrue >= wsAnswerAt) {
+            sources.offer(ClockSources::WEBSOCKET, wsServerUs, wsSentUs, local, 1000);
+            wsAnswerAt = -1;
+            wsNextUs = local + clock.pollIntervalS() * 1000000ull;
+        }
+
+        if (sources.best() != lastBest) {
+            printf("  %5.1f h: %s disciplines the clock\n", nowTrue / 3600e6, sources.bestName());
+            // The first WebSocket answer usually beats the NTP burst, that is not a switch
+            switches += lastBest >= 0 && nowTrue > 3600ll * 1000000;
+            lastBest = sources.best();
+        }
+        if (nowTrue > 3600ll * 1000000 && clock.synced()) {
+            int64_t error = llabs(clock.unixUs() - trueUnixUs());
+            maxError = std::max(maxError, error);
+            if (server.down) {
+                maxErrorNtpDown = std::max(maxErrorNtpDown, error);
+            }
+        }
+    }
+    printf("Sources: %u NTP and %u WebSocket samples used, skew %+d ppb, max error %.2f ms, %.2f ms while NTP was down\n",
+        sources.used(ClockSources::NTP), sources.used(ClockSources::WEBSOCKET), clock.skewPpb(),
+        maxError / 1000.0, maxErrorNtpDown / 1000.0);
+    CHECK(switches == 2, "%d switches of the source", switches);
+    CHECK(sources.best() == ClockSources::NTP, "NTP is back as the source");
+    CHECK(maxError < 30000, "max error %.2f ms", maxError / 1000.0);
+    devicePpm = 0;
+    pseudoMicros = -1;
+}
+
+int main(int argc, char const *argv[]) {
+    checkTimestamps();
+    checkProtocol();
+    checkSources();
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("SNTP client, filter and source selection work\n");
+    benchFilter();
+    return 0;
+}
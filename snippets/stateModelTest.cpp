@@ -0,0 +1,69 @@
+#include "pseudo_arduino.h"
+#include "../statemodel.h"
+
+#include <string>
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+char json[512];
+std::string stripe = "FF000000";
+
+std::string textOf(const char* name) {
+    return strcmp(name, "ledstripe") == 0 ? stripe : "00.22";
+}
+
+/**
+ * The values changed since the version, as JSON
+ */
+std::string since(const StateModel& s, uint32_t version) {
+    JsonWriter w(json, sizeof(json));
+    w.beginObject();
+    s.write(w, version, textOf);
+    w.endObject();
+    return w.c_str();
+}
+
+void checkVersions() {
+    StateModel s;
+    s.setEpoch(0);
+    CHECK(s.epoch() == 1, "epoch 0 is for servers which know nothing");
+    s.setEpoch(0xc0ffee);
+    s.add("firmware", StateModel::TEXT);
+    s.add("relay0", StateModel::FLAG);
+    s.add("brightness", StateModel::INTEGER);
+    s.add("ledstripe", StateModel::TEXT);
+    s.add("temp", StateModel::NUMBER, false);
+    s.add("relay0", StateModel::INTEGER);
+    CHECK(since(s, 0) == "{\"values\":{}}", "nothing set: %s", since(s, 0).c_str());
+
+    CHECK(s.setText("firmware", "00.22") && s.set("relay0", false) && s.set("brightness", 40) && s.setText("ledstripe", stripe.c_str()), "set");
+    CHECK(s.version() == 4 && s.liveVersion() == 4, "version %u", s.version());
+    CHECK(since(s, 0) == "{\"values\":{\"firmware\":\"00.22\",\"relay0\":false,\"brightness\":40,\"ledstripe\":\"FF000000\"}}", "%s", since(s, 0).c_str());
+
+    CHECK(!s.set("relay0", false) && !s.setText("ledstripe", "FF000000") && !s.set("brightness", 40) && s.version() == 4, "no change, no version");
+    CHECK(!s.set("missing", 1) && !s.set("firmware", 1) && !s.setText("relay0", "x"), "no such field");
+
+    uint32_t seen = s.version();
+    s.set("relay0", true);
+    s.set("temp", 21.5f);
+    CHECK(s.liveVersion() == seen + 1 && s.version() == seen + 2, "a reading is no live change");
+    stripe = "00FF0000";
+    s.setText("ledstripe", stripe.c_str());
+    CHECK(since(s, seen) == "{\"values\":{\"relay0\":true,\"ledstripe\":\"00FF0000\",\"temp\":21.50}}", "%s", since(s, seen).c_str());
+    CHECK(since(s, s.version()) == "{\"values\":{}}", "nothing since now");
+
+    CHECK(s.knows(0xc0ffee, seen) && s.knows(0xc0ffee, s.version()), "knows");
+    CHECK(!s.knows(0xc0ffee, s.version() + 1) && !s.knows(0, 0) && !s.knows(0xc0ffef, seen), "another boot");
+}
+
+int main(int argc, char const *argv[]) {
+    checkVersions();
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("The state tells what changed since a version\n");
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include "pseudo_arduino.h"
+#include "../telemetry.h"
+
+#include <string>
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+char json[1024];
+uint8_t frame[300];
+
+void setUp(Telemetry& t) {
+    t.addChannel("temp", binproto::TEMP, 0);
+    t.addChannel("humidity", binproto::HUMIDITY, 0);
+    t.addChannel("weight", binproto::WEIGHT, 0, true);
+    t.setThresholds("temp:0.1;unknown:5;weight:100;humidity");
+}
+
+void checkBatches() {
+    Telemetry t;
+    setUp(t);
+    CHECK(t.threshold("temp") == 0.1f && t.threshold("weight") == 100 && t.threshold("humidity") == 0 && t.threshold("tem") == 0,
+        "thresholds %f %f %f", t.threshold("temp"), t.threshold("weight"), t.threshold("humidity"));
+    CHECK(!t.add("temp", 21.5f, 2150, 0), "no interval, nothing batched");
+
+    t.setInterval(1000);
+    const uint32_t start = 0xfffffe00u;   // Through the wrap of millis()
+    CHECK(t.add("temp", 21.5f, 2150, start) && t.add("weight", 5000, 5000, start + 10), "batched");
+    CHECK(!t.add("button", 1, 1, start + 20), "no channel, sent by itself");
+    CHECK(t.add("temp", 21.55f, 2155, start + 100) && t.add("weight", 5090, 5090, start + 110) && t.count() == 2, "below the thresholds");
+    CHECK(t.add("weight", 4890, 4890, start + 120) && t.count() == 3, "a step of weight");
+    CHECK(!t.due(start + 999) && t.due(start + 1000), "due after the interval");
+
+    JsonWriter w(json, sizeof(json));
+    w.beginObject().field("type", "telemetry");
+    t.write(w);
+    w.endObject();
+    CHECK(std::string(w.c_str()) == "{\"type\":\"telemetry\",\"samples\":[{\"type\":\"temp\",\"value\":21.50,\"timeseq\":4294966784},"
+        "{\"type\":\"weight\",\"value\":5000,\"timeseq\":4294966794},{\"type\":\"weight\",\"value\":4890,\"timeseq\":4294966904}]}",
+        "%s", w.c_str());
+
+    binproto::Writer bw(frame, sizeof(frame));
+    t.write(bw.begin(binproto::TELEMETRY), start + 1000);
+    binproto::Reader r(bw.data(), bw.length());
+    size_t length;
+    const uint8_t* p = r.bytes(binproto::SAMPLES, length);
+    CHECK(r.valid() && r.kind() == binproto::TELEMETRY && r.u32(binproto::TIMESEQ) == start + 1000 && length == 3 * 7, "binary batch of %u bytes", (unsigned)length);
+    if (length == 3 * 7) {
+        CHECK(p[0] == binproto::TEMP && (p[1] | p[2] << 8) == 2150 && (p[5] | p[6] << 8) == 1000, "the temp");
+        CHECK(p[14] == binproto::WEIGHT && (int32_t)(p[15] | p[16] << 8 | p[17] << 16 | (uint32_t)p[18] << 24) == 4890 && (p[19] | p[20] << 8) == 880,
+            "the last weight");
+    }
+    t.clear();
+    CHECK(t.count() == 0 && !t.due(start + 5000), "cleared");
+
+    // The same reading goes again after keepAliveMs
+    CHECK(t.add("temp", 21.5f, 2150, start + t.keepAliveMs - 1) && t.count() == 0, "unchanged");
+    CHECK(t.add("temp", 21.5f, 2150, start + t.keepAliveMs) && t.count() == 1, "kept alive");
+}
+
+void checkFull() {
+    Telemetry t;
+    setUp(t);
+    t.setInterval(100000);
+    for (int i = 0; i < Telemetry::maxSamples - 1; ++i) {
+        t.add("weight", i * 1000, i * 1000, i);
+    }
+    t.add("temp", 20, 2000, 100);
+    CHECK(t.count() == Telemetry::maxSamples && t.due(101), "full, due at once");
+    CHECK(t.add("temp", 30, 3000, 102) && t.count() == Telemetry::maxSamples, "one more");
+    CHECK(t.sample(Telemetry::maxSamples - 1).value == 30 && t.sample(0).value == 0, "the older temp made room");
+    CHECK(t.add("humidity", 50, 5000, 103) && t.sample(Telemetry::maxSamples - 1).value == 30, "no older humidity, the new one goes");
+
+    binproto::Writer bw(frame, sizeof(frame));
+    t.write(bw.begin(binproto::TELEMETRY), 200);
+    CHECK(!bw.overflowed() && binproto::Reader(bw.data(), bw.length()).valid(), "a full batch fits a frame");
+}
+
+/**
+ * A full batch of the longest readings fits maxJsonBytes, as the message sendTelemetry() writes
+ */
+void checkLongest() {
+    Telemetry t;
+    t.addChannel("potentiometer", binproto::POTENTIOMETER, 0);
+    t.addChannel("potentiometerX", binproto::POTENTIOMETER, 0);
+    t.addChannel("weight", binproto::WEIGHT, 0, true);
+    t.setInterval(100000);
+    for (int i = 0; i < Telemetry::maxSamples; ++i) {
+        t.add("potentiometer", -1.7e17f, 0, 0xffffffffu);
+    }
+    CHECK(!t.add("potentiometerX", 0, 0, 0) && t.count() == Telemetry::maxSamples, "a name too long has no channel");
+
+    static char buffer[Telemetry::maxJsonBytes];
+    JsonWriter w(buffer, sizeof(buffer));
+    w.beginObject().field("type", "telemetry");
+    t.write(w);
+    w.field("timeseq", 0xffffffffu).endObject();
+    CHECK(!w.overflowed() && w.length() == sizeof(buffer) - 1, "%u bytes of %u: %s", (unsigned)w.length(), (unsigned)sizeof(buffer), w.c_str());
+
+    Telemetry i;
+    i.addChannel("weight", binproto::WEIGHT, 0, true);
+    i.setInterval(100000);
+    for (int n = 0; n < Telemetry::maxSamples; ++n) {
+        i.add("weight", -2147483648.0f, INT32_MIN, 0xffffffffu);
+    }
+    w.reset();
+    w.beginObject().field("type", "telemetry");
+    i.write(w);
+    w.field("timeseq", 0xffffffffu).endObject();
+    CHECK(!w.overflowed() && strstr(w.c_str(), "\"value\":-2147483648,") != NULL, "integers fit: %s", w.c_str());
+}
+
+/**
+ * A day of readings from a BME280 and a load cell: messages and bytes with each
+ * reading sent by itself, against batches of a second and of ten
+ */
+void bench() {
+    struct Config {
+        const char* name;
+        uint32_t intervalMs;
+        const char* thresholds;
+    } configs[] = {
+        { "each by itself", 0, "" },
+        { "1 s batches", 1000, "" },
+        { "1 s batches, thresholds", 1000, "temp:0.1;humidity:0.5;pressure:20;weight:100" },
+        { "10 s batches, thresholds", 10000, "temp:0.1;humidity:0.5;pressure:20;weight:100" },
+    };
+    for (const Config& c : configs) {
+        Telemetry t;
+        t.addChannel("temp", binproto::TEMP, 0);
+        t.addChannel("humidity", binproto::HUMIDITY, 0);
+        t.addChannel("pressure", binproto::PRESSURE, 0);
+        t.addChannel("weight", binproto::WEIGHT, 0, true);
+        t.setThresholds(c.thresholds);
+        t.setInterval(c.intervalMs);
+        uint32_t messages = 0;
+        uint32_t readings = 0;
+        uint64_t bytes = 0;
+        JsonWriter w(json, sizeof(json));
+        auto send = [&]() {
+            messages++;
+            bytes += w.length();
+        };
+        uint64_t t0 = micros64();
+        for (uint32_t now = 0; now < 86400000u; now += 100) {
+            // Weight every 100 ms, noisy, with someone on the scale now and then
+            readings++;
+            float weight = 5000 + (now / 1000 * 7919 % 61) - 30 + ((now / 600000) % 3 == 0 ? 40000 : 0);
+            if (!t.add("weight", weight, (int32_t)weight, now)) {
+                w.reset();
+                w.beginObject().field("type", "weight").field("value", (long)weight).field("timeseq", now).endObject();
+                send();
+            }
+            if (now % 4000 == 0) {
+                float values[] = { 21.5f + (now / 60000 % 40) * 0.05f, 40 + (now / 300000 % 10) * 0.3f, 101325 + (now / 30000 % 50) * 3.0f };
+                const char* types[] = { "temp", "humidity", "pressure" };
+                for (int i = 0; i < 3; ++i) {
+                    readings++;
+                    if (!t.add(types[i], values[i], binproto::hundredths(values[i]), now)) {
+                        w.reset();
+                        w.beginObject().field("type", types[i]).field("value", values[i]).field("timeseq", now).endObject();
+                        send();
+                    }
+                }
+            }
+            if (t.due(now)) {
+                w.reset();
+                w.beginObject().field("type", "telemetry");
+                t.write(w);
+                w.field("timeseq", now).endObject();
+                t.clear();
+                send();
+            }
+        }
+        uint64_t us = micros64() - t0;
+        printf("%-25s %6u messages a day, %7.1f KB, %.3f us a reading\n", c.name, messages, bytes / 1024.0, (double)us / readings);
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    checkBatches();
+    checkFull();
+    checkLongest();
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("Readings are batched by interval and threshold\n");
+    bench();
+    return 0;
+}
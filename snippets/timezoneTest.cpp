@@ -0,0 +1,154 @@
+#include "pseudo_arduino.h"
+#include "../timezone.h"
+
+#include <fstream>
+#include <string>
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+/**
+ * The POSIX string a TZif v2+ file ends with: it describes the zone after its last listed transition
+ */
+std::string footerOf(const char* zone) {
+    std::ifstream f(std::string("/usr/share/zoneinfo/") + zone, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    size_t end = data.size() > 0 && data.back() == '\n' ? data.size() - 1 : data.size();
+    size_t begin = data.rfind('\n', end - 1);
+    return begin == std::string::npos ? "" : data.substr(begin + 1, end - begin - 1);
+}
+
+int32_t systemOffset(int64_t utc) {
+    time_t t = utc;
+    struct tm tm;
+    localtime_r(&t, &tm);
+    return tm.tm_gmtoff;
+}
+
+/**
+ * Every hour of the years against localtime, then a second around every transition
+ */
+void checkZone(const char* zone, int32_t fromYear, int32_t toYear) {
+    std::string posix = footerOf(zone);
+    tz::TimeZone tz;
+    CHECK(tz.set(posix.c_str()), "%s: \"%s\" does not parse", zone, posix.c_str());
+    setenv("TZ", (std::string(":") + zone).c_str(), 1);
+    tzset();
+
+    int64_t from = (int64_t)date::daysFromCivil(fromYear, 1, 1) * 86400;
+    int64_t to = (int64_t)date::daysFromCivil(toYear + 1, 1, 1) * 86400;
+    int transitions = 0;
+    int32_t prev = systemOffset(from);
+    for (int64_t t = from; t < to; t += 3600) {
+        int32_t expected = systemOffset(t);
+        if (expected != prev) {
+            transitions++;
+            // Find the exact second, the hours only bracket it
+            int64_t lo = t - 3600;
+            int64_t hi = t;
+            while (hi - lo > 1) {
+                int64_t mid = (lo + hi) / 2;
+                (systemOffset(mid) == prev ? lo : hi) = mid;
+            }
+            CHECK(tz.offset(lo) == prev && tz.offset(hi) == expected, "%s: transition at %lld is %d -> %d, not %d -> %d",
+                zone, (long long)hi, tz.offset(lo), tz.offset(hi), prev, expected);
+            prev = expected;
+        }
+        CHECK(tz.offset(t) == expected, "%s \"%s\": offset at %lld is %d, not %d", zone, posix.c_str(), (long long)t, tz.offset(t), expected);
+    }
+    printf("%-20s %-40s %d transitions in %d..%d, table built %u times\n",
+        zone, posix.c_str(), transitions, fromYear, toYear, tz.compilations());
+}
+
+void checkParser() {
+    tz::Rule rule;
+    const char* good[] = {
+        "UTC0", "MSK-3", "<+03>-3", "IST-5:30", "<+0545>-05:45", "EST5EDT", "EST+5EDT4,M3.2.0/2:00:00,M11.1.0/2",
+        "<-02>2<-01>,M3.5.0/-1,M10.5.0/0", "EST5EDT,0/0,J365/25", "XXX3YYY,J60/-167,300/167"
+    };
+    for (const char* s : good) {
+        CHECK(tz::parse(s, rule), "\"%s\" does not parse", s);
+    }
+    const char* bad[] = {
+        "", "M", "MSK", "MSK-", "MS-3", "<+03-3", "MSK-3x", "CET-1CEST,M3.5.0", "CET-1CEST,M13.5.0,M10.5.0",
+        "CET-1CEST,M3.6.0,M10.5.0", "CET-1CEST,M3.5.7,M10.5.0", "CET-1CEST,J0,J100", "CET-1CEST,366,1",
+        "CET-1CEST,M3.5.0/168,M10.5.0", "CET-1:60", "CET-1CEST,M3.5.0,M10.5.0,"
+    };
+    for (const char* s : bad) {
+        CHECK(!tz::parse(s, rule), "\"%s\" parses", s);
+    }
+
+    CHECK(tz::parse("EST5EDT", rule) && rule.stdOffset == -5 * 3600 && rule.dstOffset == -4 * 3600 &&
+        rule.start.month == 3 && rule.start.week == 2 && rule.end.month == 11, "US rules by default");
+
+    tz::TimeZone zone;
+    CHECK(zone.set("MSK-3") && zone.offset(1700000000) == 3 * 3600, "MSK");
+    CHECK(!zone.set("garbage") && zone.offset(1700000000) == 3 * 3600, "a bad string leaves the zone as it was");
+
+    // Jn never counts February 29, n does
+    CHECK(zone.set("AAA0BBB,J60/0,J61/0") && zone.offset((int64_t)date::daysFromCivil(2024, 3, 1) * 86400) == 3600 &&
+        zone.offset((int64_t)date::daysFromCivil(2024, 2, 29) * 86400) == 0, "J60 is March 1 in a leap year");
+    CHECK(zone.set("AAA0BBB,59/0,60/0") && zone.offset((int64_t)date::daysFromCivil(2024, 2, 29) * 86400) == 3600 &&
+        zone.offset((int64_t)date::daysFromCivil(2023, 3, 1) * 86400) == 3600, "59 is February 29 in a leap year");
+}
+
+/**
+ * What the clock does: a lookup per frame at 50 fps, over a month with a transition
+ */
+void bench() {
+    tz::TimeZone zone;
+    zone.set("EET-2EEST,M3.5.0/3,M10.5.0/4");
+    const int64_t from = (int64_t)date::daysFromCivil(2026, 3, 15) * 86400 * 1000;
+    const int64_t frames = 30ll * 86400 * 50;
+    uint64_t sum = 0;
+    uint64_t bestUs = UINT64_MAX;
+    uint64_t fixedUs = UINT64_MAX;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        uint64_t t0 = micros64();
+        for (int64_t f = 0; f < frames; ++f) {
+            sum += zone.localMs(from + f * 20);
+        }
+        uint64_t t1 = micros64();
+        // What was there before, a fixed UTC+3
+        volatile int32_t fixedMs = 3 * 60 * 60 * 1000;
+        for (int64_t f = 0; f < frames; ++f) {
+            sum += from + f * 20 + fixedMs;
+        }
+        uint64_t t2 = micros64();
+        bestUs = std::min(bestUs, t1 - t0);
+        fixedUs = std::min(fixedUs, t2 - t1);
+    }
+
+    // Lookups far apart, every one has to search or even rebuild the table
+    tz::TimeZone cold;
+    cold.set("EET-2EEST,M3.5.0/3,M10.5.0/4");
+    const int lookups = 1000000;
+    uint64_t t0 = micros64();
+    for (int i = 0; i < lookups; ++i) {
+        sum += cold.offset(1700000000ll + (int64_t)(i % 1000) * 86400 * 37);
+    }
+    uint64_t coldUs = micros64() - t0;
+    printf("ns per frame: localMs %.2f, fixed offset %.2f; %.1f ns per lookup far from the last one (%llu)\n",
+        bestUs * 1000.0 / frames, fixedUs * 1000.0 / frames, coldUs * 1000.0 / lookups, (unsigned long long)sum % 10);
+}
+
+int main(int argc, char const *argv[]) {
+    checkParser();
+    const char* zones[] = {
+        "Europe/Moscow", "Europe/Kyiv", "Europe/Berlin", "Europe/London", "Europe/Dublin", "America/New_York",
+        "America/St_Johns", "America/Nuuk", "America/Sao_Paulo", "Australia/Sydney", "Australia/Lord_Howe",
+        "Pacific/Auckland", "Pacific/Chatham", "Asia/Kolkata", "Asia/Kathmandu", "America/Santiago"
+    };
+    for (const char* zone : zones) {
+        // After the last rule change of each of them, the footer is all there is
+        checkZone(zone, 2026, 2045);
+    }
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("Transition tables match the system tz database\n");
+    bench();
+    return 0;
+}
@@ -1,9 +1,267 @@
 #include "pseudo_arduino.h"
 
+#include <locale.h>
+#include <vector>
+
 #include "../lcd.h"
 
-int main(int argc, char const *argv[]) {
+/**
+ * The decoder MsgToShow::set used before utf8.h, kept to compare against.
+ * Understands 1 to 3 byte sequences only and drops everything else.
+ */
+int legacyDecode(const char* utf8str, wchar_t* out) {
+    int srcLen = strlen(utf8str);
+    int outIndex = 0;
+    for (int i = 0; utf8str[i] != 0;) {
+        uint16_t sym = utf8str[i];
+
+        if (
+            (sym & 0b11110000) == 0b11100000 &&
+            ((i + 1) < srcLen) && (utf8str[i+1] & 0b11000000) == 0b10000000 &&
+            ((i + 2) < srcLen) && (utf8str[i+2] & 0b11000000) == 0b10000000
+        ) {
+            out[outIndex++] =
+                (((sym & 0b1111) << 12) & 0b1111000000000000) |
+                ((((uint16_t)utf8str[i+1] & 0b111111) << 6) & 0b111111000000) |
+                ((uint16_t)utf8str[i+2] & 0b111111);
+            i+=3;
+        } else if (
+            (sym & 0b11100000) == 0b11000000 &&
+            ((i + 1) < srcLen) && (utf8str[i+1] & 0b11000000) == 0b10000000) {
+            out[outIndex++] = (((sym & 0b11111) << 6) & 0b11111000000) |
+                ((uint16_t)utf8str[i+1] & 0b111111);
+            i+=2;
+        } else if ((sym & 0b10000000) == 0) {
+            out[outIndex++] = sym;
+            i++;
+        } else {
+            i++;
+        }
+    }
+    out[outIndex] = 0;
+    return outIndex;
+}
+
+void encode(uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+uint32_t randomCodePoint() {
+    for (;;) {
+        uint32_t cp;
+        switch (rand() % 6) {
+            case 0: case 1: cp = rand() % 0x80; break;
+            case 2: cp = 0x400 + rand() % 0x100; break;
+            case 3: cp = 0x80 + rand() % 0x780; break;
+            case 4: cp = 0x800 + rand() % 0xF800; break;
+            default: cp = 0x10000 + rand() % 0x100000; break;
+        }
+        if (cp != 0 && (cp < 0xD800 || cp > 0xDFFF)) {
+            return cp;
+        }
+    }
+}
+
+int failures = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { if (failures++ < 20) { printf("FAIL %s:%d ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } } while (0)
+
+std::vector<uint32_t> decodeAll(const std::string& s) {
+    std::vector<wchar_t> out(s.size() + 1);
+    int used = 0;
+    int n = utf8::decode(s.data(), s.size(), out.data(), out.size(), used);
+    return std::vector<uint32_t>(out.begin(), out.begin() + n);
+}
+
+void checkVectors() {
+    // Unicode 3-8: maximal subparts of ill-formed sequences become one U+FFFD each
+    std::vector<uint32_t> expected = { 0x61, 0xFFFD, 0xFFFD, 0xFFFD, 0x62, 0xFFFD, 0x63, 0xFFFD, 0xFFFD, 0x64 };
+    CHECK(decodeAll("\x61\xF1\x80\x80\xE1\x80\xC2\x62\x80\x63\x80\xBF\x64") == expected, "Unicode table 3-8");
+
+    struct {
+        const char* bytes;
+        std::vector<uint32_t> cps;
+    } vectors[] = {
+        { "\xC0\xAF", { 0xFFFD, 0xFFFD } },                 // Overlong '/'
+        { "\xE0\x80\xAF", { 0xFFFD, 0xFFFD, 0xFFFD } },     // Overlong '/'
+        { "\xED\xA0\x80", { 0xFFFD, 0xFFFD, 0xFFFD } },     // Surrogate
+        { "\xF4\x90\x80\x80", { 0xFFFD, 0xFFFD, 0xFFFD, 0xFFFD } }, // Above U+10FFFF
+        { "\xF0\x9F\x98\x80", { 0x1F600 } },
+        { "\xF4\x8F\xBF\xBF", { 0x10FFFF } },
+        { "\xEF\xBF\xBF", { 0xFFFF } },
+        { "\xD0\x81\xD1\x91", { 0x401, 0x451 } },
+        { "ab\xE2\x82", { 0x61, 0x62, 0xFFFD } },          // Cut at the end
+    };
+    for (auto& v : vectors) {
+        CHECK(decodeAll(v.bytes) == v.cps, "vector %s", v.bytes);
+    }
+
+    // Output capacity stops decoding on a character boundary
+    wchar_t out[3];
+    int used = 0;
+    int n = utf8::decode("abcdЁ", 6, out, 3, used);
+    CHECK(n == 3 && used == 3, "capacity: %d chars from %d bytes", n, used);
+    n = utf8::decode("abЁЁ", 6, out, 3, used);
+    CHECK(n == 3 && used == 4 && out[2] == 0x401, "capacity: %d chars from %d bytes", n, used);
+}
+
+void fuzzValid(int rounds) {
+    for (int r = 0; r < rounds; ++r) {
+        std::vector<uint32_t> cps;
+        std::string s;
+        bool bmp = rand() % 2 == 0;
+        int len = rand() % 40;
+        for (int i = 0; i < len; ++i) {
+            uint32_t cp = randomCodePoint();
+            if (bmp && cp > 0xFFFF) {
+                cp = 0x20AC;
+            }
+            cps.push_back(cp);
+            encode(cp, s);
+        }
+        CHECK(decodeAll(s) == cps, "round trip of %d code points", len);
+        if (bmp) {
+            std::vector<wchar_t> legacy(s.size() + 1);
+            int n = legacyDecode(s.c_str(), legacy.data());
+            CHECK(std::vector<uint32_t>(legacy.begin(), legacy.begin() + n) == cps, "legacy decoder differs on valid BMP text");
+        }
+    }
+}
+
+/**
+ * Random bytes, biased to lead and continuation bytes. Wherever glibc calls the
+ * input valid Unicode the results must match, everywhere else there must be a U+FFFD.
+ */
+void fuzzBytes(int rounds) {
+    const uint8_t interesting[] = { 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xC1, 0xC2, 0xDF, 0xE0, 0xE1, 0xED, 0xEF, 0xF0, 0xF4, 0xF5, 0xFF, 'a' };
+    int valid = 0;
+    for (int r = 0; r < rounds; ++r) {
+        int len = rand() % 12;
+        std::string s;
+        for (int i = 0; i < len; ++i) {
+            s += (char)(rand() % 2 ? interesting[rand() % sizeof(interesting)] : (1 + rand() % 255));
+        }
+        std::vector<uint32_t> cps = decodeAll(s);
+        CHECK(cps.size() <= s.size(), "more code points than bytes");
+
+        std::vector<wchar_t> ref(s.size() + 1);
+        size_t n = mbstowcs(ref.data(), s.c_str(), ref.size());
+        bool hasReplacement = false;
+        for (uint32_t cp : cps) {
+            hasReplacement |= cp == utf8::REPLACEMENT;
+            CHECK(cp <= 0x10FFFF && (cp < 0xD800 || cp > 0xDFFF), "decoded %X", cp);
+        }
+        // glibc still takes the old 5 and 6 byte forms and values above U+10FFFF
+        for (size_t i = 0; n != (size_t)-1 && i < n; ++i) {
+            if ((uint32_t)ref[i] > 0x10FFFF) {
+                n = (size_t)-1;
+            }
+        }
+        if (n != (size_t)-1) {
+            valid++;
+            CHECK(std::vector<uint32_t>(ref.begin(), ref.begin() + n) == cps, "differs from glibc on valid input");
+        } else {
+            CHECK(hasReplacement, "invalid input decoded without U+FFFD");
+        }
+    }
+    printf("Byte fuzz: %d rounds, %d of them valid UTF-8\n", rounds, valid);
+}
+
+void checkMessages() {
+    FixedMsg<16, 64> msg;
+    msg.set("Тест 1234", 0);
+    CHECK(!msg.truncated() && wcscmp(msg.c_str(), L"Тест 1234") == 0, "short message");
+    msg.set("A very long message which does not fit", 0);
+    CHECK(msg.truncated() && wcslen(msg.c_str()) <= 16 && msg.width() <= 64, "long message is cut to %d chars, %d px",
+        (int)wcslen(msg.c_str()), msg.width());
     LcdScreen screen;
-    screen.showMessage("Тест");
+    CHECK(msg.width() == screen.getStrWidth(msg.c_str()), "width of a cut message");
+    msg.set("\xF0\x9F\x98\x80!", 0);
+    CHECK(wcslen(msg.c_str()) == 2 && msg.c_str()[1] == L'!', "4-byte sequence is one character");
+
+    // Latin-1 letters the font lacks have no glyph, not the Cyrillic ones at their CP1251 places
+    Glyph glyph;
+    CHECK(!glyphOf(L'é', glyph) && !glyphOf(L'À', glyph) && glyphOf(L'°', glyph) && glyphOf(L'á', glyph), "Latin-1 glyphs");
+    msg.set("café", 0);
+    CHECK(msg.width() == screen.getStrWidth(L"caf"), "é is skipped, width %d", msg.width());
+
+    // The additional info only goes into the date banner as text
+    screen.setAdditionalInfo("-3°C, снег");
+    screen.showTime(20513, 12 * 3600000 + 56000);
+    const MsgToShow& banner = screen.rollingMsg();
+    CHECK(banner.isSet() && wcscmp(banner.c_str(), L"Вс, 1 марта -3°C, снег") == 0, "banner: %ls", banner.c_str());
+    CHECK(banner.width() == screen.getStrWidth(banner.c_str()), "banner width %d", banner.width());
+}
+
+void bench() {
+    const char* texts[][2] = {
+        { "ASCII", "The quick brown fox jumps over the lazy dog. Temperature 23.5C, wind 3 m/s, humidity 45%. " },
+        { "Cyrillic", "Съешь же ещё этих мягких французских булок, да выпей чаю. Погода: ясно, ветер 3 м/с. " },
+        { "Mixed", "Курс: 1 € = 41.2 ₴, $ = 38.9 ₴. Weather: ☀ 23°C, wind → 3 m/s. Hello, мир! " },
+    };
+    const int rounds = 50000;
+    for (auto& t : texts) {
+        std::string s;
+        for (int i = 0; i < 3; ++i) {
+            s += t[1];
+        }
+        std::vector<wchar_t> out(s.size() + 1);
+        uint32_t sum = 0;
+
+        // Best of 5, the host is noisy
+        uint64_t legacyUs = UINT64_MAX;
+        uint64_t newUs = UINT64_MAX;
+        for (int attempt = 0; attempt < 5; ++attempt) {
+            uint64_t t0 = micros64();
+            for (int r = 0; r < rounds; ++r) {
+                sum += legacyDecode(s.c_str(), out.data());
+                sum += out[r % 10];
+            }
+            uint64_t t1 = micros64();
+            for (int r = 0; r < rounds; ++r) {
+                int used = 0;
+                sum += utf8::decode(s.c_str(), strlen(s.c_str()), out.data(), out.size(), used);
+                sum += out[r % 10];
+            }
+            uint64_t t2 = micros64();
+            legacyUs = std::min(legacyUs, t1 - t0);
+            newUs = std::min(newUs, t2 - t1);
+        }
+        double mb = (double)s.size() * rounds;
+        printf("%-9s %4d bytes: legacy %7.1f MB/s, utf8::decode %7.1f MB/s (%u)\n",
+            t[0], (int)s.size(), mb / legacyUs, mb / newUs, sum);
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    if (setlocale(LC_ALL, "C.UTF-8") == NULL) {
+        printf("No C.UTF-8 locale\n");
+        return 1;
+    }
+    srand(1);
+    checkVectors();
+    fuzzValid(200000);
+    fuzzBytes(1000000);
+    checkMessages();
+    if (failures > 0) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("Decoder matches the vectors, glibc and the legacy decoder\n");
+    bench();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#endif
+
+/**
+ * Datagrams to and from one NTP server
+ */
+class UdpTransport {
+public:
+    virtual ~UdpTransport() {}
+
+    virtual bool send(const uint8_t* data, int len) = 0;
+
+    /**
+     * Length of a datagram that came, 0 if none did. Never waits.
+     */
+    virtual int receive(uint8_t* data, int cap) = 0;
+
+    /**
+     * A whole burst went unanswered
+     */
+    virtual void lost() {}
+};
+
+#ifdef ARDUINO
+/**
+ * WiFiUDP on localPort. The name is resolved on the first request and again after
+ * a burst without answers, that lookup is the only thing here which may block.
+ * A failed lookup waits from lookupBackoffMs, doubling up to maxLookupBackoffMs,
+ * before the next one, so a LAN without DNS doesn't stall loop() every burst.
+ */
+class WiFiUdpTransport : public UdpTransport {
+    WiFiUDP _udp;
+    const String _host;
+    const uint16_t _localPort;
+    IPAddress _ip;
+    bool _begun = false;
+    uint32_t _lookupAtMs = 0;
+    uint32_t _backoffMs = 0;
+
+public:
+    static const uint32_t lookupBackoffMs = 60000;
+    static const uint32_t maxLookupBackoffMs = 3600000;
+
+    WiFiUdpTransport(const String& host, uint16_t localPort) :
+            _host(host),
+            _localPort(localPort),
+            _ip(0u) {
+    }
+
+    virtual void lost() {
+        _ip = IPAddress(0u);
+    }
+
+    virtual bool send(const uint8_t* data, int len) {
+        if (!_begun) {
+            _begun = _udp.begin(_localPort) != 0;
+        }
+        if ((uint32_t)_ip == 0) {
+            if (_backoffMs > 0 && (int32_t)(millis() - _lookupAtMs) < 0) {
+                return false;
+            }
+            if (!WiFi.hostByName(_host.c_str(), _ip)) {
+                _ip = IPAddress(0u);
+                _backoffMs = _backoffMs == 0 ? lookupBackoffMs : (_backoffMs * 2 > maxLookupBackoffMs ? maxLookupBackoffMs : _backoffMs * 2);
+                _lookupAtMs = millis() + _backoffMs;
+                return false;
+            }
+            _backoffMs = 0;
+        }
+        return _udp.beginPacket(_ip, 123) && _udp.write(data, len) == (size_t)len && _udp.endPacket();
+    }
+
+    virtual int receive(uint8_t* data, int cap) {
+        if (!_begun || _udp.parsePacket() <= 0) {
+            return 0;
+        }
+        return _udp.read(data, cap);
+    }
+};
+#endif
+
+namespace ntp {
+    const int packetSize = 48;
+    const uint32_t unixEpoch = 2208988800u; // 1970 in NTP seconds
+
+    /**
+     * NTP timestamp at p to unix us. Seconds below 2^31 are taken as the era after 2036.
+     */
+    inline int64_t readTimestamp(const uint8_t* p) {
+        uint32_t sec = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+        uint32_t frac = ((uint32_t)p[4] << 24) | ((uint32_t)p[5] << 16) | ((uint32_t)p[6] << 8) | p[7];
+        int64_t s = (int64_t)sec - unixEpoch + (sec < 0x80000000u ? (1ll << 32) : 0);
+        return s * 1000000 + (((uint64_t)frac * 1000000) >> 32);
+    }
+
+    inline void writeTimestamp(uint8_t* p, int64_t unixUs) {
+        int64_t s = unixUs / 1000000;
+        uint32_t sec = (uint32_t)(s + unixEpoch);
+        uint32_t frac = (uint32_t)((((uint64_t)(unixUs - s * 1000000)) << 32) / 1000000);
+        for (int i = 0; i < 4; ++i) {
+            p[i] = sec >> (24 - i * 8);
+            p[4 + i] = frac >> (24 - i * 8);
+        }
+    }
+}
+
+/**
+ * Non-blocking SNTP (RFC 4330): every poll interval a burst of requests a couple of
+ * seconds apart, and of the answers only the one with the shortest round trip is
+ * given out. Queueing only adds delay, so the fastest exchange is the least skewed.
+ * poll() is meant for every pass of loop().
+ */
+class SntpClient {
+public:
+    static const int burstSize = 4;
+    static const uint64_t spacingUs = 2000000;
+    static const uint64_t timeoutUs = 1000000;
+
+    /**
+     * Arguments for DeviceClock::sample: the server's processing time is taken
+     * out of the round trip by moving sentUs
+     */
+    struct Sample {
+        int64_t serverUs;
+        uint64_t sentUs;
+        uint64_t receivedUs;
+        uint32_t precisionUs;
+        int64_t delayUs;
+    };
+
+private:
+    UdpTransport& _udp;
+    uint64_t _nextBurstUs = 0;
+    int _sent = 0;               // Requests of this burst
+    bool _waiting = false;
+    uint64_t _sentUs = 0;
+    uint8_t _nonce[8];           // Our transmit timestamp, the answer has to bring it back
+    bool _haveBest = false;
+    Sample _best;
+
+    uint32_t _requests = 0;
+    uint32_t _answers = 0;
+    uint32_t _rejected = 0;
+
+    void request(uint64_t nowUs) {
+        uint8_t packet[ntp::packetSize] = { 0 };
+        packet[0] = (0 << 6) | (4 << 3) | 3; // No leap warning, version 4, client
+        // Any unique value does as the transmit timestamp, the local time is one
+        ntp::writeTimestamp(packet + 40, (int64_t)nowUs);
+        memcpy(_nonce, packet + 40, 8);
+        _sent++;
+        _requests++;
+        _sentUs = nowUs;
+        _waiting = _udp.send(packet, sizeof(packet));
+        if (!_waiting) {
+            _sent = burstSize; // The server can't be reached now, the rest of the burst would not do better
+        }
+    }
+
+    void answer(const uint8_t* p, int len, uint64_t nowUs) {
+        uint8_t mode = p[0] & 7;
+        uint8_t leap = p[0] >> 6;
+        uint8_t stratum = p[1];
+        if (len < ntp::packetSize || mode != 4 || memcmp(p + 24, _nonce, 8) != 0) {
+            _rejected++;
+            return; // Not the answer to the request in flight
+        }
+        _waiting = false;
+        if (stratum == 0 || stratum > 15 || leap == 3) {
+            // Kiss-o'-death or a server which does not know the time itself
+            _rejected++;
+            _sent = burstSize;
+            return;
+        }
+        _answers++;
+        int64_t rx = ntp::readTimestamp(p + 32);
+        int64_t tx = ntp::readTimestamp(p + 40);
+        int64_t processing = tx - rx;
+        int64_t roundTrip = (int64_t)(nowUs - _sentUs);
+        if (processing < 0 || processing > roundTrip) {
+            processing = 0;
+        }
+        int8_t precision = (int8_t)p[3];
+        Sample s;
+        s.serverUs = tx;
+        s.sentUs = _sentUs + processing;
+        s.receivedUs = nowUs;
+        s.precisionUs = precision >= 0 ? 1000000 : (precision < -19 ? 1 : 1000000 >> -precision);
+        s.delayUs = roundTrip - processing;
+        if (!_haveBest || s.delayUs < _best.delayUs) {
+            _best = s;
+            _haveBest = true;
+        }
+    }
+
+public:
+    SntpClient(UdpTransport& udp) :
+            _udp(udp) {
+    }
+
+    /**
+     * true when a burst is over and had an answer, the best of them is in out
+     */
+    bool poll(uint64_t nowUs, uint32_t pollIntervalS, Sample& out) {
+        uint8_t packet[ntp::packetSize + 16];
+        int len;
+        while ((len = _udp.receive(packet, sizeof(packet))) > 0) {
+            if (_waiting) {
+                answer(packet, len, nowUs);
+            } else {
+                _rejected++; // Late, the request timed out already
+            }
+        }
+        if (_waiting && nowUs - _sentUs >= timeoutUs) {
+            _waiting = false;
+        }
+        if (_waiting) {
+            return false;
+        }
+
+        if (_sent >= burstSize) {
+            _sent = 0;
+            _nextBurstUs = nowUs + pollIntervalS * 1000000ull;
+            if (_haveBest) {
+                _haveBest = false;
+                out = _best;
+                return true;
+            }
+            _udp.lost();
+        } else if (_sent > 0 ? nowUs - _sentUs >= spacingUs : nowUs >= _nextBurstUs) {
+            request(nowUs);
+        }
+        return false;
+    }
+
+    uint32_t requests() const {
+        return _requests;
+    }
+
+    uint32_t answers() const {
+        return _answers;
+    }
+
+    uint32_t rejected() const {
+        return _rejected;
+    }
+};
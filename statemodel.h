@@ -0,0 +1,172 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "jsonwriter.h"
+
+/**
+ * What the server knows of the device, as named fields, each stamped with the
+ * version it last changed at. Every change of a value bumps the version, so the
+ * server, which remembers the version it saw last, can ask for what changed
+ * since then instead of everything. Versions count from 0 at boot; the epoch,
+ * picked anew each boot, tells the server that the versions it knows are gone.
+ *
+ * Numbers and flags are kept here. Texts are kept where they live, here is only
+ * their hash; whoever writes the state says what they are. Changes of a live
+ * field are pushed to the server as they come, the rest (readings that change
+ * all the time) only go along with them and in answers.
+ */
+class StateModel {
+public:
+    enum Type {
+        FLAG,
+        INTEGER,
+        NUMBER,
+        TEXT,
+    };
+
+    static const int maxFields = 24;
+
+private:
+    struct Field {
+        const char* name;
+        uint8_t type;
+        bool live;
+        bool set;
+        float value;
+        uint32_t hash;      // Of the text
+        uint32_t changedAt;
+    };
+
+    Field _fields[maxFields];
+    int _count = 0;
+    uint32_t _epoch;
+    uint32_t _version = 0;
+    uint32_t _liveVersion = 0;   // Of the last change of a live field
+
+    static uint32_t hash(const char* s) {
+        uint32_t h = 2166136261u;
+        for (; *s != 0; ++s) {
+            h = (h ^ (uint8_t)*s) * 16777619u;
+        }
+        return h;
+    }
+
+    Field* find(const char* name) {
+        for (int i = 0; i < _count; ++i) {
+            if (strcmp(_fields[i].name, name) == 0) {
+                return _fields + i;
+            }
+        }
+        return NULL;
+    }
+
+    void changed(Field& f) {
+        f.set = true;
+        f.changedAt = ++_version;
+        if (f.live) {
+            _liveVersion = _version;
+        }
+    }
+
+public:
+    StateModel(uint32_t epoch = 1) : _epoch(epoch) {
+    }
+
+    /**
+     * Picks the epoch, once at boot: not 0, which a server sends when it knows nothing
+     */
+    void setEpoch(uint32_t epoch) {
+        _epoch = epoch != 0 ? epoch : 1;
+    }
+
+    uint32_t epoch() const {
+        return _epoch;
+    }
+
+    uint32_t version() const {
+        return _version;
+    }
+
+    uint32_t liveVersion() const {
+        return _liveVersion;
+    }
+
+    /**
+     * A field of the state, the name is kept, not copied. It has no value, and is
+     * not written, until set.
+     */
+    void add(const char* name, Type type, bool live = true) {
+        if (_count < maxFields && find(name) == NULL) {
+            Field f = { name, (uint8_t)type, live, false, 0, 0, 0 };
+            _fields[_count++] = f;
+        }
+    }
+
+    /**
+     * A flag or a number is now value, false if that's no change or there's no such field
+     */
+    bool set(const char* name, float value) {
+        Field* f = find(name);
+        if (f == NULL || f->type == TEXT || (f->set && f->value == value)) {
+            return false;
+        }
+        f->value = value;
+        changed(*f);
+        return true;
+    }
+
+    /**
+     * A text is now text, false if that's no change or there's no such field
+     */
+    bool setText(const char* name, const char* text) {
+        Field* f = find(name);
+        uint32_t h = hash(text);
+        if (f == NULL || f->type != TEXT || (f->set && f->hash == h)) {
+            return false;
+        }
+        f->hash = h;
+        changed(*f);
+        return true;
+    }
+
+    /**
+     * What changed since the version, false if that can't be told: the server
+     * knows of another epoch or of a version yet to come, so it needs all
+     */
+    bool knows(uint32_t epoch, uint32_t since) const {
+        return epoch == _epoch && since <= _version;
+    }
+
+    /**
+     * The fields changed since the version as "values" of a message, all of them
+     * for 0. text(name) gives the text of a TEXT field, anything with c_str().
+     */
+    template<typename TextOf>
+    void write(JsonWriter& msg, uint32_t since, TextOf text) const {
+        msg.beginObject("values");
+        for (int i = 0; i < _count; ++i) {
+            const Field& f = _fields[i];
+            if (!f.set || f.changedAt <= since) {
+                continue;
+            }
+            switch (f.type) {
+                case FLAG:
+                    msg.field(f.name, f.value != 0);
+                    break;
+                case INTEGER:
+                    msg.field(f.name, (long)f.value);
+                    break;
+                case NUMBER:
+                    msg.field(f.name, f.value);
+                    break;
+                case TEXT:
+                    msg.field(f.name, text(f.name).c_str());
+                    break;
+            }
+        }
+        msg.endObject();
+    }
+};
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "jsonwriter.h"
+#include "binproto.h"
+
+/**
+ * Readings of the sensors, sent together: one message every interval instead of
+ * one per reading. Each sensor is a channel, a reading joins the batch when it
+ * moved at least the threshold of its channel from the one last taken, or when
+ * keepAliveMs passed since then, so the server still hears of a sensor that
+ * reads the same. A reading keeps the millis() it was taken at. With no interval
+ * set nothing is batched and the readings go one by one, as they always did.
+ */
+class Telemetry {
+public:
+    static const int maxChannels = 8;
+    static const int maxSamples = 18;
+    static const int maxNameLength = 13;   // "potentiometer"
+    /**
+     * Bytes a message of a full batch takes as JSON, its trailing 0 included, when
+     * each reading is at its longest: the longest name, a float of 22 characters
+     * and a timeseq of 10. 54 are the type, the array and the timeseq of the message.
+     */
+    static const int maxJsonBytes = 54 + maxSamples * (64 + maxNameLength);
+    const uint32_t keepAliveMs = 60000;
+
+    struct Sample {
+        uint8_t channel;
+        float value;
+        int32_t binValue;
+        uint32_t atMs;
+    };
+
+private:
+    struct Channel {
+        const char* name;
+        uint8_t kind;
+        float threshold;
+        bool integer;      // Written to JSON as its binValue, a whole number
+        float taken;       // The value last taken into a batch
+        uint32_t takenAtMs;
+        bool wasTaken;
+    };
+
+    Channel _channels[maxChannels];
+    int _channelCount = 0;
+    Sample _samples[maxSamples];
+    int _count = 0;
+    uint32_t _firstAtMs = 0;
+    uint32_t _intervalMs = 0;
+
+    int channel(const char* name, size_t length) const {
+        for (int i = 0; i < _channelCount; ++i) {
+            if (strncmp(_channels[i].name, name, length) == 0 && _channels[i].name[length] == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+public:
+    /**
+     * A sensor of the type, readings of which are batched. kind is its binproto::Kind,
+     * threshold the least change worth sending, integer if its readings are whole
+     * numbers. The name is kept, not copied; one longer than maxNameLength is refused.
+     */
+    void addChannel(const char* name, uint8_t kind, float threshold, bool integer = false) {
+        if (_channelCount < maxChannels && strlen(name) <= maxNameLength) {
+            Channel c = { name, kind, threshold, integer, 0, 0, false };
+            _channels[_channelCount++] = c;
+        }
+    }
+
+    /**
+     * Thresholds by type, as "temp:0.1;weight:50"; types without a channel are skipped
+     */
+    void setThresholds(const char* s) {
+        while (*s != 0) {
+            const char* colon = strchr(s, ':');
+            if (colon == NULL) {
+                return;
+            }
+            int c = channel(s, colon - s);
+            if (c >= 0) {
+                _channels[c].threshold = atof(colon + 1);
+            }
+            s = strchr(colon, ';');
+            if (s == NULL) {
+                return;
+            }
+            s++;
+        }
+    }
+
+    float threshold(const char* type) const {
+        int c = channel(type, strlen(type));
+        return c >= 0 ? _channels[c].threshold : 0;
+    }
+
+    /**
+     * ms to collect readings for before they go, 0 sends each as it comes
+     */
+    void setInterval(uint32_t ms) {
+        _intervalMs = ms;
+    }
+
+    uint32_t interval() const {
+        return _intervalMs;
+    }
+
+    /**
+     * A reading of the type at now, false if it isn't batched and is to be sent
+     * by itself: batching is off or the type has no channel. binValue is the
+     * value as the binary frame of its kind carries it.
+     */
+    bool add(const char* type, float value, int32_t binValue, uint32_t now) {
+        if (_intervalMs == 0) {
+            return false;
+        }
+        int c = channel(type, strlen(type));
+        if (c < 0) {
+            return false;
+        }
+        Channel& ch = _channels[c];
+        if (ch.wasTaken && fabsf(value - ch.taken) < ch.threshold && now - ch.takenAtMs < keepAliveMs) {
+            return true;
+        }
+        if (_count == maxSamples) {
+            // Not flushed in time: the oldest reading of the channel makes room, or the new one goes
+            int i = 0;
+            while (i < _count && _samples[i].channel != c) {
+                i++;
+            }
+            if (i == _count) {
+                return true;
+            }
+            memmove(_samples + i, _samples + i + 1, (_count - i - 1) * sizeof(Sample));
+            _count--;
+        }
+        ch.taken = value;
+        ch.takenAtMs = now;
+        ch.wasTaken = true;
+        if (_count == 0) {
+            _firstAtMs = now;
+        }
+        Sample s = { (uint8_t)c, value, binValue, now };
+        _samples[_count++] = s;
+        return true;
+    }
+
+    /**
+     * The batch is to be sent at now: the interval passed since its first reading, or it is full
+     */
+    bool due(uint32_t now) const {
+        return _count > 0 && (_count == maxSamples || now - _firstAtMs >= _intervalMs);
+    }
+
+    int count() const {
+        return _count;
+    }
+
+    const Sample& sample(int i) const {
+        return _samples[i];
+    }
+
+    const char* name(const Sample& s) const {
+        return _channels[s.channel].name;
+    }
+
+    /**
+     * The batch as "samples" of a JSON message, each the object its own message would be
+     */
+    void write(JsonWriter& msg) const {
+        msg.beginArray("samples");
+        for (int i = 0; i < _count; ++i) {
+            const Sample& s = _samples[i];
+            msg.beginObject().field("type", name(s));
+            if (_channels[s.channel].integer) {
+                msg.field("value", (long)s.binValue);
+            } else {
+                msg.field("value", s.value);
+            }
+            msg.field("timeseq", s.atMs).endObject();
+        }
+        msg.endArray();
+    }
+
+    /**
+     * The batch as SAMPLES of a binary frame, ages counted back from now, the TIMESEQ of the frame
+     */
+    void write(binproto::Writer& msg, uint32_t now) const {
+        uint8_t packed[maxSamples * 7];
+        size_t n = 0;
+        for (int i = 0; i < _count; ++i) {
+            const Sample& s = _samples[i];
+            uint32_t age = now - s.atMs;
+            if (age > 0xffff) {
+                age = 0xffff;
+            }
+            packed[n++] = _channels[s.channel].kind;
+            for (int b = 0; b < 4; ++b) {
+                packed[n++] = (uint8_t)((uint32_t)s.binValue >> (8 * b));
+            }
+            packed[n++] = (uint8_t)age;
+            packed[n++] = (uint8_t)(age >> 8);
+        }
+        msg.field(binproto::TIMESEQ, now).field(binproto::SAMPLES, packed, n);
+    }
+
+    /**
+     * The batch was sent, the next one starts empty
+     */
+    void clear() {
+        _count = 0;
+    }
+};
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "dateutil.h"
+
+/**
+ * Local time by a POSIX TZ string, like "EET-2EEST,M3.5.0/3,M10.5.0/4" (see tzset(3)).
+ * The string is parsed once, the transitions of a few years are then put into a table
+ * and a lookup only goes to the table when it leaves the interval of the previous one.
+ */
+namespace tz {
+
+    /**
+     * A date of a rule: Jn (1..365, February 29 is never counted), n (0..365)
+     * or Mm.w.d (day d of week w of month m, week 5 is the last one, Sunday is 0)
+     */
+    struct RuleDate {
+        enum Kind { JULIAN_NO_LEAP, JULIAN, MONTH_WEEK_DAY };
+        Kind kind = MONTH_WEEK_DAY;
+        uint16_t day = 0;
+        uint8_t month = 1;
+        uint8_t week = 1;
+        int32_t time = 2 * 3600; // Seconds of local time, may be negative or over a day
+
+        /**
+         * Days since 1970-01-01 of this date in year y
+         */
+        int32_t days(int32_t y) const {
+            int32_t jan1 = date::daysFromCivil(y, 1, 1);
+            if (kind == JULIAN_NO_LEAP) {
+                return jan1 + day - 1 + (day >= 60 && date::isLeapYear(y) ? 1 : 0);
+            } else if (kind == JULIAN) {
+                return jan1 + day;
+            }
+            int32_t first = date::daysFromCivil(y, month, 1);
+            int32_t next = month == 12 ? date::daysFromCivil(y + 1, 1, 1) : date::daysFromCivil(y, month + 1, 1);
+            uint32_t firstDow = (date::weekday(first) + 1) % 7; // Sunday is 0 here
+            int32_t d = first + (day + 7 - firstDow) % 7 + (week - 1) * 7;
+            while (d >= next) {
+                d -= 7;
+            }
+            return d;
+        }
+    };
+
+    struct Rule {
+        int32_t stdOffset = 0; // Seconds east of UTC
+        int32_t dstOffset = 0;
+        bool hasDst = false;
+        RuleDate start;        // Local standard time
+        RuleDate end;          // Local daylight saving time
+    };
+
+    /**
+     * Recursive descent over the TZ grammar, every parseXxx moves s past what it took
+     */
+    class Parser {
+        const char* s;
+
+        bool parseName() {
+            if (*s == '<') {
+                const char* from = ++s;
+                while (*s != 0 && *s != '>') {
+                    s++;
+                }
+                if (*s != '>' || s - from < 3) {
+                    return false;
+                }
+                s++;
+                return true;
+            }
+            const char* from = s;
+            while ((*s >= 'A' && *s <= 'Z') || (*s >= 'a' && *s <= 'z')) {
+                s++;
+            }
+            return s - from >= 3;
+        }
+
+        bool parseNumber(int32_t& n, int maxDigits) {
+            if (*s < '0' || *s > '9') {
+                return false;
+            }
+            n = 0;
+            for (int i = 0; i < maxDigits && *s >= '0' && *s <= '9'; ++i) {
+                n = n * 10 + (*s++ - '0');
+            }
+            return true;
+        }
+
+        /**
+         * [+-]hh[:mm[:ss]], hours up to 167 as RFC 8536 allows for rule times
+         */
+        bool parseHms(int32_t& seconds) {
+            int32_t sign = 1;
+            if (*s == '+' || *s == '-') {
+                sign = *s++ == '-' ? -1 : 1;
+            }
+            int32_t h, m = 0, sec = 0;
+            if (!parseNumber(h, 3) || h > 167) {
+                return false;
+            }
+            if (*s == ':') {
+                s++;
+                if (!parseNumber(m, 2) || m > 59) {
+                    return false;
+                }
+                if (*s == ':') {
+                    s++;
+                    if (!parseNumber(sec, 2) || sec > 59) {
+                        return false;
+                    }
+                }
+            }
+            seconds = sign * (h * 3600 + m * 60 + sec);
+            return true;
+        }
+
+        bool parseRuleDate(RuleDate& rd) {
+            int32_t n;
+            if (*s == 'J') {
+                s++;
+                if (!parseNumber(n, 3) || n < 1 || n > 365) {
+                    return false;
+                }
+                rd.kind = RuleDate::JULIAN_NO_LEAP;
+                rd.day = n;
+            } else if (*s == 'M') {
+                s++;
+                int32_t w, d;
+                if (!parseNumber(n, 2) || n < 1 || n > 12 || *s++ != '.' ||
+                        !parseNumber(w, 1) || w < 1 || w > 5 || *s++ != '.' ||
+                        !parseNumber(d, 1) || d > 6) {
+                    return false;
+                }
+                rd.kind = RuleDate::MONTH_WEEK_DAY;
+                rd.month = n;
+                rd.week = w;
+                rd.day = d;
+            } else {
+                if (!parseNumber(n, 3) || n > 365) {
+                    return false;
+                }
+                rd.kind = RuleDate::JULIAN;
+                rd.day = n;
+            }
+            rd.time = 2 * 3600;
+            if (*s == '/') {
+                s++;
+                return parseHms(rd.time);
+            }
+            return true;
+        }
+
+    public:
+        Parser(const char* _s) : s(_s) {
+        }
+
+        bool parse(Rule& rule) {
+            int32_t offset;
+            if (!parseName() || !parseHms(offset)) {
+                return false;
+            }
+            rule.stdOffset = -offset; // POSIX counts west of Greenwich
+            rule.hasDst = false;
+            if (*s == 0) {
+                return true;
+            }
+
+            if (!parseName()) {
+                return false;
+            }
+            rule.hasDst = true;
+            rule.dstOffset = rule.stdOffset + 3600;
+            if (*s != ',' && *s != 0) {
+                if (!parseHms(offset)) {
+                    return false;
+                }
+                rule.dstOffset = -offset;
+            }
+            if (*s == 0) {
+                // No rules: what the US uses, as glibc does
+                Parser("M3.2.0,M11.1.0").parseRules(rule);
+                return true;
+            }
+            return *s++ == ',' && parseRules(rule);
+        }
+
+        bool parseRules(Rule& rule) {
+            return parseRuleDate(rule.start) && *s++ == ',' && parseRuleDate(rule.end) && *s == 0;
+        }
+    };
+
+    /**
+     * Fills rule from a TZ string, false if the string is not one
+     */
+    inline bool parse(const char* s, Rule& rule) {
+        Rule parsed;
+        if (s == nullptr || !Parser(s).parse(parsed)) {
+            return false;
+        }
+        rule = parsed;
+        return true;
+    }
+
+    struct Transition {
+        int64_t at;      // UTC seconds since 1970
+        int32_t offset;  // Seconds east of UTC from then on
+    };
+
+    class TimeZone {
+    public:
+        static const int spanYears = 8;
+
+    private:
+        Rule _rule;
+        Transition _table[spanYears * 2];
+        int _count = 0;
+        int64_t _tableFrom = 0; // UTC seconds the table covers
+        int64_t _tableUntil = 0;
+
+        // Interval of the last lookup, where the offset stays the same
+        int64_t _from = 0;
+        int64_t _until = 0;
+        int32_t _offset = 0;
+        uint32_t _compilations = 0;
+
+        static int32_t yearOf(int64_t utc) {
+            int64_t days = utc >= 0 ? utc / 86400 : (utc - 86399) / 86400;
+            int32_t y;
+            uint32_t m, d;
+            date::civilFromDays((int32_t)days, y, m, d);
+            return y;
+        }
+
+        void compile(int32_t fromYear) {
+            _compilations++;
+            _count = 0;
+            _tableFrom = (int64_t)date::daysFromCivil(fromYear, 1, 1) * 86400;
+            _tableUntil = (int64_t)date::daysFromCivil(fromYear + spanYears, 1, 1) * 86400;
+            for (int32_t y = fromYear; y < fromYear + spanYears; ++y) {
+                add((int64_t)_rule.start.days(y) * 86400 + _rule.start.time - _rule.stdOffset, _rule.dstOffset);
+                add((int64_t)_rule.end.days(y) * 86400 + _rule.end.time - _rule.dstOffset, _rule.stdOffset);
+            }
+        }
+
+        void add(int64_t at, int32_t offset) {
+            // Sorted by insertion, southern zones end DST before they start it
+            int i = _count++;
+            for (; i > 0 && _table[i - 1].at > at; --i) {
+                _table[i] = _table[i - 1];
+            }
+            _table[i].at = at;
+            _table[i].offset = offset;
+        }
+
+        void locate(int64_t utc) {
+            if (!_rule.hasDst) {
+                _from = INT64_MIN;
+                _until = INT64_MAX;
+                _offset = _rule.stdOffset;
+                return;
+            }
+            if (utc < _tableFrom || utc >= _tableUntil) {
+                compile(yearOf(utc));
+            }
+            int i = _count;
+            while (i > 0 && _table[i - 1].at > utc) {
+                --i;
+            }
+            // Rules repeat every year, so before the first transition it is as after the last one
+            _offset = _table[i > 0 ? i - 1 : _count - 1].offset;
+            _from = i > 0 ? _table[i - 1].at : _tableFrom;
+            _until = i < _count ? _table[i].at : _tableUntil;
+        }
+
+    public:
+        /**
+         * Takes a TZ string, false (and the zone stays as it was) if it does not parse
+         */
+        bool set(const char* posix) {
+            if (!parse(posix, _rule)) {
+                return false;
+            }
+            _tableFrom = _tableUntil = 0;
+            _from = _until = 0;
+            return true;
+        }
+
+        const Rule& rule() const {
+            return _rule;
+        }
+
+        /**
+         * Seconds east of UTC at utc (seconds since 1970)
+         */
+        int32_t offset(int64_t utc) {
+            if (utc < _from || utc >= _until) {
+                locate(utc);
+            }
+            return _offset;
+        }
+
+        uint64_t localMs(uint64_t utcMs) {
+            return utcMs + (int64_t)offset(utcMs / 1000) * 1000;
+        }
+
+        /**
+         * How many times the transition table was built, for the tests
+         */
+        uint32_t compilations() const {
+            return _compilations;
+        }
+    };
+}
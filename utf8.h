@@ -0,0 +1,129 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * UTF-8 decoding as the Unicode standard defines well-formed sequences (table 3-7):
+ * overlong forms, surrogates and anything above U+10FFFF are rejected. Every
+ * maximal ill-formed subpart becomes one U+FFFD, so broken input can't eat the
+ * characters after it.
+ */
+namespace utf8 {
+
+    const uint32_t REPLACEMENT = 0xFFFD;
+
+    /**
+     * Decodes one sequence at s[0..len-1], len > 0. Returns its length in bytes
+     * and puts the code point (or REPLACEMENT) to cp.
+     */
+    inline int decodeOne(const uint8_t* s, int len, uint32_t& cp) {
+        uint8_t b = s[0];
+        if (b < 0x80) {
+            cp = b;
+            return 1;
+        }
+
+        int need;
+        uint8_t lo = 0x80; // Allowed range of the second byte
+        uint8_t hi = 0xBF;
+        if (b >= 0xC2 && b <= 0xDF) {
+            need = 1;
+            cp = b & 0x1F;
+        } else if (b >= 0xE0 && b <= 0xEF) {
+            need = 2;
+            cp = b & 0x0F;
+            if (b == 0xE0) {
+                lo = 0xA0;  // Overlong
+            } else if (b == 0xED) {
+                hi = 0x9F;  // Surrogates
+            }
+        } else if (b >= 0xF0 && b <= 0xF4) {
+            need = 3;
+            cp = b & 0x07;
+            if (b == 0xF0) {
+                lo = 0x90;  // Overlong
+            } else if (b == 0xF4) {
+                hi = 0x8F;  // Above U+10FFFF
+            }
+        } else {
+            cp = REPLACEMENT;
+            return 1;
+        }
+
+        int i = 1;
+        for (; i <= need; ++i) {
+            if (i >= len) {
+                cp = REPLACEMENT;
+                return i;
+            }
+            uint8_t c = s[i];
+            if (c < lo || c > hi) {
+                cp = REPLACEMENT;
+                return i;
+            }
+            cp = (cp << 6) | (c & 0x3F);
+            lo = 0x80;
+            hi = 0xBF;
+        }
+        return i;
+    }
+
+    /**
+     * Decodes up to outCap code points of src[0..len-1] into out. Returns how many
+     * were written, srcUsed gets how many bytes of src they took.
+     * Code points that don't fit the output type become REPLACEMENT.
+     * Runs of ASCII are copied 4 bytes at a time.
+     */
+    template<class Char>
+    int decode(const char* src, int len, Char* out, int outCap, int& srcUsed) {
+        const uint8_t* s = (const uint8_t*)src;
+        int i = 0;
+        int n = 0;
+        while (i < len && n < outCap) {
+            if (s[i] < 0x80) {
+                out[n++] = s[i++];
+                // ASCII is the common case: check and copy a word at a time,
+                // unless it was a lone space between non-ASCII words
+                while (i + 4 <= len && n + 4 <= outCap && s[i] < 0x80) {
+                    uint32_t w;
+                    memcpy(&w, s + i, 4);
+                    if ((w & 0x80808080u) != 0) {
+                        break;
+                    }
+                    out[n] = s[i];
+                    out[n + 1] = s[i + 1];
+                    out[n + 2] = s[i + 2];
+                    out[n + 3] = s[i + 3];
+                    n += 4;
+                    i += 4;
+                }
+                while (i < len && n < outCap && s[i] < 0x80) {
+                    out[n++] = s[i++];
+                }
+                continue;
+            }
+
+            // Runs of two byte sequences (Cyrillic) get their own loop too
+            if (s[i] >= 0xC2 && s[i] <= 0xDF) {
+                int from = n;
+                while (i + 1 < len && n < outCap && (uint8_t)(s[i] - 0xC2) <= 0xDF - 0xC2 && (s[i + 1] & 0xC0) == 0x80) {
+                    out[n++] = ((s[i] & 0x1F) << 6) | (s[i + 1] & 0x3F);
+                    i += 2;
+                }
+                if (n != from) {
+                    continue;
+                }
+            }
+
+            uint32_t cp;
+            i += decodeOne(s + i, len - i, cp);
+            if (sizeof(Char) < 4 && cp > 0xFFFF) {
+                cp = REPLACEMENT;
+            }
+            out[n++] = (Char)cp;
+        }
+        srcUsed = i;
+        return n;
+    }
+}